@@ -0,0 +1,44 @@
+#!/usr/bin/env bash
+#
+# Compares the time spent by the generated parser when it tries the SLL
+# prediction first against the full LL prediction only, and against the
+# recursive descent parser. The source is generated with the given count
+# of functions and is parsed only, the timings are printed by -vtime.
+#
+# Usage: bench/parse.sh <compiler> [function count]
+
+set -euo pipefail
+
+if [ $# -lt 1 ]; then
+  echo "Usage: $0 <compiler> [function count]" >&2
+  exit 1
+fi
+
+compiler=$1
+count=${2:-20000}
+
+source=$(mktemp --suffix=.swy)
+trap 'rm -f "$source"' EXIT
+
+{
+  echo "bench0(int a, int b) int -> return a + b;"
+  for ((i = 1; i < count; ++i)); do
+    cat <<SOURCE
+bench$i(int a, int b) int -> {
+  int c = a * b + $i;
+  if c < b {
+    c = c - bench$((i - 1))(a, b) * 2;
+  } else {
+    c = (c + b) / 2 == a;
+  }
+  return c;
+}
+SOURCE
+  done
+} > "$source"
+
+for parser in generated generated-ll descent; do
+  echo "== -parser=$parser ($count functions)"
+  "$compiler" "-parser=$parser" -vtime -j=1 -emit-flat-layout "$source" \
+    > /dev/null
+done
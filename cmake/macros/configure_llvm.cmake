@@ -10,6 +10,9 @@ llvm_map_components_to_libnames(llvm_libs
   core
   option
   irreader
+  bitreader
+  bitwriter
+  linker
   passes
   orcjit
   interpreter
@@ -17,9 +17,39 @@
 
 #include "AST.hpp"
 
+#include <type_traits>
+
+#include "llvm/Support/ErrorHandling.h"
+
+#include "ASTContext.hpp"
 #include "ASTPredicate.hpp"
 #include "ASTTraversal.hpp"
 
+/// Casts the given context to the node of type T which declares it
+template <typename T>
+static T* declaringNodeOf(NamedDeclContext* decl, std::true_type) {
+  return static_cast<T*>(decl);
+}
+template <typename T>
+static ASTNode* declaringNodeOf(NamedDeclContext* /*decl*/, std::false_type) {
+  llvm_unreachable("The node doesn't declare any names!");
+}
+
+ASTNode* NamedDeclContext::getDeclaringNode() {
+  switch (declaringKind_) {
+#define FOR_EACH_AST_NODE(NAME)                                                \
+  case ASTKind::Kind##NAME:                                                    \
+    return declaringNodeOf<NAME##ASTNode>(                                     \
+        this, std::is_base_of<NamedDeclContext, NAME##ASTNode>{});
+#include "AST.inl"
+  }
+  llvm_unreachable("Unknown node type!");
+}
+
+ASTNode const* NamedDeclContext::getDeclaringNode() const {
+  return const_cast<NamedDeclContext*>(this)->getDeclaringNode();
+}
+
 bool NamedDeclContext::isFunctionDecl() const {
   return llvm::isa<FunctionDeclASTNode>(getDeclaringNode());
 }
@@ -35,10 +65,65 @@ bool NamedDeclContext::isMetaDecl() const {
   return llvm::isa<MetaDeclASTNode>(getDeclaringNode());
 }
 
+bool NamedDeclContext::isArrayDecl() const {
+  auto node = getDeclaringNode();
+  return llvm::isa<ArrayDeclStmtASTNode>(node) ||
+         llvm::isa<GlobalConstantArrayDeclASTNode>(node);
+}
+
+bool NamedDeclContext::isGlobalConstantArray() const {
+  return llvm::isa<GlobalConstantArrayDeclASTNode>(getDeclaringNode());
+}
+
 bool NamedDeclContext::isGlobalConstant() const {
   return llvm::isa<GlobalConstantDeclASTNode>(getDeclaringNode());
 }
 
+void UnitASTNode::setChildren(ASTContext* astContext,
+                              llvm::ArrayRef<ASTNode*> children) {
+  astContext->assign(children_, children);
+}
+
+void UnitASTNode::addChild(ASTContext* astContext, ASTNode* child) {
+  astContext->append(children_, child);
+}
+
+void ArgumentDeclListASTNode::setArguments(
+    ASTContext* astContext,
+    llvm::ArrayRef<AnonymousArgumentDeclASTNode*> arguments) {
+  astContext->assign(arguments_, arguments);
+}
+
+void MetaContributionASTNode::setChildren(ASTContext* astContext,
+                                          llvm::ArrayRef<ASTNode*> children) {
+  astContext->assign(children_, children);
+}
+
+void BasicCompoundStmtASTNode::setStatements(
+    ASTContext* astContext, llvm::ArrayRef<StmtASTNode*> statements) {
+  astContext->assign(statements_, statements);
+}
+
+void MatchStmtASTNode::setArms(ASTContext* astContext,
+                               llvm::ArrayRef<ASTNode*> arms) {
+  astContext->assign(arms_, arms);
+}
+
+void MetaCalculationStmtASTNode::setExportedDecls(
+    ASTContext* astContext, llvm::ArrayRef<NamedDeclContext*> exportedDecls) {
+  astContext->assign(exportedDecls_, exportedDecls);
+}
+
+void MetaInstantiationExprASTNode::setArguments(
+    ASTContext* astContext, llvm::ArrayRef<ExprASTNode*> arguments) {
+  astContext->assign(arguments_, arguments);
+}
+
+void CallOperatorExprASTNode::setExpressions(
+    ASTContext* astContext, llvm::ArrayRef<ExprASTNode*> expressions) {
+  astContext->assign(expressions_, expressions);
+}
+
 llvm::SmallVector<ASTNode*, 3> FunctionDeclASTNode::children() {
   llvm::SmallVector<ASTNode*, 3> seq;
   seq.push_back(*arguments_);
@@ -99,6 +184,36 @@ std::array<ExprASTNode const*, 1> DeclStmtASTNode::children() const {
   return {{*expression_}};
 }
 
+Nullable<NamedDeclContext const*>
+ArraySubscriptExprASTNode::getArrayDecl() const {
+  if (auto declRef = llvm::dyn_cast<DeclRefExprASTNode>(*base_)) {
+    if (declRef->isResolved() && declRef->getDecl()->isArrayDecl()) {
+      return declRef->getDecl();
+    }
+  }
+  return nullptr;
+}
+
+llvm::Optional<std::uint32_t> ArraySubscriptExprASTNode::getArraySize() const {
+  auto decl = getArrayDecl();
+  if (!decl) {
+    return llvm::None;
+  }
+  auto node = decl->getDeclaringNode();
+  if (auto array = llvm::dyn_cast<ArrayDeclStmtASTNode>(node)) {
+    return *array->getSize();
+  }
+  return llvm::cast<GlobalConstantArrayDeclASTNode>(node)->getSize();
+}
+
+std::array<ExprASTNode*, 2> ArraySubscriptExprASTNode::children() {
+  return {{*base_, *index_}};
+}
+
+std::array<ExprASTNode const*, 2> ArraySubscriptExprASTNode::children() const {
+  return {{*base_, *index_}};
+}
+
 ASTChildSequence CallOperatorExprASTNode::children() {
   ASTChildSequence seq{*callee_};
   seq.append(expressions_.begin(), expressions_.end());
@@ -124,10 +239,91 @@ MetaInstantiationExprASTNode::children() const {
   return seq;
 }
 
+ASTChildSequence MatchStmtASTNode::children() {
+  ASTChildSequence seq{*expression_};
+  seq.append(arms_.begin(), arms_.end());
+  return seq;
+}
+
+ConstASTChildSequence MatchStmtASTNode::children() const {
+  ConstASTChildSequence seq{*expression_};
+  seq.append(arms_.begin(), arms_.end());
+  return seq;
+}
+
+llvm::Optional<std::int32_t> MatchArmASTNode::getPatternValue() const {
+  assert(!isWildcard() && "The wildcard arm has no pattern!");
+  return pattern_->getConstantValue();
+}
+
+llvm::SmallVector<ASTNode*, 2> MatchArmASTNode::children() {
+  llvm::SmallVector<ASTNode*, 2> seq;
+  if (pattern_) {
+    seq.push_back(*pattern_);
+  }
+  seq.push_back(*body_);
+  return seq;
+}
+
+llvm::SmallVector<ASTNode const*, 2> MatchArmASTNode::children() const {
+  llvm::SmallVector<ASTNode const*, 2> seq;
+  if (pattern_) {
+    seq.push_back(*pattern_);
+  }
+  seq.push_back(*body_);
+  return seq;
+}
+
 bool StmtASTNode::classof(ASTNode const* node) {
   return traverseNode(node, decorate(identityOf<bool>(), pred::isStmtNode()));
 }
 
+llvm::Optional<std::int32_t> ExprASTNode::getConstantValue() const {
+  if (auto literal = llvm::dyn_cast<IntegerLiteralExprASTNode>(this)) {
+    return *literal->getLiteral();
+  }
+  if (auto literal = llvm::dyn_cast<BooleanLiteralExprASTNode>(this)) {
+    return std::int32_t(*literal->getLiteral());
+  }
+  if (auto declRef = llvm::dyn_cast<DeclRefExprASTNode>(this)) {
+    if (declRef->isResolved() && declRef->getDecl()->isGlobalConstant()) {
+      auto constant = llvm::cast<GlobalConstantDeclASTNode>(
+          declRef->getDecl()->getDeclaringNode());
+      return constant->getExpression()->getConstantValue();
+    }
+  }
+  return llvm::None;
+}
+
+bool ExprASTNode::isBooleanValued() const {
+  if (llvm::isa<BooleanLiteralExprASTNode>(this)) {
+    return true;
+  }
+  if (auto binary = llvm::dyn_cast<BinaryOperatorExprASTNode>(this)) {
+    switch (*binary->getBinaryOperator()) {
+      case ExprBinaryOperator::OperatorLessThan:
+      case ExprBinaryOperator::OperatorGreaterThan:
+      case ExprBinaryOperator::OperatorLessThanOrEq:
+      case ExprBinaryOperator::OperatorGreaterThanOrEq:
+      case ExprBinaryOperator::OperatorEqual:
+      case ExprBinaryOperator::OperatorNotEqual:
+        return true;
+      case ExprBinaryOperator::OperatorAssign:
+        return binary->getRightExpr()->isBooleanValued();
+      default:
+        return false;
+    }
+  }
+  if (auto declRef = llvm::dyn_cast<DeclRefExprASTNode>(this)) {
+    if (declRef->isResolved() && declRef->getDecl()->isGlobalConstant()) {
+      auto constant = llvm::cast<GlobalConstantDeclASTNode>(
+          declRef->getDecl()->getDeclaringNode());
+      return constant->getExpression()->isBooleanValued();
+    }
+  }
+  return false;
+}
+
 bool ExprASTNode::classof(ASTNode const* node) {
   return traverseNode(node, decorate(identityOf<bool>(), pred::isExprNode()));
 }
@@ -20,17 +20,19 @@
 
 #include <array>
 #include <cstdint>
-#include <vector>
 
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/Optional.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/Casting.h"
 
 #include "ASTFragment.hpp"
+#include "ASTList.hpp"
 #include "Nullable.hpp"
 #include "SourceAnnotated.hpp"
 #include "SourceLocation.hpp"
 
+class ASTContext;
 class ASTNode;
 class StmtASTNode;
 class ExprASTNode;
@@ -40,17 +42,26 @@ class ConsistentASTScope;
 class ConstantExprASTNode;
 
 /// Defines the kind of the ASTNode which is one of the basic types
-enum class ASTKind {
+enum class ASTKind : std::uint8_t {
 #define FOR_EACH_AST_NODE(NAME) Kind##NAME,
 #include "AST.inl"
 };
 
+/// The count of the different kinds of ASTNode's
+constexpr std::size_t ASTKindCount = 0
+#define FOR_EACH_AST_NODE(NAME) +1
+#include "AST.inl"
+    ;
+
 /// A sequence to iterate of the children of the ASTNode
 using ASTChildSequence = llvm::SmallVector<ASTNode*, 10>;
 /// A const sequence to iterate of the children of the ASTNode
 using ConstASTChildSequence = llvm::SmallVector<ASTNode const*, 10>;
 
 /// Represents the base class of an every AST node
+///
+/// AST nodes are trivially destructible and have no virtual methods,
+/// their children are stored inside the ASTContext.
 class ASTNode : public ASTFragment {
   ASTKind const kind_;
 
@@ -66,22 +77,29 @@ public:
 /// Provides access to a name declaring node
 class NamedDeclContext {
   Identifier name_;
+  /// The kind of the declaring node which is used for casting
+  /// this context back to its node.
+  ASTKind declaringKind_;
 
 public:
-  explicit NamedDeclContext(Identifier const& name) : name_(name) {}
-  virtual ~NamedDeclContext() = default;
+  NamedDeclContext(ASTKind declaringKind, Identifier const& name)
+      : name_(name), declaringKind_(declaringKind) {}
 
   /// Returns the identifier of the node that represents the name
   Identifier const& getName() const { return name_; }
   /// Returns the name associated to the name
-  virtual ASTNode* getDeclaringNode() = 0;
+  ASTNode* getDeclaringNode();
   /// Returns the name associated to the name
-  virtual ASTNode const* getDeclaringNode() const = 0;
+  ASTNode const* getDeclaringNode() const;
 
   /// Returns true when the declaration is a function
   bool isFunctionDecl() const;
   /// Returns true when the declaration is a variable
   bool isVarDecl() const;
+  /// Returns true when the declaration is a fixed-size array
+  bool isArrayDecl() const;
+  /// Returns true when the declaration is a global constant array
+  bool isGlobalConstantArray() const;
   /// Returns true when the declaration is a meta decl
   bool isMetaDecl() const;
   /// Returns true when the declaration is a global constant
@@ -93,18 +111,23 @@ public:
 /// - MetaUnitASTNode
 class UnitASTNode {
   NonNull<ConsistentASTScope*> scope_;
-  std::vector<ASTNode*> children_;
+  ASTList<ASTNode*> children_;
 
 public:
   UnitASTNode() = default;
-  virtual ~UnitASTNode() = default;
 
   void setScope(ConsistentASTScope* scope) { scope_ = scope; }
   ConsistentASTScope const* getScope() const { return *scope_; }
 
-  void addChild(ASTNode* child) { children_.push_back(child); }
-  llvm::ArrayRef<ASTNode*> children() { return children_; }
-  llvm::ArrayRef<ASTNode const*> children() const { return children_; }
+  /// Sets the children of the unit which are stored exactly sized
+  void setChildren(ASTContext* astContext, llvm::ArrayRef<ASTNode*> children);
+  /// Adds a child to the unit, which is used when the children
+  /// are loaded lazily.
+  void addChild(ASTContext* astContext, ASTNode* child);
+  llvm::ArrayRef<ASTNode*> children() { return children_.elements(); }
+  llvm::ArrayRef<ASTNode const*> children() const {
+    return children_.elements();
+  }
 };
 
 /// Generalized base class for top level ASTNodes which are
@@ -117,7 +140,6 @@ class TopLevelASTNode {
 
 public:
   TopLevelASTNode() = default;
-  virtual ~TopLevelASTNode() = default;
 
   void setContainingUnit(ASTNode const* node) { containingUnit_ = node; }
   ASTNode const* getContainingUnit() const { return *containingUnit_; }
@@ -125,8 +147,15 @@ public:
 
 /// Represents a compilation unit of a source file
 class CompilationUnitASTNode : public ASTNode, public UnitASTNode {
+  bool isImported_;
+
 public:
-  explicit CompilationUnitASTNode() : ASTNode(ASTKind::KindCompilationUnit) {}
+  explicit CompilationUnitASTNode(bool isImported = false)
+      : ASTNode(ASTKind::KindCompilationUnit), isImported_(isImported) {}
+
+  /// Returns true when the unit represents an imported module,
+  /// which only contains the declarations that were looked up.
+  bool isImported() const { return isImported_; }
 
   static bool classof(ASTNode const* node) {
     return node->isKind(ASTKind::KindCompilationUnit);
@@ -159,18 +188,61 @@ public:
   }
 };
 
+/// Represents the import of a module (`import "lib.swy";`) which makes
+/// the top level declarations of the module visible in the unit.
+class ImportDeclASTNode : public ASTNode, public TopLevelASTNode {
+  Identifier path_;
+
+public:
+  explicit ImportDeclASTNode(Identifier const& path)
+      : ASTNode(ASTKind::KindImportDecl), path_(path) {}
+
+  /// Returns the path of the imported source file without the quotes,
+  /// which is relative to the directory of the importing source file.
+  Identifier const& getPath() const { return path_; }
+
+  static bool classof(ASTNode const* node) {
+    return node->isKind(ASTKind::KindImportDecl);
+  }
+};
+
+/// Describes how the function is treated by the inliner
+enum class FunctionInlining { Default, Always, Never };
+
+/// Describes how often the function is expected to be executed
+enum class FunctionFrequency { Default, Hot, Cold };
+
+/// Represents the attributes which are attached to a function declaration
+struct FunctionAttributes {
+  /// The targets the function is multiversioned for (`@target_clones`),
+  /// which are stored inside the ASTContext.
+  llvm::ArrayRef<Identifier> targetClones;
+  /// The inlining of the function (`@inline` or `@noinline`)
+  FunctionInlining inlining = FunctionInlining::Default;
+  /// The execution frequency of the function (`@hot` or `@cold`)
+  FunctionFrequency frequency = FunctionFrequency::Default;
+};
+
 /// Represents the declaration of a function
 class FunctionDeclASTNode : public ASTNode,
                             public TopLevelASTNode,
                             public NamedDeclContext {
 
+  FunctionAttributes attributes_;
   NonNull<ArgumentDeclListASTNode*> arguments_;
   Nullable<AnonymousArgumentDeclASTNode*> returnType_;
   StmtASTNode* body_ = nullptr;
 
 public:
-  explicit FunctionDeclASTNode(Identifier const& name)
-      : ASTNode(ASTKind::KindFunctionDecl), NamedDeclContext(name) {}
+  explicit FunctionDeclASTNode(Identifier const& name,
+                               FunctionAttributes attributes = {})
+      : ASTNode(ASTKind::KindFunctionDecl),
+        NamedDeclContext(ASTKind::KindFunctionDecl, name),
+        attributes_(attributes) {}
+
+  FunctionAttributes const& getAttributes() const { return attributes_; }
+  /// Returns true when the function is multiversioned for several targets
+  bool hasTargetClones() const { return !attributes_.targetClones.empty(); }
 
   void setArgDeclList(ArgumentDeclListASTNode* arguments) {
     arguments_ = arguments;
@@ -193,9 +265,6 @@ public:
   StmtASTNode* getBody() { return body_; }
   StmtASTNode const* getBody() const { return body_; }
 
-  ASTNode* getDeclaringNode() override { return this; }
-  ASTNode const* getDeclaringNode() const override { return this; }
-
   llvm::SmallVector<ASTNode*, 3> children();
   llvm::SmallVector<ASTNode const*, 3> children() const;
 
@@ -206,19 +275,18 @@ public:
 
 /// Represents a list of AnonymousArgumentDeclASTNode
 class ArgumentDeclListASTNode : public ASTNode {
-  llvm::SmallVector<AnonymousArgumentDeclASTNode*, 2> arguments_;
+  ASTList<AnonymousArgumentDeclASTNode*> arguments_;
 
 public:
   explicit ArgumentDeclListASTNode() : ASTNode(ASTKind::KindArgumentDeclList) {}
 
-  void addArgument(AnonymousArgumentDeclASTNode* argument) {
-    arguments_.push_back(argument);
-  }
+  void setArguments(ASTContext* astContext,
+                    llvm::ArrayRef<AnonymousArgumentDeclASTNode*> arguments);
   llvm::ArrayRef<AnonymousArgumentDeclASTNode*> children() {
-    return arguments_;
+    return arguments_.elements();
   }
   llvm::ArrayRef<AnonymousArgumentDeclASTNode const*> children() const {
-    return arguments_;
+    return arguments_.elements();
   }
 
   static bool classof(ASTNode const* node) {
@@ -251,10 +319,7 @@ class NamedArgumentDeclASTNode : public AnonymousArgumentDeclASTNode,
 public:
   explicit NamedArgumentDeclASTNode(Identifier const& name)
       : AnonymousArgumentDeclASTNode(ASTKind::KindNamedArgumentDecl),
-        NamedDeclContext(name) {}
-
-  ASTNode* getDeclaringNode() override { return this; }
-  ASTNode const* getDeclaringNode() const override { return this; }
+        NamedDeclContext(ASTKind::KindNamedArgumentDecl, name) {}
 
   static bool classof(ASTNode const* node) {
     return node->isKind(ASTKind::KindNamedArgumentDecl);
@@ -272,7 +337,8 @@ class MetaDeclASTNode : public ASTNode,
 
 public:
   explicit MetaDeclASTNode(Identifier const& name)
-      : ASTNode(ASTKind::KindMetaDecl), NamedDeclContext(name) {}
+      : ASTNode(ASTKind::KindMetaDecl),
+        NamedDeclContext(ASTKind::KindMetaDecl, name) {}
 
   void setArgDeclList(ArgumentDeclListASTNode* arguments) {
     arguments_ = arguments;
@@ -291,9 +357,6 @@ public:
     return *contribution_;
   }
 
-  ASTNode* getDeclaringNode() override { return this; }
-  ASTNode const* getDeclaringNode() const override { return this; }
-
   std::array<ASTNode*, 2> children();
   std::array<ASTNode const*, 2> children() const;
 
@@ -311,7 +374,8 @@ class GlobalConstantDeclASTNode : public ASTNode,
 
 public:
   explicit GlobalConstantDeclASTNode(Identifier const& name)
-      : ASTNode(ASTKind::KindGlobalConstantDecl), NamedDeclContext(name) {}
+      : ASTNode(ASTKind::KindGlobalConstantDecl),
+        NamedDeclContext(ASTKind::KindGlobalConstantDecl, name) {}
 
   void setExpression(ConstantExprASTNode* expression) {
     expression_ = expression;
@@ -319,9 +383,6 @@ public:
   ConstantExprASTNode* getExpression() { return *expression_; }
   ConstantExprASTNode const* getExpression() const { return *expression_; }
 
-  ASTNode* getDeclaringNode() override { return this; }
-  ASTNode const* getDeclaringNode() const override { return this; }
-
   std::array<ConstantExprASTNode*, 1> children() { return {{*expression_}}; }
   std::array<ConstantExprASTNode const*, 1> children() const {
     return {{*expression_}};
@@ -336,7 +397,7 @@ public:
 /// instantiated in a meta declaration.
 class MetaContributionASTNode : public ASTNode, public IntermediateNode {
   SourceRange range_;
-  ASTChildSequence children_;
+  ASTList<ASTNode*> children_;
 
 public:
   explicit MetaContributionASTNode(SourceRange range)
@@ -344,10 +405,12 @@ public:
 
   SourceRange getSourceRange() const { return range_; }
 
-  /// Adds a ASTNode as child
-  void addChild(ASTNode* node) { children_.push_back(node); }
-  llvm::ArrayRef<ASTNode*> children() { return children_; }
-  llvm::ArrayRef<ASTNode const*> children() const { return children_; }
+  /// Sets the ASTNode's which are contributed
+  void setChildren(ASTContext* astContext, llvm::ArrayRef<ASTNode*> children);
+  llvm::ArrayRef<ASTNode*> children() { return children_.elements(); }
+  llvm::ArrayRef<ASTNode const*> children() const {
+    return children_.elements();
+  }
 
   static bool classof(ASTNode const* node) {
     return node->isKind(ASTKind::KindMetaContribution);
@@ -363,18 +426,43 @@ public:
   static bool classof(ASTNode const* node);
 };
 
+/// Represents a constant array which was exported by a meta calculation,
+/// those are emitted as private constants into the module.
+class GlobalConstantArrayDeclASTNode : public StmtASTNode,
+                                       public TopLevelASTNode,
+                                       public NamedDeclContext {
+  llvm::ArrayRef<std::int32_t> elements_;
+
+public:
+  GlobalConstantArrayDeclASTNode(Identifier const& name,
+                                 llvm::ArrayRef<std::int32_t> elements)
+      : StmtASTNode(ASTKind::KindGlobalConstantArrayDecl),
+        NamedDeclContext(ASTKind::KindGlobalConstantArrayDecl, name),
+        elements_(elements) {}
+
+  /// Returns the elements of the array which are owned by the ASTContext
+  llvm::ArrayRef<std::int32_t> getElements() const { return elements_; }
+  /// Returns the count of elements inside the array
+  std::uint32_t getSize() const { return std::uint32_t(elements_.size()); }
+
+  static bool classof(ASTNode const* node) {
+    return node->isKind(ASTKind::KindGlobalConstantArrayDecl);
+  }
+};
+
 class BasicCompoundStmtASTNode : public StmtASTNode {
-  llvm::SmallVector<StmtASTNode*, 12> statements_;
+  ASTList<StmtASTNode*> statements_;
 
 public:
   explicit BasicCompoundStmtASTNode(ASTKind kind) : StmtASTNode(kind) {}
 
-  void addStatement(StmtASTNode* statement) {
-    statements_.push_back(statement);
-  }
+  void setStatements(ASTContext* astContext,
+                     llvm::ArrayRef<StmtASTNode*> statements);
 
-  llvm::ArrayRef<StmtASTNode*> children() { return statements_; }
-  llvm::ArrayRef<StmtASTNode const*> children() const { return statements_; }
+  llvm::ArrayRef<StmtASTNode*> children() { return statements_.elements(); }
+  llvm::ArrayRef<StmtASTNode const*> children() const {
+    return statements_.elements();
+  }
 };
 
 /// Represents multiple statements which lie in it's own scope
@@ -418,6 +506,9 @@ public:
   }
 };
 
+/// Describes whether a branch is expected to be taken
+enum class BranchLikelihood { Default, Likely, Unlikely };
+
 template <typename T> class BasicIfStmtASTNode : public StmtASTNode {
   NonNull<ExprASTNode*> expression_;
   NonNull<T*> trueBranch_;
@@ -457,8 +548,16 @@ public:
 
 /// A conditional if statement
 class IfStmtASTNode : public BasicIfStmtASTNode<StmtASTNode> {
+  BranchLikelihood likelihood_;
+
 public:
-  explicit IfStmtASTNode() : BasicIfStmtASTNode(ASTKind::KindIfStmt) {}
+  explicit IfStmtASTNode(
+      BranchLikelihood likelihood = BranchLikelihood::Default)
+      : BasicIfStmtASTNode(ASTKind::KindIfStmt), likelihood_(likelihood) {}
+
+  /// Returns whether the true branch is expected to be taken
+  /// (`@likely` or `@unlikely`)
+  BranchLikelihood getLikelihood() const { return likelihood_; }
 
   static bool classof(ASTNode const* node) {
     return node->isKind(ASTKind::KindIfStmt);
@@ -477,6 +576,71 @@ public:
   }
 };
 
+/// A match statement which selects one of its arms by comparing
+/// the matched expression against the constant pattern of the arms.
+class MatchStmtASTNode : public StmtASTNode {
+  SourceRange range_;
+  NonNull<ExprASTNode*> expression_;
+  // Arms are stored as ASTNode since those can be contributed through
+  // a MetaIfStmtASTNode when the match is part of a meta decl.
+  ASTList<ASTNode*> arms_;
+
+public:
+  explicit MatchStmtASTNode(SourceRange range)
+      : StmtASTNode(ASTKind::KindMatchStmt), range_(range) {}
+
+  SourceRange getSourceRange() const { return range_; }
+
+  void setExpression(ExprASTNode* expression) { expression_ = expression; }
+  ExprASTNode* getExpression() { return *expression_; }
+  ExprASTNode const* getExpression() const { return *expression_; }
+
+  void setArms(ASTContext* astContext, llvm::ArrayRef<ASTNode*> arms);
+  llvm::ArrayRef<ASTNode*> getArms() { return arms_.elements(); }
+  llvm::ArrayRef<ASTNode const*> getArms() const { return arms_.elements(); }
+
+  ASTChildSequence children();
+  ConstASTChildSequence children() const;
+
+  static bool classof(ASTNode const* node) {
+    return node->isKind(ASTKind::KindMatchStmt);
+  }
+};
+
+/// Represents a single arm of a match statement, arms without
+/// a pattern are the wildcard arm `_` which matches everything.
+class MatchArmASTNode : public ASTNode {
+  SourceRange range_;
+  Nullable<ExprASTNode*> pattern_;
+  NonNull<StmtASTNode*> body_;
+
+public:
+  explicit MatchArmASTNode(SourceRange range)
+      : ASTNode(ASTKind::KindMatchArm), range_(range) {}
+
+  SourceRange getSourceRange() const { return range_; }
+
+  void setPattern(ExprASTNode* pattern) { pattern_ = pattern; }
+  Nullable<ExprASTNode*> getPattern() { return pattern_; }
+  Nullable<ExprASTNode const*> getPattern() const { return pattern_; }
+
+  /// Returns true when this arm is the wildcard arm
+  bool isWildcard() const { return !pattern_; }
+  /// Returns the constant value of the pattern if it's known
+  llvm::Optional<std::int32_t> getPatternValue() const;
+
+  void setBody(StmtASTNode* body) { body_ = body; }
+  StmtASTNode* getBody() { return *body_; }
+  StmtASTNode const* getBody() const { return *body_; }
+
+  llvm::SmallVector<ASTNode*, 2> children();
+  llvm::SmallVector<ASTNode const*, 2> children() const;
+
+  static bool classof(ASTNode const* node) {
+    return node->isKind(ASTKind::KindMatchArm);
+  }
+};
+
 /// A statement which evaluates an expression with dropping the result
 class ExpressionStmtASTNode : public StmtASTNode {
   NonNull<ExprASTNode*> expression_;
@@ -502,15 +666,13 @@ class DeclStmtASTNode : public StmtASTNode, public NamedDeclContext {
 
 public:
   explicit DeclStmtASTNode(Identifier const& name)
-      : StmtASTNode(ASTKind::KindDeclStmt), NamedDeclContext(name) {}
+      : StmtASTNode(ASTKind::KindDeclStmt),
+        NamedDeclContext(ASTKind::KindDeclStmt, name) {}
 
   void setExpression(ExprASTNode* expression) { expression_ = expression; }
   ExprASTNode* getExpression() { return *expression_; }
   ExprASTNode const* getExpression() const { return *expression_; }
 
-  ASTNode* getDeclaringNode() override { return this; }
-  ASTNode const* getDeclaringNode() const override { return this; }
-
   std::array<ExprASTNode*, 1> children();
   std::array<ExprASTNode const*, 1> children() const;
 
@@ -519,11 +681,30 @@ public:
   }
 };
 
+/// Represents a fixed-size array declaration such as `int[64] buf;`,
+/// the elements of the array are zero initialized.
+class ArrayDeclStmtASTNode : public StmtASTNode, public NamedDeclContext {
+  RangeAnnotated<std::uint32_t> size_;
+
+public:
+  ArrayDeclStmtASTNode(Identifier const& name,
+                       RangeAnnotated<std::uint32_t> const& size)
+      : StmtASTNode(ASTKind::KindArrayDeclStmt),
+        NamedDeclContext(ASTKind::KindArrayDeclStmt, name), size_(size) {}
+
+  /// Returns the count of elements inside the array
+  RangeAnnotated<std::uint32_t> const& getSize() const { return size_; }
+
+  static bool classof(ASTNode const* node) {
+    return node->isKind(ASTKind::KindArrayDeclStmt);
+  }
+};
+
 /// A statement which is evaluated at compile-time and that makes
 /// it's variables available to scopes below.
 class MetaCalculationStmtASTNode : public StmtASTNode, public IntermediateNode {
   NonNull<StmtASTNode*> stmt_;
-  llvm::SmallVector<NamedDeclContext*, 5> exportedDecls_;
+  ASTList<NamedDeclContext*> exportedDecls_;
 
 public:
   explicit MetaCalculationStmtASTNode()
@@ -536,14 +717,13 @@ public:
   std::array<StmtASTNode*, 1> children();
   std::array<StmtASTNode const*, 1> children() const;
 
-  void addExportedDecl(NamedDeclContext* decl) {
-    exportedDecls_.push_back(decl);
-  }
+  void setExportedDecls(ASTContext* astContext,
+                        llvm::ArrayRef<NamedDeclContext*> exportedDecls);
   llvm::ArrayRef<NamedDeclContext*> getExportedDecls() {
-    return exportedDecls_;
+    return exportedDecls_.elements();
   }
   llvm::ArrayRef<NamedDeclContext const*> getExportedDecls() const {
-    return exportedDecls_;
+    return exportedDecls_.elements();
   }
 
   static bool classof(ASTNode const* node) {
@@ -556,6 +736,12 @@ class ExprASTNode : public ASTNode {
 public:
   explicit ExprASTNode(ASTKind kind) : ASTNode(kind) {}
 
+  /// Returns the value of the expression when it's a known integral constant
+  llvm::Optional<std::int32_t> getConstantValue() const;
+  /// Returns true when the expression results in a boolean value,
+  /// like boolean literals and comparisons do.
+  bool isBooleanValued() const;
+
   static bool classof(ASTNode const* node);
 };
 
@@ -583,7 +769,7 @@ public:
 
 class MetaInstantiationExprASTNode : public ExprASTNode {
   NonNull<DeclRefExprASTNode*> decl_;
-  llvm::SmallVector<ExprASTNode*, 3> arguments_;
+  ASTList<ExprASTNode*> arguments_;
   SourceRange range_;
 
 public:
@@ -594,9 +780,12 @@ public:
   DeclRefExprASTNode* getDecl() { return *decl_; }
   DeclRefExprASTNode const* getDecl() const { return *decl_; }
 
-  void addArgument(ExprASTNode* node) { arguments_.push_back(node); }
-  llvm::ArrayRef<ExprASTNode*> getArguments() { return arguments_; }
-  llvm::ArrayRef<ExprASTNode const*> getArguments() const { return arguments_; }
+  void setArguments(ASTContext* astContext,
+                    llvm::ArrayRef<ExprASTNode*> arguments);
+  llvm::ArrayRef<ExprASTNode*> getArguments() { return arguments_.elements(); }
+  llvm::ArrayRef<ExprASTNode const*> getArguments() const {
+    return arguments_.elements();
+  }
 
   llvm::SmallVector<ExprASTNode*, 4> children();
   llvm::SmallVector<ExprASTNode const*, 4> children() const;
@@ -663,6 +852,23 @@ enum class ExprBinaryOperator {
 #include "AST.inl"
 };
 
+/// Returns the precedence of the binary operator,
+/// operators with a higher precedence bind stronger.
+inline unsigned getPrecedenceOf(ExprBinaryOperator binaryOperator) {
+  switch (binaryOperator) {
+#define EXPR_BINARY_OPERATOR(NAME, REP, PRECEDENCE)                            \
+  case ExprBinaryOperator::Operator##NAME:                                     \
+    return PRECEDENCE;
+#include "AST.inl"
+  }
+  return 0U;
+}
+
+/// Returns true when the binary operator is right associative
+inline bool isRightAssociative(ExprBinaryOperator binaryOperator) {
+  return binaryOperator == ExprBinaryOperator::OperatorAssign;
+}
+
 /// References a binary operator call
 class BinaryOperatorExprASTNode : public ExprASTNode {
   RangeAnnotated<ExprBinaryOperator> binaryOperator_;
@@ -695,10 +901,43 @@ public:
   }
 };
 
+/// References an element of a fixed-size array through `array[index]`
+class ArraySubscriptExprASTNode : public ExprASTNode {
+  SourceRange range_;
+  NonNull<ExprASTNode*> base_;
+  NonNull<ExprASTNode*> index_;
+
+public:
+  explicit ArraySubscriptExprASTNode(SourceRange range)
+      : ExprASTNode(ASTKind::KindArraySubscriptExpr), range_(range) {}
+
+  SourceRange getSourceRange() const { return range_; }
+
+  void setBaseExpr(ExprASTNode* base) { base_ = base; }
+  ExprASTNode* getBaseExpr() { return *base_; }
+  ExprASTNode const* getBaseExpr() const { return *base_; }
+
+  void setIndexExpr(ExprASTNode* index) { index_ = index; }
+  ExprASTNode* getIndexExpr() { return *index_; }
+  ExprASTNode const* getIndexExpr() const { return *index_; }
+
+  /// Returns the array declaration which is subscripted if it's known
+  Nullable<NamedDeclContext const*> getArrayDecl() const;
+  /// Returns the count of elements of the subscripted array if it's known
+  llvm::Optional<std::uint32_t> getArraySize() const;
+
+  std::array<ExprASTNode*, 2> children();
+  std::array<ExprASTNode const*, 2> children() const;
+
+  static bool classof(ASTNode const* node) {
+    return node->isKind(ASTKind::KindArraySubscriptExpr);
+  }
+};
+
 /// References a call operator
 class CallOperatorExprASTNode : public ExprASTNode {
   NonNull<ExprASTNode*> callee_;
-  llvm::SmallVector<ExprASTNode*, 3> expressions_;
+  ASTList<ExprASTNode*> expressions_;
 
 public:
   CallOperatorExprASTNode() : ExprASTNode(ASTKind::KindCallOperatorExpr) {}
@@ -707,10 +946,13 @@ public:
   ExprASTNode* getCallee() { return *callee_; }
   ExprASTNode const* getCallee() const { return *callee_; }
 
-  void addExpression(ExprASTNode* expr) { expressions_.push_back(expr); }
-  llvm::ArrayRef<ExprASTNode*> getExpressions() { return expressions_; }
+  void setExpressions(ASTContext* astContext,
+                      llvm::ArrayRef<ExprASTNode*> expressions);
+  llvm::ArrayRef<ExprASTNode*> getExpressions() {
+    return expressions_.elements();
+  }
   llvm::ArrayRef<ExprASTNode const*> getExpressions() const {
-    return expressions_;
+    return expressions_.elements();
   }
 
   ASTChildSequence children();
@@ -29,6 +29,7 @@
 
 FOR_EACH_AST_NODE(CompilationUnit)
 FOR_EACH_AST_NODE(MetaUnit)
+FOR_EACH_AST_NODE(ImportDecl)
 FOR_EACH_AST_NODE(FunctionDecl)
 FOR_EACH_AST_NODE(MetaDecl)
 FOR_EACH_AST_NODE(MetaContribution)
@@ -36,13 +37,17 @@ FOR_EACH_AST_NODE(ArgumentDeclList)
 FOR_EACH_AST_NODE(AnonymousArgumentDecl)
 FOR_EACH_AST_NODE(NamedArgumentDecl)
 FOR_EACH_AST_NODE(GlobalConstantDecl)
+FOR_EACH_AST_NODE(MatchArm)
 
 FOR_EACH_STMT_NODE(UnscopedCompoundStmt)
 FOR_EACH_STMT_NODE(CompoundStmt)
 FOR_EACH_STMT_NODE(ReturnStmt)
 FOR_EACH_STMT_NODE(ExpressionStmt)
 FOR_EACH_STMT_NODE(DeclStmt)
+FOR_EACH_STMT_NODE(ArrayDeclStmt)
+FOR_EACH_STMT_NODE(GlobalConstantArrayDecl)
 FOR_EACH_STMT_NODE(IfStmt)
+FOR_EACH_STMT_NODE(MatchStmt)
 FOR_EACH_STMT_NODE(MetaIfStmt)
 FOR_EACH_STMT_NODE(MetaCalculationStmt)
 
@@ -51,6 +56,7 @@ FOR_EACH_EXPR_NODE(IntegerLiteralExpr)
 FOR_EACH_EXPR_NODE(BooleanLiteralExpr)
 FOR_EACH_EXPR_NODE(ErroneousExpr)
 FOR_EACH_EXPR_NODE(BinaryOperatorExpr)
+FOR_EACH_EXPR_NODE(ArraySubscriptExpr)
 FOR_EACH_EXPR_NODE(CallOperatorExpr)
 FOR_EACH_EXPR_NODE(MetaInstantiationExpr)
 
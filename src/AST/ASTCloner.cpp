@@ -34,17 +34,28 @@ ASTNode* ASTCloner::clone(ASTNode const* node) {
 }
 
 CompilationUnitASTNode*
-ASTCloner::cloneCompilationUnit(CompilationUnitASTNode const* /*node*/) {
-  return allocate<CompilationUnitASTNode>();
+ASTCloner::cloneCompilationUnit(CompilationUnitASTNode const* node) {
+  return allocate<CompilationUnitASTNode>(node->isImported());
 }
 
 MetaUnitASTNode* ASTCloner::cloneMetaUnit(MetaUnitASTNode const* node) {
   return allocate<MetaUnitASTNode>(node->getInstantiation());
 }
 
+ImportDeclASTNode* ASTCloner::cloneImportDecl(ImportDeclASTNode const* node) {
+  return allocate<ImportDeclASTNode>(relocate(node->getPath()));
+}
+
 FunctionDeclASTNode*
 ASTCloner::cloneFunctionDecl(FunctionDeclASTNode const* node) {
-  return allocate<FunctionDeclASTNode>(relocate(node->getName()));
+  auto attributes = node->getAttributes();
+  llvm::SmallVector<Identifier, 2> targetClones;
+  for (auto const& target : attributes.targetClones) {
+    targetClones.push_back(relocate(target));
+  }
+  attributes.targetClones =
+      context_->allocateCopy(llvm::makeArrayRef(targetClones));
+  return allocate<FunctionDeclASTNode>(relocate(node->getName()), attributes);
 }
 
 MetaDeclASTNode* ASTCloner::cloneMetaDecl(MetaDeclASTNode const* node) {
@@ -56,6 +67,12 @@ ASTCloner::cloneGlobalConstantDecl(GlobalConstantDeclASTNode const* node) {
   return allocate<GlobalConstantDeclASTNode>(node->getName());
 }
 
+GlobalConstantArrayDeclASTNode* ASTCloner::cloneGlobalConstantArrayDecl(
+    GlobalConstantArrayDeclASTNode const* node) {
+  return allocate<GlobalConstantArrayDeclASTNode>(
+      relocate(node->getName()), context_->allocateCopy(node->getElements()));
+}
+
 MetaContributionASTNode*
 ASTCloner::cloneMetaContribution(MetaContributionASTNode const* node) {
   return allocate<MetaContributionASTNode>(relocate(node->getSourceRange()));
@@ -106,8 +123,22 @@ DeclStmtASTNode* ASTCloner::cloneDeclStmt(DeclStmtASTNode const* node) {
   return allocate<DeclStmtASTNode>(relocate(node->getName()));
 }
 
-IfStmtASTNode* ASTCloner::cloneIfStmt(IfStmtASTNode const* /*node*/) {
-  return allocate<IfStmtASTNode>();
+ArrayDeclStmtASTNode*
+ASTCloner::cloneArrayDeclStmt(ArrayDeclStmtASTNode const* node) {
+  return allocate<ArrayDeclStmtASTNode>(relocate(node->getName()),
+                                        relocate(node->getSize()));
+}
+
+IfStmtASTNode* ASTCloner::cloneIfStmt(IfStmtASTNode const* node) {
+  return allocate<IfStmtASTNode>(node->getLikelihood());
+}
+
+MatchStmtASTNode* ASTCloner::cloneMatchStmt(MatchStmtASTNode const* node) {
+  return allocate<MatchStmtASTNode>(relocate(node->getSourceRange()));
+}
+
+MatchArmASTNode* ASTCloner::cloneMatchArm(MatchArmASTNode const* node) {
+  return allocate<MatchArmASTNode>(relocate(node->getSourceRange()));
 }
 
 MetaIfStmtASTNode*
@@ -146,6 +177,11 @@ ASTCloner::cloneBinaryOperatorExpr(BinaryOperatorExprASTNode const* node) {
       relocate(node->getBinaryOperator()));
 }
 
+ArraySubscriptExprASTNode*
+ASTCloner::cloneArraySubscriptExpr(ArraySubscriptExprASTNode const* node) {
+  return allocate<ArraySubscriptExprASTNode>(relocate(node->getSourceRange()));
+}
+
 CallOperatorExprASTNode*
 ASTCloner::cloneCallOperatorExpr(CallOperatorExprASTNode const* /*node*/) {
   return allocate<CallOperatorExprASTNode>();
@@ -17,27 +17,75 @@
 
 #include "ASTContext.hpp"
 
+#include <algorithm>
+#include <vector>
+
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+
 #include "AST.hpp"
 
+/// Returns the name of the given ASTKind
+static llvm::StringRef nameOfKind(ASTKind kind) {
+  switch (kind) {
+#define FOR_EACH_AST_NODE(NAME)                                                \
+  case ASTKind::Kind##NAME:                                                    \
+    return #NAME;
+#include "AST.inl"
+  }
+  llvm_unreachable("Unknown ASTKind!");
+}
+
 ASTContext::~ASTContext() {
-  // Call the destructor for all allocated AST nodes
-  for (auto allocated : allocated_) {
-    allocated->~ASTFragment();
+  // AST nodes are released together with the slabs of the allocator
+  for (auto const& fragment : destructible_) {
+    fragment.second(fragment.first);
   }
 }
 
-llvm::StringRef ASTContext::poolString(llvm::StringRef str) {
-  auto itr = stringPool_.find(str);
-  if (itr != stringPool_.end()) {
-    return *itr;
+void ASTContext::printStatistics(llvm::raw_ostream& out) const {
+  // Accumulate the statistics of the adopted contexts
+  std::array<NodeStatistic, ASTKindCount> nodes;
+  std::size_t listBytes = 0;
+  std::size_t totalBytes = 0;
+  std::vector<ASTContext const*> worklist{this};
+  while (!worklist.empty()) {
+    auto current = worklist.back();
+    worklist.pop_back();
+    for (std::size_t i = 0; i < ASTKindCount; ++i) {
+      nodes[i].count += current->nodeStatistics_[i].count;
+      nodes[i].bytes += current->nodeStatistics_[i].bytes;
+    }
+    listBytes += current->listBytes_;
+    totalBytes += current->allocator_.getBytesAllocated();
+    for (auto const& adopted : current->adopted_) {
+      worklist.push_back(adopted.get());
+    }
+  }
+
+  std::vector<std::size_t> order;
+  for (std::size_t i = 0; i < ASTKindCount; ++i) {
+    if (nodes[i].count) {
+      order.push_back(i);
+    }
   }
-  auto const size = str.size();
-  auto* rep = static_cast<char*>(allocator_.Allocate(size, alignof(char)));
+  std::sort(order.begin(), order.end(), [&](std::size_t l, std::size_t r) {
+    return nodes[l].bytes > nodes[r].bytes;
+  });
 
-  for (std::size_t i = 0; i < size; ++i) {
-    rep[i] = str[i];
+  std::size_t nodeCount = 0;
+  std::size_t nodeBytes = 0;
+  out << llvm::format("%-28s %10s %12s %8s\n", "Kind", "Count", "Bytes",
+                      "Size");
+  for (auto i : order) {
+    out << llvm::format("%-28s %10zu %12zu %8zu\n",
+                        nameOfKind(ASTKind(i)).str().c_str(), nodes[i].count,
+                        nodes[i].bytes, nodes[i].bytes / nodes[i].count);
+    nodeCount += nodes[i].count;
+    nodeBytes += nodes[i].bytes;
   }
-  llvm::StringRef ref(rep, size);
-  stringPool_.insert(ref);
-  return ref;
+  out << llvm::format("%-28s %10zu %12zu\n", "Nodes", nodeCount, nodeBytes);
+  out << llvm::format("%-28s %10s %12zu\n", "Child lists", "", listBytes);
+  out << llvm::format("%-28s %10s %12zu\n", "Allocated", "", totalBytes);
 }
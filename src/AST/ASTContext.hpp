@@ -18,33 +18,55 @@
 #ifndef AST_CONTEXT_HPP_INCLUDED__
 #define AST_CONTEXT_HPP_INCLUDED__
 
-#include <deque>
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <type_traits>
-#include <unordered_set>
+#include <utility>
+#include <vector>
 
-#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/Support/Allocator.h"
 
 #include "ASTFragment.hpp"
+#include "ASTList.hpp"
 #include "ASTPredicate.hpp"
-#include "Hash.hpp"
 #include "Traits.hpp"
 
+namespace llvm {
+class raw_ostream;
+}
+
 class ASTNode;
 
 /// Represents the context of an abstract syntax tree
 ///
 /// Contains the allocated memory for it and also keeps
 /// fragments that aren't part of the AST accessible.
+///
+/// AST nodes are trivially destructible, so releasing them only frees the
+/// slabs of the allocator. Only the few other fragments like scopes are
+/// destructed one by one.
 class ASTContext {
+  using Destructor = void (*)(ASTFragment*);
+
   llvm::BumpPtrAllocator allocator_;
-  std::deque<ASTFragment*> allocated_;
+  /// The fragments which aren't trivially destructible
+  std::vector<std::pair<ASTFragment*, Destructor>> destructible_;
+
+  /// ASTContexts which nodes are part of the AST of this context
+  std::vector<std::unique_ptr<ASTContext>> adopted_;
 
-  // We can ensure that all strings are needed due to the lifetime
-  // of this context so we don't need a reference counted pool
-  // like llvm::StringPool.
-  std::unordered_set<llvm::StringRef, StringRefHasher> stringPool_;
+  /// Describes the memory which was allocated for a kind of ASTNode's
+  struct NodeStatistic {
+    std::size_t count = 0;
+    std::size_t bytes = 0;
+  };
+  std::array<NodeStatistic, ASTKindCount> nodeStatistics_;
+  /// The bytes which were allocated for the storage of child lists
+  std::size_t listBytes_ = 0;
 
 public:
   ASTContext() = default;
@@ -56,15 +78,84 @@ public:
   template <typename T, typename... Args> T* allocate(Args&&... args) {
     static_assert(std::is_base_of<ASTFragment, T>::value,
                   "Can only allocate ASTFragment's!");
+    static_assert(!std::is_base_of<ASTNode, T>::value ||
+                      std::is_trivially_destructible<T>::value,
+                  "ASTNode's are required to be trivially destructible!");
     T* allocated = static_cast<T*>(allocator_.Allocate(sizeof(T), alignof(T)));
     new (allocated) T(std::forward<Args>(args)...);
+    staticIf(allocated, pred::isBaseOf<ASTNode>(), [&](ASTNode* node) {
+      auto& statistic = nodeStatistics_[std::size_t(node->getKind())];
+      ++statistic.count;
+      statistic.bytes += sizeof(T);
+    });
     staticIf(allocated, pred::isNotTrivialDestructible(),
-             [&](ASTFragment* fragment) { allocated_.push_back(fragment); });
+             [&](ASTFragment* fragment) {
+               destructible_.emplace_back(fragment, [](ASTFragment* current) {
+                 static_cast<T*>(current)->~T();
+               });
+             });
     return allocated;
   }
 
-  /// Pools the string into the internal string table
-  llvm::StringRef poolString(llvm::StringRef str);
+  /// Copies the given trivial elements into the ASTContext,
+  /// the copy stays valid for the lifetime of the ASTContext.
+  template <typename T>
+  llvm::ArrayRef<T> allocateCopy(llvm::ArrayRef<T> elements) {
+    static_assert(std::is_trivially_destructible<T>::value,
+                  "Can only copy trivial destructible elements!");
+    T* allocated = allocator_.Allocate<T>(elements.size());
+    std::uninitialized_copy(elements.begin(), elements.end(), allocated);
+    return llvm::makeArrayRef(allocated, elements.size());
+  }
+
+  /// Replaces the elements of the list through the given ones,
+  /// where the storage of the list is allocated exactly sized.
+  template <typename T>
+  void assign(ASTList<T>& list, llvm::ArrayRef<T> elements) {
+    if (elements.empty()) {
+      list = ASTList<T>();
+      return;
+    }
+    T* data = allocator_.Allocate<T>(elements.size());
+    listBytes_ += elements.size() * sizeof(T);
+    std::uninitialized_copy(elements.begin(), elements.end(), data);
+    list.data_ = data;
+    list.size_ = std::uint32_t(elements.size());
+    list.capacity_ = list.size_;
+  }
+
+  /// Allocates an uninitialized array of trivial elements inside the
+  /// ASTContext, which stays valid for the lifetime of the ASTContext.
+  template <typename T> T* allocateArray(std::size_t count) {
+    static_assert(std::is_trivially_destructible<T>::value,
+                  "Can only allocate trivial destructible elements!");
+    return allocator_.Allocate<T>(count);
+  }
+
+  /// Appends the given element to the list, where the storage of the list
+  /// is allocated inside the ASTContext.
+  /// Prefer assign when the count of elements is known upfront.
+  template <typename T> void append(ASTList<T>& list, T element) {
+    if (list.size_ == list.capacity_) {
+      auto const capacity = std::max(2 * list.capacity_, std::uint32_t(4));
+      T* data = allocator_.Allocate<T>(capacity);
+      listBytes_ += capacity * sizeof(T);
+      std::uninitialized_copy(list.begin(), list.end(), data);
+      list.data_ = data;
+      list.capacity_ = capacity;
+    }
+    list.data_[list.size_++] = element;
+  }
+
+  /// Prints the memory which was allocated for each kind of ASTNode's
+  /// in this context and the adopted ones.
+  void printStatistics(llvm::raw_ostream& out) const;
+
+  /// Takes the ownership over the given ASTContext, which keeps the nodes
+  /// and strings allocated inside it alive for the lifetime of this context.
+  void adopt(std::unique_ptr<ASTContext> astContext) {
+    adopted_.push_back(std::move(astContext));
+  }
 };
 
 /// Represents a shared instance of an ASTContext
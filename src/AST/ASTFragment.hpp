@@ -20,10 +20,12 @@
 
 /// Represents an ASTFragment which is managed in by it's
 /// corresponding ASTContext.
+///
+/// The destructor isn't virtual, since AST nodes are trivially destructible
+/// and the ASTContext destructs all other fragments through their type.
 class ASTFragment {
 public:
   ASTFragment() = default;
-  virtual ~ASTFragment() = default;
 };
 
 /// Represents an intermediate node which must not passed to any codegen
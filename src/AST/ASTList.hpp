@@ -0,0 +1,61 @@
+
+/**
+  Copyright(c) 2016 - 2017 Denis Blank <denis.blank at outlook dot com>
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+**/
+
+#ifndef AST_LIST_HPP_INCLUDED__
+#define AST_LIST_HPP_INCLUDED__
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "llvm/ADT/ArrayRef.h"
+
+class ASTContext;
+
+/// Represents a list of elements which are stored inside an ASTContext,
+/// so nodes holding the list stay trivially destructible.
+///
+/// Lists are usually set once through ASTContext::assign when the count
+/// of elements is known, which allocates the storage exactly sized.
+/// Lists which are filled lazily are appended through ASTContext::append,
+/// where the storage grows geometrically.
+template <typename T> class ASTList {
+  friend class ASTContext;
+
+  static_assert(std::is_trivially_destructible<T>::value,
+                "Can only store trivial destructible elements!");
+
+  T* data_ = nullptr;
+  std::uint32_t size_ = 0;
+  std::uint32_t capacity_ = 0;
+
+public:
+  ASTList() = default;
+
+  /// Returns true when the list contains no elements
+  bool empty() const { return size_ == 0; }
+  /// Returns the count of elements inside the list
+  std::size_t size() const { return size_; }
+
+  T* begin() const { return data_; }
+  T* end() const { return data_ + size_; }
+
+  /// Returns the elements of the list
+  llvm::ArrayRef<T> elements() const { return {data_, size_}; }
+};
+
+#endif // #ifndef AST_LIST_HPP_INCLUDED__
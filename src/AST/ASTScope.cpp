@@ -17,27 +17,62 @@
 
 #include "ASTScope.hpp"
 
+#include <algorithm>
 #include <assert.h>
-#include <tuple>
-#include <unordered_map>
+#include <cstdint>
+#include <mutex>
+#include <vector>
 
-// #include "llvm/ADT/StringMap.h"
-#include "Hash.hpp"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
 
 #include "AST.hpp"
 #include "ASTContext.hpp"
+#include "SimilarityIndex.hpp"
 
-template <typename Current, bool IsConsistent>
-class AllocatedScope : public Current {
-  llvm::Optional<Current const*> parent_;
-  std::unordered_map<llvm::StringRef, NamedDeclContext*, StringRefHasher>
-      lookupMap_;
+static unsigned const THRESHOLD = 10U;
 
-  static unsigned const THRESHOLD = 10U;
+/// Replaces the current most similar declaration by the given candidate,
+/// when the candidate is more similar to the given string.
+static void updateMostSimilar(llvm::StringRef str, Symbol symbol,
+                              NamedDeclContext* candidate, unsigned& distance,
+                              NamedDeclContext*& current) {
+  auto similarity = str.edit_distance(symbol.getString(), true, THRESHOLD);
+  if (similarity < distance) {
+    distance = similarity;
+    current = candidate;
+  }
+}
+
+/// A consistent scope which stores its entries inside the ASTContext
+/// through an open addressing hash table with linear probing.
+///
+/// The similarity index of the entries is built on the first search for
+/// a similar declaration, since it's only required for diagnostics.
+/// Searches are guarded by a mutex, since the scope can be read from
+/// multiple threads while it isn't modified.
+class ConsistentASTScopeImpl : public ConsistentASTScope {
+  struct Entry {
+    Symbol symbol;
+    /// Is null when the entry was erased
+    NamedDeclContext* decl;
+  };
+
+  ASTContext* astContext_;
+  llvm::Optional<ConsistentASTScope const*> parent_;
+  Entry* buckets_ = nullptr;
+  std::uint32_t capacity_ = 0U;
+  /// The count of occupied buckets including the erased ones
+  std::uint32_t occupied_ = 0U;
+  /// Indexes the symbols of the entries including the erased ones
+  mutable SimilarityIndex similarityIndex_;
+  mutable bool isIndexed_ = false;
+  mutable std::mutex similarityMutex_;
 
 public:
-  explicit AllocatedScope(llvm::Optional<Current const*> parent)
-      : parent_(parent) {
+  ConsistentASTScopeImpl(ASTContext* astContext,
+                         llvm::Optional<ConsistentASTScope const*> parent)
+      : astContext_(astContext), parent_(parent) {
     assert((!parent.hasValue() || *parent) &&
            "Parent isn't allowed to be null!");
   }
@@ -49,79 +84,238 @@ public:
       return llvm::Optional<ASTScope const*>();
   }
 
-  void insert(llvm::StringRef str, NamedDeclContext* node) override {
-    assert(!lookupMap_.count(str) &&
-           "The entry should never exists in the same scope");
-    lookupMap_.insert(std::make_pair(str, node));
+  void insert(Symbol symbol, NamedDeclContext* node) override {
+    // Keep the load factor below three quarters
+    if (4U * (occupied_ + 1U) > 3U * capacity_) {
+      grow();
+    }
+    auto entry = probe(symbol);
+    assert(!entry->decl && "The entry should never exists in the same scope");
+    if (entry->symbol != symbol) {
+      entry->symbol = symbol;
+      ++occupied_;
+    }
+    entry->decl = node;
+
+    if (isIndexed_) {
+      similarityIndex_.insert(symbol);
+    }
   }
 
-  Nullable<NamedDeclContext*>
-  lookupIdentifier(llvm::StringRef str) const override {
-    auto itr = lookupMap_.find(str);
-    if (itr != lookupMap_.end())
-      return itr->second;
-    else if (parent_)
-      return (*parent_)->lookupIdentifier(str);
+  void erase(Symbol symbol) override {
+    if (capacity_) {
+      probe(symbol)->decl = nullptr;
+    }
+  }
+
+  Nullable<NamedDeclContext*> lookupIdentifier(Symbol symbol) const override {
+    if (capacity_) {
+      if (auto decl = probe(symbol)->decl) {
+        return decl;
+      }
+    }
+    if (parent_)
+      return (*parent_)->lookupIdentifier(symbol);
     else
       return nullptr;
   }
 
-  bool isConsistent() const override { return IsConsistent; }
+  bool isConsistent() const override { return true; }
 
-  Nullable<NamedDeclContext*> similarTo(llvm::StringRef str) const override {
-    return similarTo(str, THRESHOLD, nullptr);
+  Nullable<NamedDeclContext*> similarTo(Symbol symbol) const override {
+    return similarTo(symbol, THRESHOLD, nullptr);
   }
 
   Nullable<NamedDeclContext*>
-  similarTo(llvm::StringRef str, unsigned distance,
+  similarTo(Symbol symbol, unsigned distance,
             NamedDeclContext* current) const override {
-    // Calculate the local most similar declaration
-    {
-      NamedDeclContext* myCurrent;
-      unsigned myDistance;
-      std::tie(myCurrent, myDistance) = myMostSimilarString(str);
-
-      if (myDistance < distance) {
-        distance = myDistance;
-        current = myCurrent;
+    std::unique_lock<std::mutex> lock(similarityMutex_);
+    if (!isIndexed_) {
+      for (auto entry = buckets_; entry != buckets_ + capacity_; ++entry) {
+        if (entry->decl) {
+          similarityIndex_.insert(entry->symbol);
+        }
       }
+      isIndexed_ = true;
+    }
+
+    auto similar = similarityIndex_.findMostSimilar(
+        symbol, distance,
+        [&](Symbol candidate) { return probe(candidate)->decl != nullptr; });
+    if (similar) {
+      current = probe(*similar)->decl;
     }
+    lock.unlock();
 
     if (parent_)
-      return (*parent_)->similarTo(str, distance, current);
+      return (*parent_)->similarTo(symbol, distance, current);
     else
       return current;
   }
 
 private:
-  std::tuple<NamedDeclContext*, std::size_t>
-  myMostSimilarString(llvm::StringRef str) const {
-    NamedDeclContext* myMostSimilarContext = nullptr;
-    auto myMostSimilarValue = THRESHOLD;
+  /// Returns the bucket which contains the given symbol,
+  /// or the empty bucket where the symbol would be inserted.
+  Entry* probe(Symbol symbol) const {
+    auto const mask = capacity_ - 1U;
+    auto index = llvm::DenseMapInfo<Symbol>::getHashValue(symbol) & mask;
+    auto const empty = llvm::DenseMapInfo<Symbol>::getEmptyKey();
+    while ((buckets_[index].symbol != symbol) &&
+           (buckets_[index].symbol != empty)) {
+      index = (index + 1U) & mask;
+    }
+    return &buckets_[index];
+  }
+
+  /// Doubles the count of buckets, where the previous buckets are
+  /// released together with the ASTContext.
+  void grow() {
+    auto const previous = llvm::makeArrayRef(buckets_, capacity_);
+    capacity_ = std::max(2U * capacity_, 16U);
+    buckets_ = astContext_->allocateArray<Entry>(capacity_);
+    std::fill(buckets_, buckets_ + capacity_,
+              Entry{llvm::DenseMapInfo<Symbol>::getEmptyKey(), nullptr});
+    occupied_ = 0U;
+    for (auto const& entry : previous) {
+      // Erased entries are dropped
+      if (entry.decl) {
+        *probe(entry.symbol) = entry;
+        ++occupied_;
+      }
+    }
+  }
+};
+
+class TemporaryASTScopeImpl : public TemporaryASTScope {
+  struct Entry {
+    Symbol symbol;
+    NamedDeclContext* decl;
+    /// The index of the entry which is shadowed through this one
+    std::uint32_t shadowed;
+  };
 
-    for (auto const& entry : lookupMap_) {
-      auto similarity = str.edit_distance(entry.first, true, THRESHOLD);
+  static std::uint32_t const NoEntry = ~0U;
 
-      if (similarity < myMostSimilarValue) {
-        myMostSimilarContext = entry.second;
-        myMostSimilarValue = similarity;
+  Nullable<ASTScope const*> parent_;
+  /// Maps every symbol to its innermost visible entry
+  llvm::DenseMap<Symbol, std::uint32_t> visible_;
+  /// The entries of all scopes in the order they were introduced
+  std::vector<Entry> entries_;
+  /// The count of entries when the scopes were entered
+  std::vector<std::uint32_t> scopes_;
+
+public:
+  TemporaryASTScopeImpl() = default;
+
+  void enter(ASTScope const* parent) override {
+    if (scopes_.empty()) {
+      parent_ = parent;
+    }
+    scopes_.push_back(std::uint32_t(entries_.size()));
+  }
+
+  void leave() override {
+    assert(!scopes_.empty() && "Tried to leave an empty scope stack!");
+    auto const begin = scopes_.back();
+    scopes_.pop_back();
+
+    // Uncover the shadowed entries in reverse order of introduction
+    while (entries_.size() > begin) {
+      auto const index = std::uint32_t(entries_.size() - 1U);
+      auto const& entry = entries_.back();
+      auto itr = visible_.find(entry.symbol);
+      // The entry could have been erased already
+      if ((itr != visible_.end()) && (itr->second == index)) {
+        if (entry.shadowed != NoEntry) {
+          itr->second = entry.shadowed;
+        } else {
+          visible_.erase(itr);
+        }
       }
+      entries_.pop_back();
     }
 
-    return std::make_tuple(myMostSimilarContext, myMostSimilarValue);
+    if (scopes_.empty()) {
+      parent_ = nullptr;
+    }
+  }
+
+  llvm::Optional<ASTScope const*> parent() const override {
+    if (parent_)
+      return llvm::Optional<ASTScope const*>(*parent_);
+    else
+      return llvm::Optional<ASTScope const*>();
+  }
+
+  void insert(Symbol symbol, NamedDeclContext* node) override {
+    assert(!scopes_.empty() && "Tried to insert into an empty scope stack!");
+    auto const index = std::uint32_t(entries_.size());
+    auto shadowed = NoEntry;
+
+    auto inserted = visible_.insert(std::make_pair(symbol, index));
+    if (!inserted.second) {
+      shadowed = inserted.first->second;
+      assert((shadowed < scopes_.back()) &&
+             "The entry should never exists in the same scope");
+      inserted.first->second = index;
+    }
+    entries_.push_back({symbol, node, shadowed});
+  }
+
+  void erase(Symbol symbol) override {
+    auto itr = visible_.find(symbol);
+    // Only entries of the innermost scope are erased
+    if ((itr == visible_.end()) || (itr->second < scopes_.back())) {
+      return;
+    }
+    auto const shadowed = entries_[itr->second].shadowed;
+    if (shadowed != NoEntry) {
+      itr->second = shadowed;
+    } else {
+      visible_.erase(itr);
+    }
+  }
+
+  Nullable<NamedDeclContext*> lookupIdentifier(Symbol symbol) const override {
+    auto itr = visible_.find(symbol);
+    if (itr != visible_.end())
+      return entries_[itr->second].decl;
+    else if (parent_)
+      return (*parent_)->lookupIdentifier(symbol);
+    else
+      return nullptr;
+  }
+
+  bool isConsistent() const override { return false; }
+
+  Nullable<NamedDeclContext*> similarTo(Symbol symbol) const override {
+    return similarTo(symbol, THRESHOLD, nullptr);
+  }
+
+  Nullable<NamedDeclContext*>
+  similarTo(Symbol symbol, unsigned distance,
+            NamedDeclContext* current) const override {
+    auto const str = symbol.getString();
+    for (auto const& visible : visible_) {
+      updateMostSimilar(str, visible.first, entries_[visible.second].decl,
+                        distance, current);
+    }
+
+    if (parent_)
+      return (*parent_)->similarTo(symbol, distance, current);
+    else
+      return current;
   }
 };
 
-std::unique_ptr<ASTScope>
-ASTScope::CreateTemporary(llvm::Optional<ASTScope const*> parent) {
-  return std::make_unique<AllocatedScope<ASTScope, false>>(parent);
+std::unique_ptr<TemporaryASTScope> TemporaryASTScope::CreateTemporary() {
+  return std::make_unique<TemporaryASTScopeImpl>();
 }
 
 ConsistentASTScope* ConsistentASTScope::CreateConsistent(
     ASTContext* astContext,
     llvm::Optional<ConsistentASTScope const*> parent /*= llvm::None*/) {
-  // TODO Also allocate scoped entries through the ASTContext allocator
-  return astContext->allocate<AllocatedScope<ConsistentASTScope, true>>(parent);
+  return astContext->allocate<ConsistentASTScopeImpl>(astContext, parent);
 }
 
 class InplaceASTScopeImpl : public InplaceASTScope {
@@ -136,22 +330,22 @@ public:
   llvm::Optional<ASTScope const*> parent() const override {
     return parent_->parent();
   }
-  void insert(llvm::StringRef str, NamedDeclContext* node) override {
-    parent_->insert(str, node);
+  void insert(Symbol symbol, NamedDeclContext* node) override {
+    parent_->insert(symbol, node);
     listener_(node);
   }
-  Nullable<NamedDeclContext*>
-  lookupIdentifier(llvm::StringRef str) const override {
-    return parent_->lookupIdentifier(str);
+  void erase(Symbol symbol) override { parent_->erase(symbol); }
+  Nullable<NamedDeclContext*> lookupIdentifier(Symbol symbol) const override {
+    return parent_->lookupIdentifier(symbol);
   }
   bool isConsistent() const override { return parent_->isConsistent(); }
-  Nullable<NamedDeclContext*> similarTo(llvm::StringRef str) const override {
-    return parent_->similarTo(str);
+  Nullable<NamedDeclContext*> similarTo(Symbol symbol) const override {
+    return parent_->similarTo(symbol);
   }
   Nullable<NamedDeclContext*>
-  similarTo(llvm::StringRef str, unsigned distance,
+  similarTo(Symbol symbol, unsigned distance,
             NamedDeclContext* current) const override {
-    return parent_->similarTo(str, distance, current);
+    return parent_->similarTo(symbol, distance, current);
   }
 };
 
@@ -22,10 +22,10 @@
 
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/STLExtras.h"
-#include "llvm/ADT/StringRef.h"
 
 #include "ASTFragment.hpp"
 #include "Nullable.hpp"
+#include "Symbol.hpp"
 
 class ASTContext;
 class NamedDeclContext;
@@ -33,38 +33,39 @@ class NamedDeclContext;
 /// Represents a scoped visibility for identifiers that reference
 /// to an unique NamedDeclASTNode which is represented by that identifier.
 ///
-/// This class is similar to llvm::ScopedHashTable, however it provides
-/// support for multiple living scopes inheriting from the same scope.
+/// Consistent scopes provide support for multiple living scopes inheriting
+/// from the same scope, whereas nested temporary scopes are represented
+/// through a single TemporaryASTScope similar to llvm::ScopedHashTable.
 class ASTScope : public ASTFragment {
 public:
   ASTScope() = default;
   ASTScope(ASTScope&&) = delete;
   ASTScope& operator=(ASTScope&&) = delete;
+  virtual ~ASTScope() = default;
 
   /// Returns the parent of this scope
   virtual llvm::Optional<ASTScope const*> parent() const = 0;
 
-  /// Inserts the given string into this scope
-  virtual void insert(llvm::StringRef str, NamedDeclContext* node) = 0;
+  /// Inserts the given symbol into this scope
+  virtual void insert(Symbol symbol, NamedDeclContext* node) = 0;
+
+  /// Removes the given symbol from this scope if it's present,
+  /// the parent scopes are left untouched.
+  virtual void erase(Symbol symbol) = 0;
 
   /// Returns the NamedDeclASTNode visible in the current scope that is
-  /// matching the given StringRef.
-  virtual Nullable<NamedDeclContext*>
-  lookupIdentifier(llvm::StringRef str) const = 0;
+  /// matching the given Symbol.
+  virtual Nullable<NamedDeclContext*> lookupIdentifier(Symbol symbol) const = 0;
 
   /// Returns true when this scope is permanent within this context
   virtual bool isConsistent() const = 0;
 
   /// Returns the most obvious alternative in the current
-  /// scope to the given string
-  virtual Nullable<NamedDeclContext*> similarTo(llvm::StringRef str) const = 0;
-
-  //// Allocates a temporary scope
-  static std::unique_ptr<ASTScope>
-  CreateTemporary(llvm::Optional<ASTScope const*> parent = llvm::None);
+  /// scope to the given symbol
+  virtual Nullable<NamedDeclContext*> similarTo(Symbol symbol) const = 0;
 
   virtual Nullable<NamedDeclContext*>
-  similarTo(llvm::StringRef str, unsigned distance,
+  similarTo(Symbol symbol, unsigned distance,
             NamedDeclContext* current) const = 0;
 };
 
@@ -80,6 +81,28 @@ public:
       llvm::Optional<ConsistentASTScope const*> parent = llvm::None);
 };
 
+/// Represents a stack of nested temporary scopes through a flat table,
+/// which maps every symbol to the stack of its visible declarations.
+///
+/// Entering a scope only records the current height of the stacks,
+/// leaving it pops the declarations which were introduced inside it.
+/// Thus a lookup is a single hash probe independent of the nesting depth,
+/// symbols which aren't declared in any of the temporary scopes are
+/// looked up in the parent of the outermost scope.
+class TemporaryASTScope : public ASTScope {
+public:
+  TemporaryASTScope() = default;
+
+  /// Enters a new nested scope, where the given parent is used
+  /// when the stack was empty before.
+  virtual void enter(ASTScope const* parent) = 0;
+  /// Leaves the innermost scope and removes its declarations
+  virtual void leave() = 0;
+
+  /// Allocates an empty stack of temporary scopes
+  static std::unique_ptr<TemporaryASTScope> CreateTemporary();
+};
+
 /// Represents an inplace AST scope which doesn't introduce a new logical layer
 /// but provides the capability on listening on node introduces into the
 /// current layer.
@@ -38,9 +38,20 @@ llvm::StringRef ASTStringer::toTypeString(ASTNode const* node) {
   });
 }
 
+llvm::StringRef ASTStringer::toTypeString(ASTKind kind) {
+  switch (kind) {
+#define FOR_EACH_AST_NODE(NAME)                                                \
+  case ASTKind::Kind##NAME:                                                    \
+    return #NAME;
+#include "AST.inl"
+    default:
+      llvm_unreachable("Unregistered node kind!");
+  }
+}
+
 llvm::Optional<std::string>
 ASTStringer::toStringImpl(NamedDeclContext const* decl) {
-  return decl->getName()->str();
+  return decl->getName()->getString().str();
 }
 
 llvm::Optional<std::string>
@@ -74,3 +85,26 @@ ASTStringer::toStringImpl(BinaryOperatorExprASTNode const* node) {
       llvm_unreachable("Unhandled binary expr operator!");
   }
 }
+
+llvm::Optional<std::string>
+ASTStringer::toStringImpl(ArrayDeclStmtASTNode const* node) {
+  return fmt::format("{}[{}]", node->getName().getType(), *node->getSize());
+}
+
+llvm::Optional<std::string>
+ASTStringer::toStringImpl(GlobalConstantArrayDeclASTNode const* node) {
+  return fmt::format("{}[{}]", node->getName().getType(), node->getSize());
+}
+
+llvm::Optional<std::string>
+ASTStringer::toStringImpl(ImportDeclASTNode const* node) {
+  return fmt::format("\"{}\"", *node->getPath());
+}
+
+llvm::Optional<std::string>
+ASTStringer::toStringImpl(MatchArmASTNode const* node) {
+  if (node->isWildcard()) {
+    return std::string("_");
+  }
+  return llvm::None;
+}
@@ -45,10 +45,20 @@ class ASTStringer {
   toStringImpl(BooleanLiteralExprASTNode const* node);
   static llvm::Optional<std::string>
   toStringImpl(BinaryOperatorExprASTNode const* node);
+  static llvm::Optional<std::string>
+  toStringImpl(MatchArmASTNode const* node);
+  static llvm::Optional<std::string>
+  toStringImpl(ArrayDeclStmtASTNode const* node);
+  static llvm::Optional<std::string>
+  toStringImpl(GlobalConstantArrayDeclASTNode const* node);
+  static llvm::Optional<std::string>
+  toStringImpl(ImportDeclASTNode const* node);
 
 public:
   /// Returns the type name of the given ASTNode.
   static llvm::StringRef toTypeString(ASTNode const* node);
+  /// Returns the type name of ASTNodes of the given kind.
+  static llvm::StringRef toTypeString(ASTKind kind);
 
   /// Returns the most relevant information about the given ASTNode
   /// if there is any.
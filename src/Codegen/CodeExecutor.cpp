@@ -27,6 +27,7 @@
 #include "llvm/ExecutionEngine/RTDyldMemoryManager.h"
 #include "llvm/ExecutionEngine/RuntimeDyld.h"
 #include "llvm/IR/DataLayout.h"
+#include "llvm/IR/GlobalVariable.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Transforms/Utils/Cloning.h"
 
@@ -126,6 +127,29 @@ public:
         });
   }
 
+  /// Introduces a constant array on the base of the given array decl
+  void introduce(ArrayDeclStmtASTNode const* node,
+                 llvm::ArrayRef<std::int32_t> elements) {
+    // Print the exported values
+    if (shouldPrintVerboseMsg(compilationUnit_,
+                              VerboseFlag::InstantiatedExports)) {
+      llvm::SmallVector<std::string, 16> values;
+      for (auto element : elements) {
+        values.push_back(std::to_string(element));
+      }
+      compilationUnit_->getDiagnosticEngine()->diagnose(
+          Diagnostic::NoteInstantiationExportedArray, node->getName(),
+          stringifyInstantiation(inst_), node->getName(),
+          llvm::join(values.begin(), values.end(), ", "));
+    }
+
+    // The array is usable in function and top level scopes,
+    // the elements are copied since those are owned by the JIT.
+    auto name = relocator_.relocate(node->getName());
+    writer_.write(context_->allocate<GlobalConstantArrayDeclASTNode>(
+        name, context_->allocateCopy(elements)));
+  }
+
   /// Reduce the current production
   void reduce() { writer_.markReduce(); }
 };
@@ -182,6 +206,11 @@ cloneFunctionIntoModule(llvm::Function* function, llvm::Module* target,
 
   llvm::CloneFunctionInto(cloned, function, mapping, true, returnMapper, "",
                           nullptr, nullptr, materializer);
+
+  // The function is executed on the host, so the cpu and features of the
+  // compilation target don't apply and are left to the host executor.
+  cloned->removeFnAttr("target-cpu");
+  cloned->removeFnAttr("target-features");
   return cloned;
 }
 
@@ -215,7 +244,10 @@ llvm::Optional<CodeExecutor> CodeExecutor::createFor(IRContext* context) {
   std::unique_ptr<llvm::ExecutionEngine> engine(builder.create());
 
   if (!engine) {
-    llvm::outs() << errStr << "\n";
+    auto compilerInstance =
+        codeExecutor.getCompilationUnit()->getCompilerInstance();
+    auto lock = compilerInstance->lockOutput();
+    compilerInstance->getOutputStream() << errStr << "\n";
     return llvm::None;
   }
 
@@ -304,8 +336,11 @@ CodeExecutor::instantiate(MetaInstantiationExprASTNode const* inst,
       inst->getDecl()->getDecl()->getDeclaringNode());
 
   if (shouldPrintVerboseMsg(this, VerboseFlag::Instantiations)) {
-    llvm::errs() << "instantiating " << stringifyInstantiation(inst) << "...\n";
-    llvm::errs().flush();
+    auto compilerInstance = getCompilationUnit()->getCompilerInstance();
+    auto lock = compilerInstance->lockOutput();
+    auto& out = compilerInstance->getErrorStream();
+    out << "instantiating " << stringifyInstantiation(inst) << "...\n";
+    out.flush();
 
     /*getCompilationUnit()->getDiagnosticEngine()->diagnose(
         Diagnostic::NoteInstantiatingMetaDecl, inst->getSourceRange(),
@@ -347,7 +382,9 @@ CodeExecutor::instantiate(MetaInstantiationExprASTNode const* inst,
   auto layout = std::move(writer).buildLayout();
 
   if (shouldPrintVerboseMsg(this, VerboseFlag::InstantiatedLayout)) {
-    dumpLayout(llvm::errs(), layout);
+    auto compilerInstance = getCompilationUnit()->getCompilerInstance();
+    auto lock = compilerInstance->lockOutput();
+    dumpLayout(compilerInstance->getErrorStream(), layout);
   }
 
   ASTLayoutReader reader(getCompilationUnit(), getASTContext(), layout);
@@ -366,7 +403,9 @@ CodeExecutor::instantiate(MetaInstantiationExprASTNode const* inst,
   }
 
   if (shouldPrintVerboseMsg(this, VerboseFlag::InstantiatedAST)) {
-    dumpAST(llvm::errs(), unit);
+    auto compilerInstance = getCompilationUnit()->getCompilerInstance();
+    auto lock = compilerInstance->lockOutput();
+    dumpAST(compilerInstance->getErrorStream(), unit);
   }
 
   // Finally cache the instantiation for further usage
@@ -398,12 +437,15 @@ bool CodeExecutor::shipToJIT() {
   }
 
   if (shouldPrintVerboseMsg(this, VerboseFlag::Shipments)) {
-    // llvm::errs() << "\n\n";
-    // llvm::errs() << "=============== Shipping: ================\n";
-    shipment()->dump();
-    // llvm::errs() << "==========================================\n\n";
-    llvm::errs() << "\n\n";
-    llvm::errs().flush();
+    auto compilerInstance = getCompilationUnit()->getCompilerInstance();
+    auto lock = compilerInstance->lockOutput();
+    auto& out = compilerInstance->getErrorStream();
+    // out << "\n\n";
+    // out << "=============== Shipping: ================\n";
+    shipment()->print(out, nullptr);
+    // out << "==========================================\n\n";
+    out << "\n\n";
+    out.flush();
   }
 
   // Finally pass the shipment to the executor
@@ -524,6 +566,12 @@ llvm::Function* CodeExecutor::pull(llvm::Function* function) {
           return cloneFunctionPrototype(function);
         }
 
+        // Globals like the resolved versions of multiversioned functions
+        // are replicated into the shipment.
+        if (auto global = llvm::dyn_cast<llvm::GlobalVariable>(value)) {
+          return cloneGlobalVariable(global);
+        }
+
         // The llvm::Mapper will do his best to resolve this
         return nullptr;
       });
@@ -536,6 +584,25 @@ llvm::Constant* CodeExecutor::cloneFunctionPrototype(llvm::Function* function) {
                                          function->getFunctionType());
 }
 
+llvm::Constant*
+CodeExecutor::cloneGlobalVariable(llvm::GlobalVariable* global) {
+  if (auto existing = shipment()->getNamedGlobal(global->getName())) {
+    return existing;
+  }
+
+  // External globals are resolved through the symbols of the process
+  if (global->isDeclaration()) {
+    return shipment()->getOrInsertGlobal(global->getName(),
+                                         global->getValueType());
+  }
+
+  auto cloned = new llvm::GlobalVariable(
+      *shipment(), global->getValueType(), global->isConstant(),
+      global->getLinkage(), global->getInitializer(), global->getName());
+  cloned->copyAttributesFrom(global);
+  return cloned;
+}
+
 Nullable<MetaUnitASTNode const*> CodeExecutor::getCachedInstantiationOf(
     MetaInstantiationExprASTNode const* inst) {
   auto previous = instantiations_.find(inst);
@@ -593,7 +660,15 @@ void CodeExecutor::reduceNodeCallback(void* context) {
 void CodeExecutor::introduceNodeCallback(void* context, void* node, void* value,
                                          unsigned depth) {
   auto contributor = static_cast<NodeContributor*>(context);
+  auto decl = static_cast<ASTNode*>(node);
+  if (auto array = llvm::dyn_cast<ArrayDeclStmtASTNode>(decl)) {
+    // Arrays are passed as pointer to their first element
+    llvm::ArrayRef<std::int32_t> elements(static_cast<std::int32_t*>(value),
+                                          *array->getSize());
+    contributor->introduce(array, elements);
+    return;
+  }
   auto intValue = *static_cast<int*>(value);
   ASTCursor cursor(static_cast<DepthLevel>(depth));
-  contributor->introduce(static_cast<ASTNode*>(node), intValue, cursor);
+  contributor->introduce(decl, intValue, cursor);
 }
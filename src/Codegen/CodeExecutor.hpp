@@ -31,6 +31,7 @@
 
 namespace llvm {
 class Function;
+class GlobalVariable;
 class Module;
 }
 
@@ -127,6 +128,8 @@ private:
 
   /// Clones the function prototype into the current shipment
   llvm::Constant* cloneFunctionPrototype(llvm::Function* function);
+  /// Clones the global variable into the current shipment
+  llvm::Constant* cloneGlobalVariable(llvm::GlobalVariable* global);
 
   /// Returns a cached instantiation if there is any
   Nullable<MetaUnitASTNode const*>
@@ -20,7 +20,10 @@
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringExtras.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/DerivedTypes.h"
 #include "llvm/IR/Function.h"
+#include "llvm/IR/GlobalVariable.h"
 #include "llvm/IR/Type.h"
 #include "llvm/Support/raw_ostream.h"
 
@@ -80,6 +83,18 @@ llvm::Type* CodegenBase<Base>::getTypeOf(DeclStmtASTNode const* /*node*/) {
   return getTypeOfInt();
 }
 
+template <typename Base>
+llvm::ArrayType*
+CodegenBase<Base>::getTypeOf(ArrayDeclStmtASTNode const* node) {
+  return llvm::ArrayType::get(getTypeOfInt(), *node->getSize());
+}
+
+template <typename Base>
+llvm::ArrayType*
+CodegenBase<Base>::getTypeOf(GlobalConstantArrayDeclASTNode const* node) {
+  return llvm::ArrayType::get(getTypeOfInt(), node->getSize());
+}
+
 template <typename Base>
 llvm::Type*
 CodegenBase<Base>::getTypeOf(AnonymousArgumentDeclASTNode const* /*node*/) {
@@ -138,6 +153,13 @@ CodegenBase<Base>::mangleNameOf(MetaInstantiationExprASTNode const* node) {
       [=](auto& stream) { mangeling::mangleNameOf(stream, node); });
 }
 
+template <typename Base>
+std::string
+CodegenBase<Base>::mangleNameOf(GlobalConstantArrayDeclASTNode const* node) {
+  return setupStream(
+      [=](auto& stream) { mangeling::mangleNameOf(stream, node); });
+}
+
 template <typename Base>
 llvm::Constant*
 CodegenBase<Base>::createFunctionPrototype(llvm::Function* function) {
@@ -173,6 +195,37 @@ llvm::Function* CodegenBase<Base>::createFunction(llvm::Module* module,
                                 module);
 }
 
+template <typename Base>
+llvm::GlobalVariable* CodegenBase<Base>::createConstantArray(
+    GlobalConstantArrayDeclASTNode const* node) {
+  llvm::SmallVector<llvm::Constant*, 16> elements;
+  for (auto element : node->getElements()) {
+    elements.push_back(llvm::ConstantInt::getSigned(getTypeOfInt(), element));
+  }
+  auto initializer = llvm::ConstantArray::get(getTypeOf(node), elements);
+
+  // Arrays exported by different instantiations can share their name,
+  // those are distinguished through an index in the order they are
+  // emitted. Constants are uniqued by LLVM, so arrays with equal
+  // elements are found through their initializer and are shared.
+  auto const name = mangleNameOf(node);
+  for (std::size_t index = 0;; ++index) {
+    auto const indexed = index ? fmt::format("{}{}", name, index) : name;
+    if (auto global = module()->getNamedGlobal(indexed)) {
+      if (global->getInitializer() == initializer) {
+        return global;
+      }
+      continue;
+    }
+
+    auto global = new llvm::GlobalVariable(
+        *module(), initializer->getType(), true,
+        llvm::GlobalValue::PrivateLinkage, initializer, indexed);
+    global->setUnnamedAddr(llvm::GlobalValue::UnnamedAddr::Global);
+    return global;
+  }
+}
+
 template <typename Base> llvm::Type* CodegenBase<Base>::getTypeOfContextPtr() {
   auto structure = llvm::StructType::get(context(), {});
   return llvm::PointerType::getUnqual(structure);
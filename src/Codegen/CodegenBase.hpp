@@ -25,10 +25,12 @@
 namespace llvm {
 class LLVMContext;
 class Type;
+class ArrayType;
 class FunctionType;
 class Function;
 class Module;
 class Constant;
+class GlobalVariable;
 }
 
 class CompilationUnit;
@@ -38,6 +40,8 @@ class MetaDeclASTNode;
 class IntegerLiteralExprASTNode;
 class BooleanLiteralExprASTNode;
 class DeclStmtASTNode;
+class ArrayDeclStmtASTNode;
+class GlobalConstantArrayDeclASTNode;
 class AnonymousArgumentDeclASTNode;
 class MetaInstantiationExprASTNode;
 
@@ -53,6 +57,10 @@ public:
   llvm::Type* getTypeOf(BooleanLiteralExprASTNode const* node);
   /// Returns the type of a DeclStmtASTNode
   llvm::Type* getTypeOf(DeclStmtASTNode const* node);
+  /// Returns the type of an ArrayDeclStmtASTNode
+  llvm::ArrayType* getTypeOf(ArrayDeclStmtASTNode const* node);
+  /// Returns the type of a GlobalConstantArrayDeclASTNode
+  llvm::ArrayType* getTypeOf(GlobalConstantArrayDeclASTNode const* node);
   /// Returns the llvm type of the given AnonymousArgumentDeclASTNode
   llvm::Type* getTypeOf(AnonymousArgumentDeclASTNode const* node);
 
@@ -75,6 +83,8 @@ public:
   static std::string mangleNameOf(MetaDeclASTNode const* node);
   /// Returns the mangled name of the given global node
   static std::string mangleNameOf(MetaInstantiationExprASTNode const* node);
+  /// Returns the mangled name of the given global node
+  static std::string mangleNameOf(GlobalConstantArrayDeclASTNode const* node);
 
   /// Returns a forward declaration to the given function
   llvm::Constant* createFunctionPrototype(llvm::Function* function);
@@ -92,6 +102,12 @@ public:
                                         llvm::StringRef name,
                                         llvm::FunctionType* type);
 
+  /// Returns the private constant which holds the elements of the given
+  /// array, the constant is created when no constant with the same name
+  /// and elements is present in the module.
+  llvm::GlobalVariable*
+  createConstantArray(GlobalConstantArrayDeclASTNode const* node);
+
   /// Returns the type of the (first) context argument in meta functions
   /// which usually references to the ASTLayoutWriter object.
   llvm::Type* getTypeOfContextPtr();
@@ -18,16 +18,23 @@
 #include "CodegenInstance.hpp"
 
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringSwitch.h"
+#include "llvm/ADT/Triple.h"
 #include "llvm/Bitcode/ReaderWriter.h"
+#include "llvm/IR/DataLayout.h"
 #include "llvm/IR/Function.h"
+#include "llvm/IR/GlobalVariable.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Type.h"
 #include "llvm/IR/Value.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetMachine.h"
 #include "llvm/Transforms/IPO/PassManagerBuilder.h"
+#include "llvm/Transforms/Utils/Cloning.h"
 
 #include "AST.hpp"
 #include "ASTContext.hpp"
@@ -37,6 +44,7 @@
 #include "CompilerInvocation.hpp"
 #include "DependencyAnalysis.hpp"
 #include "FunctionCodegen.hpp"
+#include "FunctionHash.hpp"
 #include "MetaCodegen.hpp"
 
 static std::unique_ptr<llvm::Module>
@@ -79,6 +87,26 @@ createFunctionPassManager(llvm::Module* module,
   return manager;
 }
 
+static std::unique_ptr<IRCache>
+createIRCache(CompilationUnit const* compilationUnit) {
+  auto compilerInstance = compilationUnit->getCompilerInstance();
+  auto invocation = compilerInstance->getInvocation();
+  auto directory = invocation->getCacheDirectory();
+  if (directory.empty()) {
+    return nullptr;
+  }
+
+  // Functions generated for a different target or optimization level
+  // are never reused.
+  auto machine = compilerInstance->getTargetMachine();
+  auto configuration = fmt::format(
+      "{}:{}:{}:{}", unsigned(invocation->getOptLevel()),
+      machine->getTargetTriple().getTriple(), machine->getTargetCPU(),
+      machine->getTargetFeatureString());
+  return std::make_unique<IRCache>(std::move(directory),
+                                   std::move(configuration));
+}
+
 CodegenInstance::CodegenInstance(CompilationUnit* compilationUnit,
                                  ASTContext* astContext)
     : compilationUnit_(compilationUnit), astContext_(astContext),
@@ -86,7 +114,8 @@ CodegenInstance::CodegenInstance(CompilationUnit* compilationUnit,
       amalgamation_(createModule(*llvmContext_, compilationUnit)),
       passManager_(createFunctionPassManager(
           amalgamation_.get(),
-          compilationUnit->getCompilerInstance()->getInvocation())) {}
+          compilationUnit->getCompilerInstance()->getInvocation())),
+      irCache_(createIRCache(compilationUnit)) {}
 
 CodegenInstance::~CodegenInstance() {
   /// Reset the code executor first
@@ -118,7 +147,14 @@ llvm::LLVMContext& CodegenInstance::getLLVMContext() {
 
 llvm::Module* CodegenInstance::getModule() { return amalgamation_.get(); }
 
-void CodegenInstance::dump() { getModule()->print(llvm::outs(), nullptr); }
+std::unique_ptr<llvm::MemoryBuffer> CodegenInstance::emitBitcode() {
+  llvm::SmallVector<char, 0> buffer;
+  llvm::raw_svector_ostream out(buffer);
+  llvm::WriteBitcodeToFile(getModule(), out);
+  return llvm::MemoryBuffer::getMemBufferCopy(
+      llvm::StringRef(buffer.data(), buffer.size()),
+      getModule()->getModuleIdentifier());
+}
 
 llvm::Constant*
 CodegenInstance::lookupGlobal(FunctionDeclASTNode const* function) {
@@ -226,6 +262,12 @@ CodegenInstance::codegen(FunctionDeclASTNode const* node) {
   if (llvm::isa<MetaUnitASTNode>(node->getContainingUnit())) {
     // For intermediate produces results set the linkage to private
     function->setLinkage(llvm::GlobalValue::PrivateLinkage);
+  } else if (auto unit = llvm::dyn_cast<CompilationUnitASTNode>(
+                 node->getContainingUnit())) {
+    // Imported functions are generated in every importing unit
+    if (unit->isImported()) {
+      function->setLinkage(llvm::GlobalValue::LinkOnceODRLinkage);
+    }
   }
 
   // Set the argument names of the function
@@ -245,7 +287,7 @@ CodegenInstance::codegen(FunctionDeclASTNode const* node) {
     for (auto& arg : range) {
       auto current = *itr;
       if (auto named = llvm::dyn_cast<NamedArgumentDeclASTNode>(current)) {
-        arg.setName(*named->getName());
+        arg.setName(named->getName()->getString());
       }
       ++itr;
     }
@@ -253,11 +295,36 @@ CodegenInstance::codegen(FunctionDeclASTNode const* node) {
 
   auto generation = enterGeneration(node);
 
+  setTargetAttributesOf(function);
+  setHintAttributesOf(node, function);
+
+  // Reuse the optimized function from the cache when neither the function
+  // nor the signatures of the declarations it references changed.
+  llvm::Optional<std::string> hash;
+  llvm::SmallVector<FunctionDeclASTNode const*, 8> references;
+  if (isCacheable(node)) {
+    hash = hashFunction(node, irCache_->getSalt(), references);
+  }
+  if (hash && irCache_->load(*hash, function)) {
+    // The referenced functions are generated as dependencies
+    for (auto reference : references) {
+      lookupGlobal(reference);
+    }
+    return function;
+  }
+
   FunctionCodegen functionCodegen(this, function);
   functionCodegen.codegen(node);
 
+  if (node->hasTargetClones()) {
+    codegenTargetClones(node, function);
+  }
+
   optimizeFunction(function);
 
+  if (hash) {
+    irCache_->store(*hash, function);
+  }
   return function;
 }
 
@@ -297,7 +364,242 @@ CodegenInstance::instantiate(MetaInstantiationExprASTNode const* inst,
       });
 }
 
+void CodegenInstance::setTargetAttributesOf(llvm::Function* function) {
+  auto machine =
+      getCompilationUnit()->getCompilerInstance()->getTargetMachine();
+
+  function->addFnAttr("target-cpu", machine->getTargetCPU());
+  if (!machine->getTargetFeatureString().empty()) {
+    function->addFnAttr("target-features", machine->getTargetFeatureString());
+  }
+}
+
+void CodegenInstance::setHintAttributesOf(FunctionDeclASTNode const* node,
+                                          llvm::Function* function) {
+  auto const& attributes = node->getAttributes();
+
+  switch (attributes.inlining) {
+    case FunctionInlining::Always:
+      function->addFnAttr(llvm::Attribute::AlwaysInline);
+      break;
+    case FunctionInlining::Never:
+      function->addFnAttr(llvm::Attribute::NoInline);
+      break;
+    default:
+      break;
+  }
+
+  // LLVM provides no dedicated hot attribute yet, thus we hint the inliner
+  // to prefer hot functions and optimize cold ones for size.
+  switch (attributes.frequency) {
+    case FunctionFrequency::Hot:
+      if (attributes.inlining != FunctionInlining::Never) {
+        function->addFnAttr(llvm::Attribute::InlineHint);
+      }
+      break;
+    case FunctionFrequency::Cold:
+      function->addFnAttr(llvm::Attribute::Cold);
+      function->addFnAttr(llvm::Attribute::OptimizeForSize);
+      break;
+    default:
+      break;
+  }
+}
+
+/// Returns the bit of the feature inside the `__cpu_model` features which
+/// are exported by compiler-rt and libgcc for `__builtin_cpu_supports`.
+static llvm::Optional<unsigned> getX86FeatureBitOf(llvm::StringRef feature) {
+  return llvm::StringSwitch<llvm::Optional<unsigned>>(feature)
+      .Case("cmov", 0U)
+      .Case("mmx", 1U)
+      .Case("popcnt", 2U)
+      .Case("sse", 3U)
+      .Case("sse2", 4U)
+      .Case("sse3", 5U)
+      .Case("ssse3", 6U)
+      .Case("sse4.1", 7U)
+      .Case("sse4.2", 8U)
+      .Case("avx", 9U)
+      .Case("avx2", 10U)
+      .Case("sse4a", 11U)
+      .Case("fma4", 12U)
+      .Case("xop", 13U)
+      .Case("fma", 14U)
+      .Case("avx512f", 15U)
+      .Case("bmi", 16U)
+      .Case("bmi2", 17U)
+      .Case("aes", 18U)
+      .Case("pclmul", 19U)
+      .Case("avx512vl", 20U)
+      .Case("avx512bw", 21U)
+      .Case("avx512dq", 22U)
+      .Case("avx512cd", 23U)
+      .Case("avx512er", 24U)
+      .Case("avx512pf", 25U)
+      .Case("avx512vbmi", 26U)
+      .Case("avx512ifma", 27U)
+      .Default(llvm::None);
+}
+
+void CodegenInstance::codegenTargetClones(FunctionDeclASTNode const* node,
+                                          llvm::Function* function) {
+  auto diagnosticEngine = getCompilationUnit()->getDiagnosticEngine();
+  auto machine =
+      getCompilationUnit()->getCompilerInstance()->getTargetMachine();
+  auto const& triple = machine->getTargetTriple();
+
+  // The resolver depends on the x86 cpu model of compiler-rt or libgcc
+  if ((triple.getArch() != llvm::Triple::x86) &&
+      (triple.getArch() != llvm::Triple::x86_64)) {
+    diagnosticEngine->diagnose(Diagnostic::WarningTargetClonesUnsupported,
+                               node->getName(), triple.getTriple(),
+                               node->getName());
+    return;
+  }
+
+  llvm::SmallVector<std::pair<llvm::StringRef, unsigned>, 4> targets;
+  for (auto const& target : node->getAttributes().targetClones) {
+    if (*target == "default") {
+      continue;
+    }
+    if (auto bit = getX86FeatureBitOf(*target)) {
+      targets.push_back(std::make_pair(*target, *bit));
+    } else {
+      diagnosticEngine->diagnose(Diagnostic::ErrorTargetClonesUnknownFeature,
+                                 target, target);
+    }
+  }
+
+  if (!canContinue()) {
+    return;
+  }
+
+  auto createVersion = [&](llvm::StringRef target, bool isDefault) {
+    llvm::ValueToValueMapTy mapping;
+    auto version = llvm::CloneFunction(function, mapping);
+    version->setName(fmt::format("{}.{}", function->getName(), target));
+    version->setLinkage(llvm::GlobalValue::InternalLinkage);
+
+    if (!isDefault) {
+      std::string features =
+          version->getFnAttribute("target-features").getValueAsString();
+      if (!features.empty()) {
+        features += ',';
+      }
+      features += '+';
+      features += target;
+      version->addFnAttr("target-features", features);
+    }
+
+    optimizeFunction(version);
+    return version;
+  };
+
+  auto defaultVersion = createVersion("default", true);
+  llvm::SmallVector<std::pair<llvm::Function*, unsigned>, 4> versions;
+  for (auto const& target : targets) {
+    versions.push_back(
+        std::make_pair(createVersion(target.first, false), target.second));
+  }
+
+  auto& context = getLLVMContext();
+  auto pointerType = function->getType();
+
+  // Create the resolver which selects the version for the current cpu,
+  // targets which were specified first take precedence over later ones.
+  auto resolver =
+      createFunction(fmt::format("{}.resolver", function->getName()),
+                     llvm::FunctionType::get(pointerType, false));
+  resolver->setLinkage(llvm::GlobalValue::InternalLinkage);
+  {
+    llvm::IRBuilder<> builder(
+        llvm::BasicBlock::Create(context, "entry", resolver));
+
+    auto int32Type = builder.getInt32Ty();
+    auto modelType = llvm::StructType::get(
+        context,
+        {int32Type, int32Type, int32Type, llvm::ArrayType::get(int32Type, 1)});
+
+    auto initializer = getModule()->getOrInsertFunction(
+        "__cpu_indicator_init",
+        llvm::FunctionType::get(getTypeOfVoid(), false));
+    builder.CreateCall(initializer);
+
+    auto model = getModule()->getOrInsertGlobal("__cpu_model", modelType);
+    auto featuresPtr = builder.CreateInBoundsGEP(
+        modelType, model,
+        {builder.getInt32(0), builder.getInt32(3), builder.getInt32(0)});
+    auto features = builder.CreateLoad(featuresPtr, "cpu_features");
+
+    llvm::Value* selected = defaultVersion;
+    for (auto itr = versions.rbegin(); itr != versions.rend(); ++itr) {
+      auto mask = builder.getInt32(1U << itr->second);
+      auto masked = builder.CreateAnd(features, mask);
+      auto supported = builder.CreateIsNotNull(masked, "cpu_supports");
+      selected = builder.CreateSelect(supported, itr->first, selected);
+    }
+    builder.CreateRet(selected);
+  }
+
+  // Turn the function into a dispatcher which resolves the version
+  // once and caches it afterwards, as an ifunc would do.
+  auto linkage = function->getLinkage();
+  function->deleteBody();
+  function->setLinkage(linkage);
+
+  auto cache = new llvm::GlobalVariable(
+      *getModule(), pointerType, false, llvm::GlobalValue::InternalLinkage,
+      llvm::ConstantPointerNull::get(pointerType),
+      fmt::format("{}.resolved", function->getName()));
+  // The cache is accessed atomically, since dispatchers could be called
+  // concurrently. Relaxed accesses are sufficient because every thread
+  // resolves the same version.
+  auto const alignment = getModule()->getDataLayout().getPointerABIAlignment();
+  cache->setAlignment(alignment);
+
+  auto entryBlock = llvm::BasicBlock::Create(context, "entry", function);
+  auto resolveBlock = llvm::BasicBlock::Create(context, "resolve", function);
+  auto dispatchBlock = llvm::BasicBlock::Create(context, "dispatch", function);
+
+  llvm::IRBuilder<> builder(entryBlock);
+  auto cached = builder.CreateAlignedLoad(cache, alignment, "cached");
+  cached->setAtomic(llvm::AtomicOrdering::Monotonic);
+  builder.CreateCondBr(builder.CreateIsNull(cached), resolveBlock,
+                       dispatchBlock);
+
+  builder.SetInsertPoint(resolveBlock);
+  auto resolved = builder.CreateCall(resolver, {}, "resolved");
+  builder.CreateAlignedStore(resolved, cache, alignment)
+      ->setAtomic(llvm::AtomicOrdering::Monotonic);
+  builder.CreateBr(dispatchBlock);
+
+  builder.SetInsertPoint(dispatchBlock);
+  auto callee = builder.CreatePHI(pointerType, 2, "callee");
+  callee->addIncoming(cached, entryBlock);
+  callee->addIncoming(resolved, resolveBlock);
+
+  llvm::SmallVector<llvm::Value*, 5> args;
+  for (auto& arg : function->args()) {
+    args.push_back(&arg);
+  }
+  auto call = builder.CreateCall(callee, args);
+  call->setTailCall();
+
+  if (function->getReturnType()->isVoidTy()) {
+    builder.CreateRetVoid();
+  } else {
+    builder.CreateRet(call);
+  }
+}
+
 void CodegenInstance::optimizeFunction(llvm::Function* function) {
   // Just run the pass manager on the function
   passManager_->run(*function);
 }
+
+bool CodegenInstance::isCacheable(FunctionDeclASTNode const* node) const {
+  // Functions of meta units and multiversioned functions depend
+  // on globals which are only valid inside the current translation.
+  return irCache_ && !node->hasTargetClones() &&
+         llvm::isa<CompilationUnitASTNode>(node->getContainingUnit());
+}
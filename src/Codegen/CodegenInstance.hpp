@@ -27,11 +27,13 @@
 
 #include "CodeExecutor.hpp"
 #include "CodegenBase.hpp"
+#include "IRCache.hpp"
 #include "IRContext.hpp"
 #include "Nullable.hpp"
 #include "ScopeLeaveAction.hpp"
 
 namespace llvm {
+class MemoryBuffer;
 class Module;
 class LLVMContext;
 class Function;
@@ -63,6 +65,10 @@ class CodegenInstance : public IRContext, public CodegenBase<CodegenInstance> {
 
   std::unique_ptr<llvm::legacy::FunctionPassManager> passManager_;
 
+  /// Caches the generated functions across translations, which is null
+  /// when no cache directory was specified.
+  std::unique_ptr<IRCache> irCache_;
+
   /// Contains the dependencies which still must be generated
   std::unordered_set<ASTNode const*> dependencies_;
 
@@ -100,8 +106,9 @@ public:
   /// Generates the IR for the given CompilationUnitASTNode
   bool codegen(CompilationUnitASTNode const* compilationUnitASTNode);
 
-  /// Dumps the module to stdout
-  void dump();
+  /// Returns the module written as bitcode, so it can be read
+  /// into a different LLVMContext.
+  std::unique_ptr<llvm::MemoryBuffer> emitBitcode();
 
 private:
   /// Mark an ASTNode as currently generated to detect strong cycles
@@ -120,9 +127,27 @@ private:
   Nullable<ASTNode const*> instantiate(MetaInstantiationExprASTNode const* inst,
                                        bool requiresCompleted = false);
 
+  /// Annotates the function with the cpu and features of the target machine
+  void setTargetAttributesOf(llvm::Function* function);
+
+  /// Annotates the function with the inlining and frequency hints
+  /// specified through it's attributes.
+  void setHintAttributesOf(FunctionDeclASTNode const* node,
+                           llvm::Function* function);
+
+  /// Multiversions the generated function for the targets specified
+  /// through it's `@target_clones` attribute. The function itself is
+  /// turned into a dispatcher which calls the version selected by
+  /// an ifunc-style resolver.
+  void codegenTargetClones(FunctionDeclASTNode const* node,
+                           llvm::Function* function);
+
   /// Runs optimization passes on the function depending
   /// on the configured optimization level.
   void optimizeFunction(llvm::Function* function);
+
+  /// Returns true when the given function can be stored in the IRCache
+  bool isCacheable(FunctionDeclASTNode const* node) const;
 };
 
 #endif // #ifndef CODEGEN_INSTANCE_HPP_INCLUDED__
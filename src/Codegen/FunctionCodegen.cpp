@@ -21,8 +21,11 @@
 #include "llvm/ExecutionEngine/Orc/LambdaResolver.h"
 #include "llvm/ExecutionEngine/RTDyldMemoryManager.h"
 #include "llvm/ExecutionEngine/RuntimeDyld.h"
+#include "llvm/IR/DerivedTypes.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/Intrinsics.h"
+#include "llvm/IR/MDBuilder.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Type.h"
 #include "llvm/IR/Value.h"
@@ -186,23 +189,48 @@ FunctionCodegen::codegenStmt(llvm::BasicBlock* /*block*/,
 }
 
 Nullable<llvm::BasicBlock*>
-FunctionCodegen::codegenStmt(llvm::BasicBlock* block,
+FunctionCodegen::codegenStmt(llvm::BasicBlock* /*block*/,
                              ExpressionStmtASTNode const* stmt) {
   (void)codegenExpr(stmt->getExpression());
-  return block;
+  // The expression could have split the block through a bounds check
+  return builder_.GetInsertBlock();
 }
 
 Nullable<llvm::BasicBlock*>
-FunctionCodegen::codegenStmt(llvm::BasicBlock* block,
+FunctionCodegen::codegenStmt(llvm::BasicBlock* /*block*/,
                              DeclStmtASTNode const* stmt) {
   auto expr = codegenExpr(stmt->getExpression());
-  auto allocaInst =
-      builder_.CreateAlloca(getTypeOf(stmt), nullptr, *stmt->getName());
+  auto allocaInst = builder_.CreateAlloca(getTypeOf(stmt), nullptr,
+                                          stmt->getName()->getString());
   builder_.CreateStore(loadMemory(expr), allocaInst);
+  introduce(stmt, allocaInst);
+  return builder_.GetInsertBlock();
+}
+
+Nullable<llvm::BasicBlock*>
+FunctionCodegen::codegenStmt(llvm::BasicBlock* block,
+                             ArrayDeclStmtASTNode const* stmt) {
+  auto type = getTypeOf(stmt);
+  auto allocaInst =
+      builder_.CreateAlloca(type, nullptr, stmt->getName()->getString());
+
+  // Zero initialize the elements of the array
+  auto const& layout = getModule()->getDataLayout();
+  builder_.CreateMemSet(allocaInst, builder_.getInt8(0),
+                        layout.getTypeAllocSize(type),
+                        layout.getABITypeAlignment(type));
+
   introduce(stmt, allocaInst);
   return block;
 }
 
+Nullable<llvm::BasicBlock*>
+FunctionCodegen::codegenStmt(llvm::BasicBlock* block,
+                             GlobalConstantArrayDeclASTNode const* /*stmt*/) {
+  // The constant is emitted into the module when it's referenced
+  return block;
+}
+
 Nullable<llvm::BasicBlock*>
 FunctionCodegen::codegenStmt(llvm::BasicBlock* /*block*/,
                              MetaIfStmtASTNode const* /*stmt*/) {
@@ -227,9 +255,81 @@ FunctionCodegen::codegenStmt(llvm::BasicBlock* block,
       return codegenStmt(current, *stmt->getFalseBranch());
     };
     return codegenIfStructure(block, stmt->getExpression(), codegenTrue,
-                              CodegenSupplier(codegenFalse));
+                              CodegenSupplier(codegenFalse),
+                              stmt->getLikelihood());
   } else {
-    return codegenIfStructure(block, stmt->getExpression(), codegenTrue);
+    return codegenIfStructure(block, stmt->getExpression(), codegenTrue,
+                              llvm::None, stmt->getLikelihood());
+  }
+}
+
+Nullable<llvm::BasicBlock*>
+FunctionCodegen::codegenStmt(llvm::BasicBlock* block,
+                             MatchStmtASTNode const* stmt) {
+  auto condition = loadMemory(codegenExpr(stmt->getExpression()));
+  auto conditionType = llvm::cast<llvm::IntegerType>(condition->getType());
+  // The condition could have split the block through a bounds check
+  block = builder_.GetInsertBlock();
+
+  // Never create the continue block when all arms terminate
+  // the control flow, so we create it lazily.
+  Nullable<llvm::BasicBlock*> continueBlock;
+  auto lazyGetContinueBlock = [&] {
+    if (!continueBlock) {
+      continueBlock = createBlock("continue_block");
+    }
+    return *continueBlock;
+  };
+
+  Nullable<llvm::BasicBlock*> defaultBlock;
+  llvm::SmallVector<std::pair<llvm::ConstantInt*, llvm::BasicBlock*>, 8> cases;
+
+  for (auto child : stmt->getArms()) {
+    auto arm = llvm::cast<MatchArmASTNode>(child);
+
+    auto armBlock = [&] {
+      // Insert the block before the continue block if any exists
+      auto const constexpr name = "match_arm_block";
+      if (continueBlock)
+        return createBlockBefore(*continueBlock, name);
+      else
+        return createBlock(name);
+    }();
+
+    builder_.SetInsertPoint(armBlock);
+    if (codegenStmt(armBlock, arm->getBody())) {
+      builder_.CreateBr(lazyGetContinueBlock());
+    }
+
+    if (arm->isWildcard()) {
+      defaultBlock = armBlock;
+    } else {
+      auto value = arm->getPatternValue();
+      assert(value && "Expected the pattern to be checked in sema!");
+      assert(llvm::ConstantInt::isValueValidForType(conditionType, *value) &&
+             "Expected the pattern type to be checked in sema!");
+      cases.emplace_back(llvm::ConstantInt::getSigned(conditionType, *value),
+                         armBlock);
+    }
+  }
+
+  // Create the switch instruction, arms which aren't matched are
+  // continuing after the statement when there is no wildcard arm.
+  builder_.SetInsertPoint(block);
+  auto switchInst = builder_.CreateSwitch(
+      condition, defaultBlock ? *defaultBlock : lazyGetContinueBlock(),
+      cases.size());
+  for (auto const& matchCase : cases) {
+    switchInst->addCase(matchCase.first, matchCase.second);
+  }
+
+  if (continueBlock) {
+    // Finally update the current block to the continue one
+    builder_.SetInsertPoint(*continueBlock);
+    return *continueBlock;
+  } else {
+    // Or when no one exists return the statement as terminated
+    return nullptr;
   }
 }
 
@@ -246,7 +346,12 @@ llvm::Value* FunctionCodegen::codegenExpr(DeclRefExprASTNode const* expr) {
     // Lookup the function inside the IRContext
     auto declaring = expr->getDecl()->getDeclaringNode();
     return lookupGlobal(llvm::cast<FunctionDeclASTNode>(declaring));
-  } else if (expr->getDecl()->isVarDecl()) {
+  } else if (expr->getDecl()->isGlobalConstantArray()) {
+    // Lookup the constant array inside the current module
+    auto constant = llvm::cast<GlobalConstantArrayDeclASTNode>(
+        expr->getDecl()->getDeclaringNode());
+    return createConstantArray(constant);
+  } else if (expr->getDecl()->isVarDecl() || expr->getDecl()->isArrayDecl()) {
     // Lookup the variable locally
     return lookupLocal(*expr->getDecl());
   } else if (expr->getDecl()->isGlobalConstant()) {
@@ -337,6 +442,33 @@ FunctionCodegen::codegenExpr(BinaryOperatorExprASTNode const* expr) {
   }
 }
 
+llvm::Value*
+FunctionCodegen::codegenExpr(ArraySubscriptExprASTNode const* expr) {
+  auto arraySize = expr->getArraySize();
+  assert(arraySize && "Expected the subscript to be checked in sema!");
+
+  auto base = codegenExpr(expr->getBaseExpr());
+  auto index = loadMemory(codegenExpr(expr->getIndexExpr()));
+  auto size = *arraySize;
+
+  // Constant indices (which includes folded expressions) that are in bounds
+  // don't require a check, out of bound constants were rejected by sema.
+  auto constant = llvm::dyn_cast<llvm::ConstantInt>(index);
+  if (!constant || (constant->getZExtValue() >= size)) {
+    // The unsigned comparison also catches negative indices
+    auto bound = llvm::ConstantInt::get(index->getType(), size);
+    auto predicate = builder_.CreateICmpULT(index, bound, "bounds_check");
+    auto inBoundsBlock = createBlock("in_bounds_block");
+    builder_.CreateCondBr(predicate, inBoundsBlock, getBoundsFailureBlock(),
+                          *getBranchWeightsOf(BranchLikelihood::Likely));
+    builder_.SetInsertPoint(inBoundsBlock);
+  }
+
+  llvm::Value* indices[] = {builder_.getInt32(0), index};
+  auto type = llvm::ArrayType::get(getTypeOfInt(), size);
+  return builder_.CreateInBoundsGEP(type, base, indices, "array_element");
+}
+
 llvm::Value* FunctionCodegen::codegenExpr(CallOperatorExprASTNode const* expr) {
   auto callee = codegenExpr(expr->getCallee());
 
@@ -353,7 +485,8 @@ llvm::Value* FunctionCodegen::codegenExpr(CallOperatorExprASTNode const* expr) {
 
 Nullable<llvm::BasicBlock*> FunctionCodegen::codegenIfStructure(
     llvm::BasicBlock* block, ExprASTNode const* condition,
-    CodegenSupplier codegenTrue, llvm::Optional<CodegenSupplier> codegenFalse) {
+    CodegenSupplier codegenTrue, llvm::Optional<CodegenSupplier> codegenFalse,
+    BranchLikelihood likelihood) {
 
   // Never create the continue block when both statements terminate
   // the control flow, so we create it lazily.
@@ -398,7 +531,8 @@ Nullable<llvm::BasicBlock*> FunctionCodegen::codegenIfStructure(
   builder_.SetInsertPoint(block);
   auto conditionResult = codegenExpr(condition);
   auto predicate = builder_.CreateIsNotNull(conditionResult, "condition_test");
-  builder_.CreateCondBr(predicate, trueBlock, falseBlock);
+  auto weights = static_cast<llvm::MDNode*>(getBranchWeightsOf(likelihood));
+  builder_.CreateCondBr(predicate, trueBlock, falseBlock, weights);
 
   if (continueBlock) {
     // Finally update the current block to the continue one
@@ -410,6 +544,34 @@ Nullable<llvm::BasicBlock*> FunctionCodegen::codegenIfStructure(
   }
 }
 
+Nullable<llvm::MDNode*>
+FunctionCodegen::getBranchWeightsOf(BranchLikelihood likelihood) {
+  llvm::MDBuilder builder(getLLVMContext());
+  switch (likelihood) {
+    case BranchLikelihood::Likely:
+      return builder.createBranchWeights(LikelyBranchWeight, 1U);
+    case BranchLikelihood::Unlikely:
+      return builder.createBranchWeights(1U, LikelyBranchWeight);
+    default:
+      return nullptr;
+  }
+}
+
+llvm::BasicBlock* FunctionCodegen::getBoundsFailureBlock() {
+  if (!boundsFailureBlock_) {
+    llvm::IRBuilderBase::InsertPointGuard guard(builder_);
+
+    boundsFailureBlock_ = createBlock("bounds_failure_block");
+    builder_.SetInsertPoint(*boundsFailureBlock_);
+
+    auto trap =
+        llvm::Intrinsic::getDeclaration(getModule(), llvm::Intrinsic::trap);
+    builder_.CreateCall(trap);
+    builder_.CreateUnreachable();
+  }
+  return *boundsFailureBlock_;
+}
+
 llvm::Value* FunctionCodegen::loadMemory(llvm::Value* value) {
   if (value->getType()->isPointerTy()) {
     return builder_.CreateLoad(value);
@@ -18,6 +18,8 @@
 #ifndef FUNCTION_CODEGEN_HPP_INCLUDED__
 #define FUNCTION_CODEGEN_HPP_INCLUDED__
 
+#include <cstdint>
+
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/STLExtras.h"
@@ -73,6 +75,13 @@ private:
   llvm::IRBuilder<> builder_;
   ValueMap values_;
 
+  /// The block all failing bounds checks of the function are branching to
+  Nullable<llvm::BasicBlock*> boundsFailureBlock_;
+
+  /// The weight of a likely taken branch relative to its unlikely
+  /// counterpart, which is used for bounds checks and annotated branches.
+  static constexpr std::uint32_t LikelyBranchWeight = 2000U;
+
 public:
   FunctionCodegen(IRContext* context, llvm::Function* function);
 
@@ -127,10 +136,19 @@ public:
 
   /// Creates the skeleton for an if structure and invokes the CodegenSupplier
   /// at the appropriate position of statement insertion.
+  /// The likelihood is attached as branch weights to the condition test.
   Nullable<llvm::BasicBlock*>
   codegenIfStructure(llvm::BasicBlock* block, ExprASTNode const* condition,
                      CodegenSupplier codegenTrue,
-                     llvm::Optional<CodegenSupplier> codegenFalse = llvm::None);
+                     llvm::Optional<CodegenSupplier> codegenFalse = llvm::None,
+                     BranchLikelihood likelihood = BranchLikelihood::Default);
+
+  /// Returns the branch weights metadata of the given likelihood
+  Nullable<llvm::MDNode*> getBranchWeightsOf(BranchLikelihood likelihood);
+
+  /// Returns the block which traps on a failing bounds check,
+  /// the block is created on first use.
+  llvm::BasicBlock* getBoundsFailureBlock();
 
   /// Loads pointer values from memory
   llvm::Value* loadMemory(llvm::Value* value);
@@ -0,0 +1,194 @@
+
+/**
+  Copyright(c) 2016 - 2017 Denis Blank <denis.blank at outlook dot com>
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+**/
+
+#include "FunctionHash.hpp"
+
+#include <cstdint>
+
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "AST.hpp"
+#include "ASTPredicate.hpp"
+#include "ASTTraversal.hpp"
+#include "NameMangeling.hpp"
+
+namespace {
+class FunctionHasher {
+  llvm::MD5 md5_;
+  llvm::SmallVectorImpl<FunctionDeclASTNode const*>& references_;
+  /// The global constants which were hashed already
+  llvm::SmallPtrSet<GlobalConstantDeclASTNode const*, 4> constants_;
+  bool isCacheable_ = true;
+
+public:
+  FunctionHasher(llvm::StringRef salt,
+                 llvm::SmallVectorImpl<FunctionDeclASTNode const*>& references)
+      : references_(references) {
+    hashString(salt);
+  }
+
+  llvm::Optional<std::string> hash(FunctionDeclASTNode const* node) {
+    hashSignature(node);
+    hashNode(node);
+    if (!isCacheable_) {
+      return llvm::None;
+    }
+
+    llvm::MD5::MD5Result result;
+    md5_.final(result);
+    llvm::SmallString<32> str;
+    llvm::MD5::stringifyResult(result, str);
+    return str.str().str();
+  }
+
+private:
+  void hashNode(ASTNode const* node) {
+    hashInteger<std::uint8_t>(std::uint8_t(node->getKind()));
+
+    traverseNode(node, [&](auto const* promoted) {
+      this->hashData(promoted);
+
+      traverseNodeIf(promoted, pred::hasChildren(), [&](auto const* parent) {
+        for (auto child : parent->children()) {
+          this->hashNode(child);
+        }
+      });
+    });
+
+    // Terminate the children, so different trees can't hash equally
+    hashInteger<std::uint8_t>(0xFF);
+  }
+
+  /// Nodes which are fully described through their kind and children
+  template <typename T> void hashData(T const* /*node*/) {}
+
+  /// Nodes which depend on the state of the current translation
+  void markUncacheable() { isCacheable_ = false; }
+  void hashData(CompilationUnitASTNode const*) { markUncacheable(); }
+  void hashData(MetaUnitASTNode const*) { markUncacheable(); }
+  void hashData(ImportDeclASTNode const*) { markUncacheable(); }
+  void hashData(MetaDeclASTNode const*) { markUncacheable(); }
+  void hashData(MetaContributionASTNode const*) { markUncacheable(); }
+  void hashData(GlobalConstantArrayDeclASTNode const*) { markUncacheable(); }
+  void hashData(MetaIfStmtASTNode const*) { markUncacheable(); }
+  void hashData(MetaCalculationStmtASTNode const*) { markUncacheable(); }
+  void hashData(ErroneousExprASTNode const*) { markUncacheable(); }
+  void hashData(MetaInstantiationExprASTNode const*) { markUncacheable(); }
+
+  void hashData(FunctionDeclASTNode const* node) {
+    auto const& attributes = node->getAttributes();
+    hashString(*node->getName());
+    hashInteger<std::uint32_t>(attributes.targetClones.size());
+    for (auto const& target : attributes.targetClones) {
+      hashString(*target);
+    }
+    hashInteger<std::uint8_t>(std::uint8_t(attributes.inlining));
+    hashInteger<std::uint8_t>(std::uint8_t(attributes.frequency));
+  }
+
+  void hashData(NamedArgumentDeclASTNode const* node) {
+    hashString(*node->getName());
+  }
+
+  void hashData(DeclStmtASTNode const* node) { hashString(*node->getName()); }
+
+  void hashData(ArrayDeclStmtASTNode const* node) {
+    hashString(*node->getName());
+    hashInteger<std::uint32_t>(*node->getSize());
+  }
+
+  void hashData(IfStmtASTNode const* node) {
+    hashInteger<std::uint8_t>(std::uint8_t(node->getLikelihood()));
+  }
+
+  void hashData(MatchArmASTNode const* node) {
+    hashInteger<std::uint8_t>(node->isWildcard());
+  }
+
+  void hashData(DeclRefExprASTNode const* node) {
+    hashString(*node->getName());
+    if (!node->isResolved()) {
+      markUncacheable();
+      return;
+    }
+
+    auto decl = node->getDecl();
+    auto declaring = decl->getDeclaringNode();
+    if (auto function = llvm::dyn_cast<FunctionDeclASTNode>(declaring)) {
+      hashInteger<std::uint8_t>(1);
+      hashSignature(function);
+      references_.push_back(function);
+    } else if (auto constant =
+                   llvm::dyn_cast<GlobalConstantDeclASTNode>(declaring)) {
+      // Constants are generated into the function
+      hashInteger<std::uint8_t>(2);
+      if (constants_.insert(constant).second) {
+        hashNode(constant->getExpression());
+      }
+    } else if (decl->isVarDecl() ||
+               llvm::isa<ArrayDeclStmtASTNode>(declaring)) {
+      // Local declarations are part of the hashed subtree
+      hashInteger<std::uint8_t>(3);
+    } else {
+      markUncacheable();
+    }
+  }
+
+  void hashData(IntegerLiteralExprASTNode const* node) {
+    hashInteger<std::uint32_t>(std::uint32_t(*node->getLiteral()));
+  }
+
+  void hashData(BooleanLiteralExprASTNode const* node) {
+    hashInteger<std::uint8_t>(std::uint8_t(*node->getLiteral()));
+  }
+
+  void hashData(BinaryOperatorExprASTNode const* node) {
+    hashInteger<std::uint8_t>(std::uint8_t(*node->getBinaryOperator()));
+  }
+
+  /// Hashes everything a call of the given function depends on
+  void hashSignature(FunctionDeclASTNode const* node) {
+    std::string name;
+    {
+      llvm::raw_string_ostream out(name);
+      mangeling::mangleNameOf(out, node);
+    }
+    hashString(name);
+    hashInteger<std::uint32_t>(node->getArgDeclList()->children().size());
+    hashInteger<std::uint8_t>(bool(node->getReturnType()));
+  }
+
+  template <typename T> void hashInteger(T value) {
+    md5_.update(llvm::ArrayRef<std::uint8_t>(
+        reinterpret_cast<std::uint8_t const*>(&value), sizeof(T)));
+  }
+
+  void hashString(llvm::StringRef str) {
+    hashInteger<std::uint32_t>(str.size());
+    md5_.update(str);
+  }
+};
+} // end anonymous namespace
+
+llvm::Optional<std::string>
+hashFunction(FunctionDeclASTNode const* node, llvm::StringRef salt,
+             llvm::SmallVectorImpl<FunctionDeclASTNode const*>& references) {
+  return FunctionHasher(salt, references).hash(node);
+}
@@ -0,0 +1,42 @@
+
+/**
+  Copyright(c) 2016 - 2017 Denis Blank <denis.blank at outlook dot com>
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+**/
+
+#ifndef FUNCTION_HASH_HPP_INCLUDED__
+#define FUNCTION_HASH_HPP_INCLUDED__
+
+#include <string>
+
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+
+class FunctionDeclASTNode;
+
+/// Returns the hash of the given function as hex string, which covers the
+/// subtree of the function and the signatures of the functions it calls.
+/// Global constants are covered through their expressions, since those are
+/// generated into the function. Source locations aren't hashed, so moving
+/// a function inside the source doesn't change its hash.
+///
+/// The referenced functions are added to the given vector.
+/// The result is empty when the function depends on meta instantiations
+/// or other declarations which are only valid inside the current translation.
+llvm::Optional<std::string>
+hashFunction(FunctionDeclASTNode const* node, llvm::StringRef salt,
+             llvm::SmallVectorImpl<FunctionDeclASTNode const*>& references);
+
+#endif // #ifndef FUNCTION_HASH_HPP_INCLUDED__
@@ -0,0 +1,166 @@
+
+/**
+  Copyright(c) 2016 - 2017 Denis Blank <denis.blank at outlook dot com>
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+**/
+
+#include "IRCache.hpp"
+
+#include <cassert>
+#include <memory>
+#include <utility>
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Bitcode/ReaderWriter.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+
+#include "Formatting.hpp"
+
+namespace {
+/// Maps the functions referenced by a cloned function
+/// to the prototypes inside the target module.
+class PrototypeMaterializer : public llvm::ValueMaterializer {
+  llvm::Module* target_;
+  bool hasUnmappedGlobals_ = false;
+
+public:
+  explicit PrototypeMaterializer(llvm::Module* target) : target_(target) {}
+  virtual ~PrototypeMaterializer() = default;
+
+  llvm::Value* materialize(llvm::Value* value) override {
+    if (auto function = llvm::dyn_cast<llvm::Function>(value)) {
+      return target_->getOrInsertFunction(function->getName(),
+                                          function->getFunctionType());
+    }
+    if (llvm::isa<llvm::GlobalValue>(value)) {
+      hasUnmappedGlobals_ = true;
+    }
+    // The llvm::Mapper will do his best to resolve this
+    return nullptr;
+  }
+
+  /// Returns true when globals were referenced which can't be mapped
+  bool hasUnmappedGlobals() const { return hasUnmappedGlobals_; }
+};
+} // end anonymous namespace
+
+/// Clones the body of the given function into the given declaration
+static bool cloneFunctionBody(llvm::Function* function,
+                              llvm::Function* declaration) {
+  assert(declaration->isDeclaration() && "The function is existing already!");
+
+  llvm::ValueToValueMapTy mapping;
+  auto itr = declaration->arg_begin();
+  for (auto const& arg : function->args()) {
+    itr->setName(arg.getName());
+    mapping[&arg] = &*itr++;
+  }
+
+  // Ignore return instructions
+  llvm::SmallVector<llvm::ReturnInst*, 5> returnMapper;
+
+  PrototypeMaterializer materializer(declaration->getParent());
+  llvm::CloneFunctionInto(declaration, function, mapping, true, returnMapper,
+                          "", nullptr, nullptr, &materializer);
+  return !materializer.hasUnmappedGlobals();
+}
+
+constexpr unsigned IRCache::Version;
+
+IRCache::IRCache(std::string directory, std::string configuration)
+    : directory_(std::move(directory)),
+      salt_(fmt::format("{}:{}", Version, configuration)) {}
+
+bool IRCache::load(llvm::StringRef hash, llvm::Function* function) const {
+  auto buffer = llvm::MemoryBuffer::getFile(getPathOf(hash));
+  if (!buffer) {
+    return false;
+  }
+
+  auto module = llvm::parseBitcodeFile((*buffer)->getMemBufferRef(),
+                                       function->getContext());
+  if (!module) {
+    return false;
+  }
+
+  auto cached = (*module)->getFunction(function->getName());
+  if (!cached || cached->isDeclaration() ||
+      (cached->getFunctionType() != function->getFunctionType())) {
+    return false;
+  }
+
+  if (!cloneFunctionBody(cached, function)) {
+    // Never keep a body which references the cached module
+    function->deleteBody();
+    return false;
+  }
+  return true;
+}
+
+bool IRCache::store(llvm::StringRef hash, llvm::Function* function) const {
+  auto& context = function->getContext();
+  llvm::Module module(function->getName(), context);
+  module.setDataLayout(function->getParent()->getDataLayout());
+  module.setTargetTriple(function->getParent()->getTargetTriple());
+
+  auto cloned = llvm::cast<llvm::Function>(module.getOrInsertFunction(
+      function->getName(), function->getFunctionType()));
+  if (!cloneFunctionBody(function, cloned)) {
+    return false;
+  }
+
+  auto const path = getPathOf(hash);
+  if (llvm::sys::fs::create_directories(directory_)) {
+    return false;
+  }
+
+  // Write the function into a temporary file first, so concurrent
+  // compilations never read a partially written function.
+  int fd;
+  llvm::SmallString<128> temporaryPath;
+  if (llvm::sys::fs::createUniqueFile(path + "-%%%%%%%%", fd,
+                                      temporaryPath)) {
+    return false;
+  }
+
+  {
+    llvm::raw_fd_ostream out(fd, /*shouldClose*/ true);
+    llvm::WriteBitcodeToFile(&module, out);
+    out.close();
+    if (out.has_error()) {
+      out.clear_error();
+      llvm::sys::fs::remove(temporaryPath);
+      return false;
+    }
+  }
+
+  if (llvm::sys::fs::rename(temporaryPath, path)) {
+    llvm::sys::fs::remove(temporaryPath);
+    return false;
+  }
+  return true;
+}
+
+std::string IRCache::getPathOf(llvm::StringRef hash) const {
+  llvm::SmallString<128> path(directory_);
+  llvm::sys::path::append(path, hash + ".bc");
+  return path.str();
+}
@@ -0,0 +1,64 @@
+
+/**
+  Copyright(c) 2016 - 2017 Denis Blank <denis.blank at outlook dot com>
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+**/
+
+#ifndef IR_CACHE_HPP_INCLUDED__
+#define IR_CACHE_HPP_INCLUDED__
+
+#include <string>
+
+#include "llvm/ADT/StringRef.h"
+
+namespace llvm {
+class Function;
+}
+
+/// Persists the optimized IR of generated functions inside a directory,
+/// where every function is stored as bitcode file named after its hash.
+///
+/// The functions are looked up through the hash of their subtree and
+/// the signatures of the declarations they reference, so a function is
+/// only generated again when it or one of its dependencies changed.
+class IRCache {
+  std::string directory_;
+  /// Describes the configuration the functions are generated with
+  std::string salt_;
+
+public:
+  /// The version of the cache, which is increased on every change
+  /// of the code generation or of the hash of functions.
+  static constexpr unsigned Version = 1;
+
+  IRCache(std::string directory, std::string configuration);
+
+  /// Returns the salt which is hashed together with every function
+  llvm::StringRef getSalt() const { return salt_; }
+
+  /// Generates the body of the given function declaration out of the
+  /// cached function with the given hash.
+  /// Returns false when the function isn't cached.
+  bool load(llvm::StringRef hash, llvm::Function* function) const;
+  /// Stores the given function with the given hash, the function isn't
+  /// stored when it references globals other than functions.
+  /// Returns false when the function wasn't stored.
+  bool store(llvm::StringRef hash, llvm::Function* function) const;
+
+private:
+  /// Returns the path of the cached function with the given hash
+  std::string getPathOf(llvm::StringRef hash) const;
+};
+
+#endif // #ifndef IR_CACHE_HPP_INCLUDED__
@@ -89,4 +89,11 @@ void mangleNameOf(llvm::raw_ostream& ostream,
                   MetaInstantiationExprASTNode const* node) {
   mangleSymbol(ostream, fmt::format("{}", static_cast<void const*>(node)));
 }
+
+void mangleNameOf(llvm::raw_ostream& ostream,
+                  GlobalConstantArrayDeclASTNode const* node) {
+  // Arrays exported into a function don't have a containing unit,
+  // arrays which share their name are distinguished on creation.
+  mangleSymbol(ostream, *node->getName());
+}
 } // end namespace mangeling
@@ -25,6 +25,7 @@ class MetaUnitASTNode;
 class FunctionDeclASTNode;
 class MetaDeclASTNode;
 class MetaInstantiationExprASTNode;
+class GlobalConstantArrayDeclASTNode;
 
 /// Provides helper functions to mangle the name of various ASTNode's
 /// and symbols so it can be distinguished from user defined identifiers.
@@ -42,6 +43,9 @@ void mangleNameOf(llvm::raw_ostream& ostream, MetaDeclASTNode const* node);
 /// Writes the mangled name of the node to the given stream
 void mangleNameOf(llvm::raw_ostream& ostream,
                   MetaInstantiationExprASTNode const* node);
+/// Writes the mangled name of the node to the given stream
+void mangleNameOf(llvm::raw_ostream& ostream,
+                  GlobalConstantArrayDeclASTNode const* node);
 } // end namespace mangeling
 
 #endif // #ifndef NAME_MANGELING_HPP_INCLUDED__
@@ -39,19 +39,42 @@ FOR_EACH_DIAG(Note, DidYouMeanQuestion,
 FOR_EACH_DIAG(Note, InstantiatingMetaDecl,
   "Instantiating meta instantiation '{}'")
 
+FOR_EACH_DIAG(Note, PreviousMatchArmHint,
+  "Previously matched by this arm")
+
+FOR_EACH_DIAG(Note, PreviousAttributeHint,
+  "Previously specified here")
+
 FOR_EACH_DIAG(Note, InstantiationExported,
   "Meta instantiation '{}' exported variable '{}' as constant value '{}'.")
 
+FOR_EACH_DIAG(Note, InstantiationExportedArray,
+  "Meta instantiation '{}' exported array '{}' as constant table {{{}}}.")
+
 ////////////////////
 // Warnings
 FOR_EACH_DIAG(Warning, DidYouMeanEquals,
   "Did you intend to use '=='? ,-)")
 
+FOR_EACH_DIAG(Warning, TargetClonesUnsupported,
+  "Function multiversioning isn't supported for target '{}', "
+  "only the default version of '{}' is emitted.")
+
 ////////////////////
 // Errors
 FOR_EACH_DIAG(Error, GenericParserFault,
   "{}")
 
+FOR_EACH_DIAG(Error, CharacterUnrecognized,
+  "The character '{}' isn't part of any token!")
+
+FOR_EACH_DIAG(Error, StringLiteralUnterminated,
+  "The string literal is missing its closing quote!")
+
+FOR_EACH_DIAG(Error, MetaStmtNotAllowed,
+  "Meta statements are only allowed inside meta declarations "
+  "and outside of meta calculations!")
+
 FOR_EACH_DIAG(Error, FunctionNameReserved,
   "Name '{}' is reserved already and thus it "
   "can't be used as a function name!")
@@ -105,5 +128,66 @@ FOR_EACH_DIAG(Error, InstantiationNoExport,
   "The meta instantiation of '{}' didn't export any "
   "declaration with it's name!")
 
+FOR_EACH_DIAG(Error, MatchPatternNotConstant,
+  "The pattern of a match arm is required to be an integral constant!")
+
+FOR_EACH_DIAG(Error, MatchPatternTypeMismatch,
+  "The pattern of a match arm is required to be {} like the matched "
+  "expression!")
+
+FOR_EACH_DIAG(Error, MatchPatternDuplicated,
+  "The pattern '{}' is matched by multiple arms!")
+
+FOR_EACH_DIAG(Error, MatchWildcardDuplicated,
+  "The wildcard arm '_' is specified multiple times!")
+
+FOR_EACH_DIAG(Error, AttributeUnknown,
+  "The attribute '{}' is unknown!")
+
+FOR_EACH_DIAG(Error, AttributeArgumentsMissing,
+  "The attribute '{}' requires at least one argument!")
+
+FOR_EACH_DIAG(Error, AttributeArgumentsUnexpected,
+  "The attribute '{}' doesn't accept any arguments!")
+
+FOR_EACH_DIAG(Error, AttributeConflicting,
+  "The attribute '{}' conflicts with the attribute '{}'!")
+
+FOR_EACH_DIAG(Error, AttributeNotApplicable,
+  "The attribute '{}' can't be applied to {}!")
+
+FOR_EACH_DIAG(Error, TargetClonesWithoutDefault,
+  "The target clones of function '{}' don't contain a \"default\" target!")
+
+FOR_EACH_DIAG(Error, TargetClonesDuplicated,
+  "The target '{}' is cloned multiple times!")
+
+FOR_EACH_DIAG(Error, TargetClonesUnknownFeature,
+  "The target '{}' isn't a known cpu feature for function multiversioning!")
+
+FOR_EACH_DIAG(Error, ArraySizeInvalid,
+  "The size '{}' of array '{}' isn't a positive integer!")
+
+FOR_EACH_DIAG(Error, ArrayIndexOutOfBounds,
+  "The index {} is out of the bounds of array '{}' with {} elements!")
+
+FOR_EACH_DIAG(Error, SubscriptedNonArray,
+  "Can only apply the subscript operator to arrays!")
+
+FOR_EACH_DIAG(Error, ArrayUsedAsValue,
+  "The array '{}' can only be accessed through the subscript operator!")
+
+FOR_EACH_DIAG(Error, ConstantArrayAssigned,
+  "The array '{}' was computed by a meta calculation and is read only!")
+
+FOR_EACH_DIAG(Error, ModuleNotFound,
+  "The imported module '{}' wasn't found!")
+
+FOR_EACH_DIAG(Error, ModuleImportedCyclic,
+  "The module '{}' imports itself through a cycle of imports!")
+
+FOR_EACH_DIAG(Error, ModuleBuildFailed,
+  "Failed to build the imported module '{}'!")
+
 #undef AS_ENUM
 #undef FOR_EACH_DIAG
@@ -17,23 +17,8 @@
 
 #include "DiagnosticBuilder.hpp"
 
-#include "CompilationUnit.hpp"
-#include "CompilerInstance.hpp"
 #include "DiagnosticEngine.hpp"
 
-static llvm::SourceMgr::DiagKind mapSeverityToDiagKind(Severity severity) {
-  switch (severity) {
-    case Severity::Note:
-      return llvm::SourceMgr::DiagKind::DK_Note;
-    case Severity::Warning:
-      return llvm::SourceMgr::DiagKind::DK_Warning;
-    case Severity::Error:
-      return llvm::SourceMgr::DiagKind::DK_Error;
-    default:
-      llvm_unreachable("There was no mapping available for this severity!");
-  }
-}
-
 DiagnosticBuilder::~DiagnosticBuilder() {
   if (!ownership_.hasOwnership())
     return;
@@ -41,16 +26,9 @@ DiagnosticBuilder::~DiagnosticBuilder() {
   assert(location_.toLLVMLocation().isValid() &&
          "Given diagnostic has an invalid location!");
 
-  // Build the diagnostic
-  auto kind = mapSeverityToDiagKind(severity_);
-
-  auto message = diagnosticEngine_->getCompilationUnit()
-                     ->getCompilerInstance()
-                     ->getSourceMgr()
-                     .GetMessage(location_.toLLVMLocation(), kind,
-                                 llvm::Twine(msg_), ranges_, fixIts_);
-
-  diagnosticEngine_->consumeDiagnostic(message);
+  diagnosticEngine_->consumeDiagnostic({severity_, location_, std::move(msg_),
+                                        std::move(ranges_),
+                                        std::move(fixIts_)});
 }
 
 DiagnosticBuilder&& DiagnosticBuilder::addRange(SourceRange sourceRange) {
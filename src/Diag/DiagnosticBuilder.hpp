@@ -18,6 +18,7 @@
 #ifndef DIAGNOSTIC_BUILDER_HPP_INCLUDED__
 #define DIAGNOSTIC_BUILDER_HPP_INCLUDED__
 
+#include <string>
 #include <utility>
 
 #include "llvm/ADT/Twine.h"
@@ -31,13 +32,22 @@
 class CompilationUnit;
 class DiagnosticEngine;
 
+/// Represents a diagnostic which was built but not displayed yet
+struct PendingDiagnostic {
+  Severity severity;
+  SourceLocation location;
+  std::string msg;
+  llvm::SmallVector<llvm::SMRange, 2> ranges;
+  llvm::SmallVector<llvm::SMFixIt, 2> fixIts;
+};
+
 /// Diagnostic builder class to build llvm::SMDiagnostic's
 ///
 /// This class is designed to have a short lifetime.
 /// The diagnostic is dispatched on destruction of this class.
 class DiagnosticBuilder {
 public:
-  DiagnosticBuilder(DiagnosticEngine const* diagnosticEngine, Severity severity,
+  DiagnosticBuilder(DiagnosticEngine* diagnosticEngine, Severity severity,
                     SourceLocation location, std::string msg)
       : diagnosticEngine_(diagnosticEngine), severity_(severity),
         location_(location), msg_(std::move(msg)) {}
@@ -61,7 +71,7 @@ public:
                                       llvm::Twine const& replacement);
 
 private:
-  DiagnosticEngine const* diagnosticEngine_;
+  DiagnosticEngine* diagnosticEngine_;
   Severity severity_;
   SourceLocation location_;
   std::string msg_;
@@ -15,18 +15,90 @@
   limitations under the License.
 **/
 
+#include <utility>
+
 #include "llvm/Support/raw_ostream.h"
 
 #include "CompilationUnit.hpp"
 #include "CompilerInstance.hpp"
 #include "DiagnosticEngine.hpp"
 
-void DiagnosticEngine::consumeDiagnostic(
-    llvm::SMDiagnostic const& diagnostic) const {
-  compilationUnit_->getCompilerInstance()->getSourceMgr().PrintMessage(
-      llvm::errs(), diagnostic);
+static llvm::SourceMgr::DiagKind mapSeverityToDiagKind(Severity severity) {
+  switch (severity) {
+    case Severity::Note:
+      return llvm::SourceMgr::DiagKind::DK_Note;
+    case Severity::Warning:
+      return llvm::SourceMgr::DiagKind::DK_Warning;
+    case Severity::Error:
+      return llvm::SourceMgr::DiagKind::DK_Error;
+    default:
+      llvm_unreachable("There was no mapping available for this severity!");
+  }
+}
+
+bool DiagnosticEngine::consumeTypoCorrection() const {
+  return compilationUnit_->consumeTypoCorrection();
+}
+
+void DiagnosticEngine::replayInto(DiagnosticEngine* other) {
+  for (std::size_t i = 0; i < occurrence_.size(); ++i) {
+    other->occurrence_[i] += std::exchange(occurrence_[i], 0);
+  }
+  for (auto& diagnostic : deferred_) {
+    other->consumeDiagnostic(std::move(diagnostic));
+  }
+  deferred_.clear();
+}
+
+void DiagnosticEngine::replayCopiesInto(
+    DiagnosticEngine* other,
+    llvm::function_ref<llvm::SMLoc(llvm::SMLoc)> relocate) {
+  auto const relocateRange = [&](llvm::SMRange const& range) {
+    return llvm::SMRange(relocate(range.Start), relocate(range.End));
+  };
+
+  for (std::size_t i = 0; i < occurrence_.size(); ++i) {
+    other->occurrence_[i] += occurrence_[i];
+  }
+  for (auto const& diagnostic : deferred_) {
+    PendingDiagnostic copy{
+        diagnostic.severity,
+        SourceLocation(relocate(diagnostic.location.toLLVMLocation())),
+        diagnostic.msg,
+        {},
+        {}};
+    for (auto const& range : diagnostic.ranges) {
+      copy.ranges.push_back(relocateRange(range));
+    }
+    for (auto const& fixIt : diagnostic.fixIts) {
+      copy.fixIts.emplace_back(relocateRange(fixIt.getRange()),
+                               fixIt.getText());
+    }
+    other->consumeDiagnostic(std::move(copy));
+  }
+}
+
+void DiagnosticEngine::consumeDiagnostic(PendingDiagnostic diagnostic) {
+  if (isDeferring_) {
+    deferred_.push_back(std::move(diagnostic));
+    return;
+  }
+
+  // Build the diagnostic
+  auto kind = mapSeverityToDiagKind(diagnostic.severity);
+
+  // The SourceMgr caches the line offsets of the buffers when creating
+  // messages, so it's locked together with the output.
+  auto lock = compilationUnit_->getCompilerInstance()->lockOutput();
+  auto& sourceMgr = compilationUnit_->getCompilerInstance()->getSourceMgr();
+  auto message = sourceMgr.GetMessage(
+      diagnostic.location.toLLVMLocation(), kind, llvm::Twine(diagnostic.msg),
+      diagnostic.ranges, diagnostic.fixIts);
+
+  sourceMgr.PrintMessage(
+      compilationUnit_->getCompilerInstance()->getErrorStream(), message);
 
-  if (diagnostic.getKind() == llvm::SourceMgr::DK_Error) {
+  if (kind == llvm::SourceMgr::DK_Error) {
     // ++errorCount;
     /*if (errorCount >= 5) {
       // TODO DO something
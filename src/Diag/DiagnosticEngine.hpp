@@ -20,6 +20,10 @@
 
 #include <array>
 #include <type_traits>
+#include <vector>
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/SMLoc.h"
 
 #include "Diagnostic.hpp"
 #include "DiagnosticBuilder.hpp"
@@ -35,6 +39,9 @@ class DiagnosticEngine {
 
   CompilationUnit const* compilationUnit_;
   std::array<std::size_t, std::size_t(Severity::Severity_Max)> occurrence_;
+  /// Is true when the diagnostics are deferred rather than displayed
+  bool isDeferring_;
+  std::vector<PendingDiagnostic> deferred_;
 
   /// Compile-time check for not passing pointers as diagnostic message arg.
   template <typename T, typename = std::enable_if_t<!std::is_pointer<T>::value>>
@@ -43,8 +50,19 @@ class DiagnosticEngine {
   }
 
 public:
-  explicit DiagnosticEngine(CompilationUnit const* compilationUnit)
-      : compilationUnit_(compilationUnit), occurrence_() {}
+  explicit DiagnosticEngine(CompilationUnit const* compilationUnit,
+                            bool isDeferring = false)
+      : compilationUnit_(compilationUnit), occurrence_(),
+        isDeferring_(isDeferring) {}
+
+  /// Creates a DiagnosticEngine which keeps all diagnostics until they
+  /// are replayed into another DiagnosticEngine.
+  /// This makes it possible to diagnose the source from worker threads,
+  /// while the diagnostics are still displayed in a deterministic order.
+  static DiagnosticEngine
+  CreateDeferred(CompilationUnit const* compilationUnit) {
+    return DiagnosticEngine(compilationUnit, true);
+  }
 
   /// Returns the compilation unit associated to this DiagnosticEngine
   CompilationUnit const* getCompilationUnit() const { return compilationUnit_; }
@@ -96,9 +114,24 @@ public:
     return getOccurrenceCount(Severity::Error) != 0;
   }
 
+  /// Returns true when a similar declaration may be searched for another
+  /// unknown name, where every call counts towards the limit.
+  /// The limit is shared by all engines of the compilation unit,
+  /// including the deferred ones which are replayed later.
+  bool consumeTypoCorrection() const;
+
+  /// Displays the deferred diagnostics through the given DiagnosticEngine
+  /// in the order they were emitted.
+  void replayInto(DiagnosticEngine* other);
+  /// Displays copies of the deferred diagnostics through the given
+  /// DiagnosticEngine, where all their locations are mapped through the
+  /// given function. The deferred diagnostics are kept for further replays.
+  void replayCopiesInto(DiagnosticEngine* other,
+                        llvm::function_ref<llvm::SMLoc(llvm::SMLoc)> relocate);
+
 private:
-  /// Consumes and displays the given diagnostic
-  void consumeDiagnostic(llvm::SMDiagnostic const& diagnostic) const;
+  /// Consumes and displays or defers the given diagnostic
+  void consumeDiagnostic(PendingDiagnostic diagnostic);
 
   DiagnosticBuilder createDiagnosticBuilder(Diagnostic diag, std::string msg,
                                             SourceLocation location);
@@ -24,6 +24,7 @@
 #include "llvm/ADT/StringRef.h"
 
 #include "SourceLocation.hpp"
+#include "Symbol.hpp"
 
 // namespace detail {
 template <typename T> T* pointerize(T& type) { return &type; }
@@ -83,7 +84,8 @@ using LocationAnnotated = SourceAnnotated<T, SourceLocation>;
 /// A type which is annotated with a source code range
 template <typename T> using RangeAnnotated = SourceAnnotated<T, SourceRange>;
 
-/// A type which is specialized for identifiers in the source code
-using Identifier = RangeAnnotated<llvm::StringRef>;
+/// A type which is specialized for identifiers in the source code,
+/// where the name is interned as Symbol.
+using Identifier = RangeAnnotated<Symbol>;
 
 #endif // #ifndef SOURCE_ANNOTATED_HPP_INCLUDED__
@@ -0,0 +1,46 @@
+
+/**
+  Copyright(c) 2016 - 2017 Denis Blank <denis.blank at outlook dot com>
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+**/
+
+#include "SourceLineIndex.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+SourceLineIndex::SourceLineIndex(llvm::StringRef source) : source_(source) {
+  lineStarts_.push_back(0U);
+
+  auto const begin = source.begin();
+  auto const end = source.end();
+  for (auto current = begin; current != end; ++current) {
+    current = static_cast<char const*>(
+        std::memchr(current, '\n', std::size_t(end - current)));
+    if (!current) {
+      break;
+    }
+    lineStarts_.push_back(std::uint32_t(current + 1 - begin));
+  }
+}
+
+char const* SourceLineIndex::getPointerOf(std::size_t line,
+                                          std::size_t column) const {
+  if ((line == 0) || (line > lineStarts_.size())) {
+    return source_.end();
+  }
+
+  auto const offset = std::size_t(lineStarts_[line - 1]) + column;
+  return source_.begin() + std::min(offset, source_.size());
+}
@@ -0,0 +1,48 @@
+
+/**
+  Copyright(c) 2016 - 2017 Denis Blank <denis.blank at outlook dot com>
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+**/
+
+#ifndef SOURCE_LINE_INDEX_HPP_INCLUDED__
+#define SOURCE_LINE_INDEX_HPP_INCLUDED__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "llvm/ADT/StringRef.h"
+
+/// Indexes the offsets of all line starts inside a source buffer,
+/// which makes it possible to translate line and column positions
+/// into pointers into the buffer without rescanning it.
+class SourceLineIndex {
+  llvm::StringRef source_;
+  /// The offsets of the line starts, where the first line starts at zero
+  std::vector<std::uint32_t> lineStarts_;
+
+public:
+  explicit SourceLineIndex(llvm::StringRef source);
+
+  /// Returns the count of lines in the source
+  std::size_t getLineCount() const { return lineStarts_.size(); }
+
+  /// Returns the pointer into the source of the given line which starts at 1,
+  /// and the given column which starts at 0.
+  /// Columns behind the end of a line continue in the following lines
+  /// and positions behind the source are clamped to its end.
+  char const* getPointerOf(std::size_t line, std::size_t column) const;
+};
+
+#endif // #ifndef SOURCE_LINE_INDEX_HPP_INCLUDED__
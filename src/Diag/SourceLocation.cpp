@@ -18,7 +18,6 @@
 #include "SourceLocation.hpp"
 
 #include "CompilationUnit.hpp"
-#include "CompilerInstance.hpp"
 
 SourceRange SourceLocation::extend(size_t extension) const {
   auto upper = llvm::SMLoc::getFromPointer(location_.getPointer() + extension);
@@ -30,27 +29,8 @@ SourceLocation::fromSource(CompilationUnit const* compilationUnit, size_t line,
                            size_t charPositionInLine) {
   // Translates the line number and offset of a token position back to
   // the llvm::SMLoc which takes just the character offset.
-  // This method is really evil, however it connects antlr nicely to the llvm
-  // diagnostic engine.
-  auto id = compilationUnit->getSourceFileId();
-  auto buffer =
-      compilationUnit->getCompilerInstance()->getSourceMgr().getMemoryBuffer(
-          id);
-
-  auto current = buffer->getBufferStart();
-  auto end = buffer->getBufferEnd();
-
-  // Extend the character position to the line
-  for (; (current < end) && (line != 1); ++current) {
-    if (*current == '\n') {
-      --line;
-    }
-  };
-  // Extend the character position to the offset
-  for (; (current < end); ++current, --charPositionInLine) {
-    if (charPositionInLine == 0) {
-      return SourceLocation(llvm::SMLoc::getFromPointer(current));
-    }
-  };
-  return SourceLocation(llvm::SMLoc::getFromPointer(buffer->getBufferEnd()));
+  // This connects antlr nicely to the llvm diagnostic engine.
+  auto pointer = compilationUnit->getLineIndex().getPointerOf(
+      line, charPositionInLine);
+  return SourceLocation(llvm::SMLoc::getFromPointer(pointer));
 }
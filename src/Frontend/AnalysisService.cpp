@@ -0,0 +1,69 @@
+
+/**
+  Copyright(c) 2016 - 2017 Denis Blank <denis.blank at outlook dot com>
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+**/
+
+#include "AnalysisService.hpp"
+
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "AnalysisSession.hpp"
+#include "CompilerInvocation.hpp"
+#include "Formatting.hpp"
+#include "ModuleManager.hpp"
+
+AnalysisService::AnalysisService()
+    : moduleManager_(std::make_shared<ModuleManager>()) {}
+
+AnalysisService::~AnalysisService() {}
+
+bool AnalysisService::analyzeSourceFiles(
+    CompilerInvocation const& compilerInvocation,
+    llvm::ArrayRef<std::string> paths, llvm::raw_ostream& output,
+    llvm::raw_ostream& errors) {
+  // The sessions refer to the declarations of the imported modules
+  if (moduleManager_->hasOutdated()) {
+    sessions_.clear();
+    moduleManager_->dropOutdated();
+  }
+
+  bool succeeded = true;
+  for (auto const& path : paths) {
+    auto source = llvm::MemoryBuffer::getFile(path);
+    if (!source) {
+      output << "Didn't find file {}!\n"_format(path);
+      succeeded = false;
+      continue;
+    }
+
+    // A session keeps the settings it was created with,
+    // so it starts over when the request changed them.
+    auto& session = sessions_[path];
+    if (!session || (session->getInvocation() != compilerInvocation)) {
+      session = std::make_unique<AnalysisSession>(compilerInvocation,
+                                                  moduleManager_, path);
+    }
+    if (!session->update((*source)->getBuffer(), output, errors)) {
+      succeeded = false;
+    }
+  }
+  return succeeded;
+}
+
+void AnalysisService::clear() {
+  sessions_.clear();
+  moduleManager_ = std::make_shared<ModuleManager>();
+}
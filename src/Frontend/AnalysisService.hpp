@@ -0,0 +1,61 @@
+
+/**
+  Copyright(c) 2016 - 2017 Denis Blank <denis.blank at outlook dot com>
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+**/
+
+#ifndef ANALYSIS_SERVICE_HPP_INCLUDED__
+#define ANALYSIS_SERVICE_HPP_INCLUDED__
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "llvm/ADT/ArrayRef.h"
+
+namespace llvm {
+class raw_ostream;
+}
+
+class AnalysisSession;
+class CompilerInvocation;
+class ModuleManager;
+
+/// Keeps an AnalysisSession alive for every source file across requests,
+/// so a request only analyzes the declarations which changed since the
+/// previous request of the same file.
+///
+/// The sessions share the modules they import, all sessions start over
+/// when one of the imported modules changed.
+class AnalysisService {
+  std::shared_ptr<ModuleManager> moduleManager_;
+  std::unordered_map<std::string, std::unique_ptr<AnalysisSession>> sessions_;
+
+public:
+  AnalysisService();
+  ~AnalysisService();
+
+  /// Analyzes the current contents of the given source files and displays
+  /// their diagnostics through the given streams. Sessions are created
+  /// again when they were created with a different CompilerInvocation.
+  /// Returns true when the source files contain no errors.
+  bool analyzeSourceFiles(CompilerInvocation const& compilerInvocation,
+                          llvm::ArrayRef<std::string> paths,
+                          llvm::raw_ostream& output, llvm::raw_ostream& errors);
+
+  /// Drops all sessions together with their imported modules
+  void clear();
+};
+
+#endif // #ifndef ANALYSIS_SERVICE_HPP_INCLUDED__
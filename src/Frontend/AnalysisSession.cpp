@@ -0,0 +1,513 @@
+
+/**
+  Copyright(c) 2016 - 2017 Denis Blank <denis.blank at outlook dot com>
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+**/
+
+#include "AnalysisSession.hpp"
+
+#include <unordered_map>
+#include <utility>
+
+#include "llvm/Support/Casting.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Timer.h"
+
+#include "GeneratedLexer.h"
+
+#include "AST.hpp"
+#include "ASTLayout.hpp"
+#include "ASTPredicate.hpp"
+#include "ASTScope.hpp"
+#include "ASTTraversal.hpp"
+#include "BasicASTBuilder.hpp"
+#include "CompilationUnit.hpp"
+#include "CompilerInstance.hpp"
+#include "Hash.hpp"
+#include "ModuleLoader.hpp"
+#include "ModuleManager.hpp"
+#include "ParallelSourceParser.hpp"
+#include "SemaAnalysis.hpp"
+#include "SourceLexer.hpp"
+#include "SourceParser.hpp"
+
+/// The session starts over when the retained revisions are larger than
+/// the current revision by this factor plus the minimal retained size.
+static constexpr std::size_t RetainedSizeFactor = 8;
+static constexpr std::size_t MinRetainedSize = 1U << 20U;
+
+/// Represents a top level declaration of the analyzed source
+struct AnalysisSession::Decl {
+  /// The text of the declaration in the revision it was parsed from,
+  /// which the locations of its nodes are referring to.
+  llvm::StringRef origin;
+  /// The begin of the declaration in the current revision
+  char const* current = nullptr;
+  /// The tokens of the declaration in the current revision
+  std::size_t beginToken = 0;
+  std::size_t endToken = 0;
+  /// Is true when the declaration was rebuilt for the current revision
+  bool isStale = true;
+  /// The layout of the declaration which is present until it's read
+  ASTLayout layout;
+  /// The top level nodes of the declaration
+  llvm::SmallVector<ASTNode*, 1> nodes;
+  /// The references to top level declarations of the unit
+  std::vector<DeclRefExprASTNode*> references;
+  DiagnosticEngine parseDiagnostics;
+  DiagnosticEngine introDiagnostics;
+  DiagnosticEngine readDiagnostics;
+  DiagnosticEngine semaDiagnostics;
+
+  explicit Decl(CompilationUnit const* compilationUnit)
+      : parseDiagnostics(DiagnosticEngine::CreateDeferred(compilationUnit)),
+        introDiagnostics(DiagnosticEngine::CreateDeferred(compilationUnit)),
+        readDiagnostics(DiagnosticEngine::CreateDeferred(compilationUnit)),
+        semaDiagnostics(DiagnosticEngine::CreateDeferred(compilationUnit)) {}
+};
+
+/// Calls the consumer with every named declaration of the given nodes
+template <typename F>
+static void forEachName(llvm::ArrayRef<ASTNode*> nodes, F&& consumer) {
+  for (auto node : nodes) {
+    traverseNode(node, [&](auto* promoted) {
+      staticIf(promoted, pred::isNamedDeclContext(),
+               [&](NamedDeclContext* decl) { consumer(decl); });
+    });
+  }
+}
+
+/// Returns true when the given declaration is a top level declaration
+/// of the given unit.
+static bool isDeclaredIn(NamedDeclContext const* decl, ASTNode const* unit) {
+  return traverseNode(decl->getDeclaringNode(), [&](auto* promoted) -> bool {
+    return conditionalEvaluate(
+        pred::isTopLevelNode()(promoted), promoted,
+        [&](auto* toplevel) -> bool {
+          return toplevel->getContainingUnit() == unit;
+        },
+        supplierOf(false));
+  });
+}
+
+AnalysisSession::AnalysisSession(CompilerInvocation const& compilerInvocation,
+                                 std::shared_ptr<ModuleManager> moduleManager,
+                                 std::string filePath)
+    : compilerInvocation_(compilerInvocation),
+      moduleManager_(std::move(moduleManager)), filePath_(std::move(filePath)) {
+}
+
+AnalysisSession::~AnalysisSession() {}
+
+bool AnalysisSession::update(llvm::StringRef source, llvm::raw_ostream& output,
+                             llvm::raw_ostream& errors) {
+  if (!compilerInstance_ ||
+      (retainedSize_ > RetainedSizeFactor * source.size() + MinRetainedSize)) {
+    if (!reset()) {
+      return false;
+    }
+  }
+  compilerInstance_->setOutputStreams(output, errors);
+
+  auto const id = compilerInstance_->addSourceBuffer(
+      llvm::MemoryBuffer::getMemBufferCopy(source, filePath_));
+  retainedSize_ += source.size();
+  if (compilationUnit_) {
+    compilationUnit_->setSourceFileId(id);
+  } else {
+    compilationUnit_ = std::make_unique<CompilationUnit>(
+        compilerInstance_.get(), id, filePath_);
+  }
+  source = compilationUnit_->getSource();
+
+  llvm::NamedRegionTimer timer("Incremental analysis", "Frontend",
+                               compilationUnit_->isTimingPhases());
+
+  auto diagnosticEngine = compilationUnit_->getDiagnosticEngine();
+  auto const previousErrors =
+      diagnosticEngine->getOccurrenceCount(Severity::Error);
+
+  SourceLexer lexer(compilationUnit_.get(), source);
+  auto const tokens = lexer.lex();
+  if (diagnosticEngine->getOccurrenceCount(Severity::Error) !=
+      previousErrors) {
+    // Keep the declarations of the last revision which could be lexed
+    return false;
+  }
+
+  // The imports precede all declarations and change the scope of all
+  // of them, so the unit is read again when they changed.
+  std::size_t importEnd = 0;
+  while (tokens[importEnd].kind == GeneratedLexer::Import) {
+    do {
+      ++importEnd;
+    } while ((tokens[importEnd - 1].kind != GeneratedLexer::Semicolon) &&
+             (tokens[importEnd].kind != LexedToken::KindEOF));
+  }
+  auto const importBegin = tokens.front().offset;
+  auto const importText =
+      importEnd ? source.slice(importBegin, tokens[importEnd - 1].offset +
+                                                tokens[importEnd - 1].length)
+                : source.substr(importBegin, 0);
+  if (!unitNode_ || (importText != importText_)) {
+    decls_.clear();
+    readImports(source, tokens, importEnd);
+    importText_ = importText;
+  }
+  importCurrent_ = importText.data();
+
+  // Match the declarations to the ones of the previous revision by their
+  // text, where declarations with the same text are matched in order.
+  std::unordered_map<llvm::StringRef, std::vector<std::unique_ptr<Decl>>,
+                     StringRefHasher>
+      previous;
+  for (auto itr = decls_.rbegin(); itr != decls_.rend(); ++itr) {
+    previous[(*itr)->origin].push_back(std::move(*itr));
+  }
+
+  auto const boundaries = ParallelSourceParser::splitEachTopLevelDecl(
+      llvm::makeArrayRef(tokens).drop_front(importEnd));
+  std::vector<std::unique_ptr<Decl>> decls;
+  for (std::size_t i = 0; i < boundaries.size(); ++i) {
+    auto const begin = importEnd + boundaries[i];
+    auto const end = (i + 1 < boundaries.size())
+                         ? (importEnd + boundaries[i + 1])
+                         : (tokens.size() - 1);
+    if (begin == end) {
+      continue;
+    }
+    auto const text = source.slice(
+        tokens[begin].offset, tokens[end - 1].offset + tokens[end - 1].length);
+
+    std::unique_ptr<Decl> decl;
+    auto itr = previous.find(text);
+    if ((itr != previous.end()) && !itr->second.empty()) {
+      decl = std::move(itr->second.back());
+      itr->second.pop_back();
+      decl->isStale = false;
+    } else {
+      decl = std::make_unique<Decl>(compilationUnit_.get());
+    }
+    decl->current = text.data();
+    decl->beginToken = begin;
+    decl->endToken = end;
+    decls.push_back(std::move(decl));
+  }
+
+  // The names of removed declarations are introduced again,
+  // which uncovers the declarations they were shadowing.
+  llvm::DenseSet<Symbol> names;
+  for (auto const& candidates : previous) {
+    for (auto const& decl : candidates.second) {
+      forEachName(decl->nodes, [&](NamedDeclContext* named) {
+        names.insert(*named->getName());
+      });
+    }
+  }
+  decls_ = std::move(decls);
+
+  for (auto const& decl : decls_) {
+    if (decl->isStale) {
+      parseDecl(*decl, tokens, names);
+    }
+  }
+  // Errors of unresolved declarations could be fixed
+  // through any declaration which changed its name.
+  if (!names.empty()) {
+    for (auto const& decl : decls_) {
+      if (!decl->isStale && decl->readDiagnostics.hasErrors()) {
+        parseDecl(*decl, tokens, names);
+      }
+    }
+  }
+
+  bool isRebuilt = !names.empty();
+  while (isRebuilt) {
+    introduceNames(names);
+    names.clear();
+    for (auto const& decl : decls_) {
+      if (!decl->layout.empty()) {
+        readDecl(*decl);
+      }
+    }
+
+    // The references of all other declarations are resolved again,
+    // a declaration is rebuilt when one of its references vanished.
+    isRebuilt = false;
+    for (auto const& decl : decls_) {
+      switch (resolveReferences(*decl)) {
+        case Resolution::Unchanged:
+          break;
+        case Resolution::Changed:
+          checkDecl(*decl);
+          break;
+        case Resolution::Unresolvable:
+          parseDecl(*decl, tokens, names);
+          isRebuilt = true;
+          break;
+      }
+    }
+  }
+
+  auto const relocation = [this](llvm::SMLoc location) {
+    return relocate(location);
+  };
+  importDiagnostics_->replayCopiesInto(diagnosticEngine, relocation);
+  for (auto const& decl : decls_) {
+    decl->parseDiagnostics.replayCopiesInto(diagnosticEngine, relocation);
+    decl->introDiagnostics.replayCopiesInto(diagnosticEngine, relocation);
+    decl->readDiagnostics.replayCopiesInto(diagnosticEngine, relocation);
+    decl->semaDiagnostics.replayCopiesInto(diagnosticEngine, relocation);
+  }
+  return diagnosticEngine->getOccurrenceCount(Severity::Error) ==
+         previousErrors;
+}
+
+bool AnalysisSession::reset() {
+  // The declarations refer to the unit and to the context
+  decls_.clear();
+  importDiagnostics_.reset();
+  unitNode_ = nullptr;
+  unitScope_ = nullptr;
+  importText_ = llvm::StringRef();
+  importCurrent_ = nullptr;
+  astContext_.reset();
+  compilationUnit_.reset();
+
+  retainedSize_ = 0;
+  compilerInstance_ =
+      CompilerInstance::create(compilerInvocation_, moduleManager_);
+  return bool(compilerInstance_);
+}
+
+void AnalysisSession::readImports(llvm::StringRef source,
+                                  llvm::ArrayRef<LexedToken> tokens,
+                                  std::size_t end) {
+  astContext_ = std::make_shared<ASTContext>();
+  importDiagnostics_ = std::make_unique<DiagnosticEngine>(
+      DiagnosticEngine::CreateDeferred(compilationUnit_.get()));
+
+  std::vector<LexedToken> importTokens(tokens.begin(), tokens.begin() + end);
+  importTokens.push_back({tokens[end].offset, 0, LexedToken::KindEOF});
+
+  SourceParser parser(compilationUnit_.get(), astContext_.get(), source,
+                      importTokens, importDiagnostics_.get());
+  parser.parseTopLevelDecls();
+  auto const layout = std::move(parser).buildLayout();
+
+  // Imports are top level nodes, so the subtrees of all other
+  // top level nodes are skipped.
+  llvm::SmallVector<ImportDeclASTNode*, 4> imports;
+  for (std::size_t position = 0; position < layout.size();
+       position = layout.getSubtreeEnd(position)) {
+    if (!layout.isReduceMarker(position) &&
+        (layout.getKind(position) == ASTKind::KindImportDecl)) {
+      imports.push_back(
+          llvm::cast<ImportDeclASTNode>(*layout.getNode(position)));
+    }
+  }
+
+  // The declarations aren't added as children of the unit node,
+  // since they are owned by the session.
+  unitNode_ = astContext_->allocate<CompilationUnitASTNode>();
+  auto loader = astContext_->allocate<ModuleLoader>(compilationUnit_.get(),
+                                                    astContext_.get());
+  unitScope_ = ConsistentASTScope::CreateConsistent(
+      astContext_.get(),
+      loader->importModules(imports, importDiagnostics_.get()));
+  unitNode_->setScope(unitScope_);
+}
+
+void AnalysisSession::parseDecl(Decl& decl, llvm::ArrayRef<LexedToken> tokens,
+                                llvm::DenseSet<Symbol>& names) {
+  forEachName(decl.nodes, [&](NamedDeclContext* named) {
+    names.insert(*named->getName());
+  });
+
+  auto const& first = tokens[decl.beginToken];
+  auto const& last = tokens[decl.endToken - 1];
+  decl.origin =
+      llvm::StringRef(decl.current, last.offset + last.length - first.offset);
+  decl.isStale = true;
+  decl.layout.clear();
+  decl.nodes.clear();
+  decl.references.clear();
+  decl.parseDiagnostics =
+      DiagnosticEngine::CreateDeferred(compilationUnit_.get());
+  decl.introDiagnostics =
+      DiagnosticEngine::CreateDeferred(compilationUnit_.get());
+  decl.readDiagnostics =
+      DiagnosticEngine::CreateDeferred(compilationUnit_.get());
+  decl.semaDiagnostics =
+      DiagnosticEngine::CreateDeferred(compilationUnit_.get());
+
+  // The declaration is terminated by an EOF token placed
+  // at the start of the following declaration.
+  std::vector<LexedToken> declTokens(tokens.begin() + decl.beginToken,
+                                     tokens.begin() + decl.endToken);
+  declTokens.push_back({tokens[decl.endToken].offset, 0, LexedToken::KindEOF});
+
+  SourceParser parser(compilationUnit_.get(), astContext_.get(),
+                      compilationUnit_->getSource(), declTokens,
+                      &decl.parseDiagnostics);
+  if (!parser.parseTopLevelDecls()) {
+    return;
+  }
+
+  // Terminate the layout like the scope of a unit
+  ASTLayoutWriter writer(std::move(parser).buildLayout());
+  writer.markReduce();
+  decl.layout = std::move(writer).buildLayout();
+
+  ASTLayoutReader reader(compilationUnit_.get(), astContext_.get(),
+                         decl.layout);
+  reader.crawlCurrentScope([&](ASTNode* node) {
+    traverseNode(node, [&](auto* promoted) {
+      staticIf(promoted, pred::isTopLevelNode(),
+               [&](TopLevelASTNode* toplevel) {
+                 toplevel->setContainingUnit(unitNode_);
+               });
+    });
+    decl.nodes.push_back(node);
+  });
+
+  forEachName(decl.nodes, [&](NamedDeclContext* named) {
+    names.insert(*named->getName());
+  });
+}
+
+void AnalysisSession::readDecl(Decl& decl) {
+  {
+    ASTLayoutReader reader(compilationUnit_.get(), astContext_.get(),
+                           decl.layout, &decl.readDiagnostics);
+    auto scope = reader.reenterConsistentScope(unitScope_);
+    while (!reader.shouldReduce()) {
+      reader.consume();
+    }
+  }
+
+  // Only references to declarations of the unit can change,
+  // all other declarations are resolved for the lifetime of the unit.
+  for (std::size_t position = 0; position < decl.layout.size(); ++position) {
+    if (decl.layout.isReduceMarker(position) ||
+        (decl.layout.getKind(position) != ASTKind::KindDeclRefExpr)) {
+      continue;
+    }
+    auto reference =
+        llvm::cast<DeclRefExprASTNode>(*decl.layout.getNode(position));
+    if (reference->isResolved() &&
+        isDeclaredIn(*reference->getDecl(), unitNode_)) {
+      decl.references.push_back(reference);
+    }
+  }
+  decl.layout.clear();
+
+  checkDecl(decl);
+}
+
+void AnalysisSession::checkDecl(Decl& decl) {
+  decl.semaDiagnostics =
+      DiagnosticEngine::CreateDeferred(compilationUnit_.get());
+
+  // Declarations with unresolved references can't be checked
+  if (decl.readDiagnostics.hasErrors()) {
+    return;
+  }
+  for (auto node : decl.nodes) {
+    SemaAnalysis semaAnalysis(compilationUnit_.get(), node,
+                              &decl.semaDiagnostics);
+    semaAnalysis.checkAST();
+  }
+}
+
+void AnalysisSession::introduceNames(llvm::DenseSet<Symbol>& names) {
+  auto const isAffected = [&](Decl const& decl) {
+    bool affected = false;
+    forEachName(decl.nodes, [&](NamedDeclContext* named) {
+      affected |= (names.count(*named->getName()) != 0);
+    });
+    return affected;
+  };
+
+  // Declarations with multiple names are introduced as a whole
+  bool isGrown;
+  do {
+    isGrown = false;
+    for (auto const& decl : decls_) {
+      if (isAffected(*decl)) {
+        forEachName(decl->nodes, [&](NamedDeclContext* named) {
+          isGrown |= names.insert(*named->getName()).second;
+        });
+      }
+    }
+  } while (isGrown);
+
+  for (auto const& name : names) {
+    unitScope_->erase(name);
+  }
+
+  // Introduce the declarations in source order, so a name which is
+  // declared twice is diagnosed at the same declaration as before.
+  for (auto const& decl : decls_) {
+    if (!isAffected(*decl)) {
+      continue;
+    }
+
+    decl->introDiagnostics =
+        DiagnosticEngine::CreateDeferred(compilationUnit_.get());
+    BasicASTBuilder builder(compilationUnit_.get(), astContext_.get(),
+                            &decl->introDiagnostics);
+    auto scope = builder.reenterConsistentScope(unitScope_);
+    forEachName(decl->nodes,
+                [&](NamedDeclContext* named) { builder.introduce(named); });
+  }
+}
+
+AnalysisSession::Resolution AnalysisSession::resolveReferences(Decl& decl) {
+  auto resolution = Resolution::Unchanged;
+  for (auto reference : decl.references) {
+    auto const resolved = unitScope_->lookupIdentifier(*reference->getName());
+    if (!resolved) {
+      return Resolution::Unresolvable;
+    }
+    if (*resolved != *reference->getDecl()) {
+      reference->setDecl(*resolved);
+      resolution = Resolution::Changed;
+    }
+  }
+  return resolution;
+}
+
+llvm::SMLoc AnalysisSession::relocate(llvm::SMLoc location) const {
+  auto const pointer = location.getPointer();
+  auto const isInside = [pointer](llvm::StringRef origin) {
+    return (pointer >= origin.begin()) && (pointer <= origin.end());
+  };
+
+  if (!pointer) {
+    return location;
+  }
+  if (isInside(importText_)) {
+    return llvm::SMLoc::getFromPointer(importCurrent_ +
+                                       (pointer - importText_.begin()));
+  }
+  for (auto const& decl : decls_) {
+    if (isInside(decl->origin)) {
+      return llvm::SMLoc::getFromPointer(decl->current +
+                                         (pointer - decl->origin.begin()));
+    }
+  }
+  // Locations inside imported modules stay the same
+  return location;
+}
@@ -0,0 +1,130 @@
+
+/**
+  Copyright(c) 2016 - 2017 Denis Blank <denis.blank at outlook dot com>
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+**/
+
+#ifndef ANALYSIS_SESSION_HPP_INCLUDED__
+#define ANALYSIS_SESSION_HPP_INCLUDED__
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/SMLoc.h"
+
+#include "ASTContext.hpp"
+#include "CompilerInvocation.hpp"
+#include "DiagnosticEngine.hpp"
+#include "Symbol.hpp"
+
+namespace llvm {
+class raw_ostream;
+}
+
+class CompilationUnit;
+class CompilationUnitASTNode;
+class CompilerInstance;
+class ConsistentASTScope;
+class ModuleManager;
+struct LexedToken;
+
+/// Analyzes the revisions of a source file incrementally, where the AST
+/// of the declarations which didn't change is kept alive across revisions.
+///
+/// A revision is split into its top level declarations, which are matched
+/// to the declarations of the previous revision by their text. Only the
+/// declarations which text changed are parsed, read and checked again.
+/// The consistent scope of the unit is patched for the names of the
+/// changed declarations, afterwards the references of the kept
+/// declarations are resolved again, and only those which resolved
+/// references changed are checked again through the SemaAnalysis.
+/// Kept declarations which contain errors are rebuilt whenever any
+/// declaration changed, since their errors could depend on it.
+///
+/// The nodes of kept declarations still refer to the revision they were
+/// parsed from, thus their diagnostics are stored and relocated into the
+/// current revision when they are displayed.
+/// Every revision stays in the SourceMgr, so the session starts over in
+/// a fresh CompilerInstance when the retained revisions grow too large
+/// compared to the current one.
+///
+/// The session never generates code, so meta decls aren't instantiated.
+class AnalysisSession {
+  struct Decl;
+  enum class Resolution { Unchanged, Changed, Unresolvable };
+
+  CompilerInvocation compilerInvocation_;
+  std::shared_ptr<ModuleManager> moduleManager_;
+  std::string filePath_;
+  std::unique_ptr<CompilerInstance> compilerInstance_;
+  std::unique_ptr<CompilationUnit> compilationUnit_;
+  ASTContextRef astContext_;
+  CompilationUnitASTNode* unitNode_ = nullptr;
+  ConsistentASTScope* unitScope_ = nullptr;
+  /// The imports of the unit in the revision they were read from
+  llvm::StringRef importText_;
+  /// The begin of the imports in the current revision
+  char const* importCurrent_ = nullptr;
+  /// The diagnostics emitted while reading the imports
+  std::unique_ptr<DiagnosticEngine> importDiagnostics_;
+  /// The top level declarations of the current revision in source order
+  std::vector<std::unique_ptr<Decl>> decls_;
+  /// The size of all revisions which were added to the SourceMgr
+  std::size_t retainedSize_ = 0;
+
+public:
+  AnalysisSession(CompilerInvocation const& compilerInvocation,
+                  std::shared_ptr<ModuleManager> moduleManager,
+                  std::string filePath);
+  ~AnalysisSession();
+
+  /// Returns the invocation the session was created with
+  CompilerInvocation const& getInvocation() const {
+    return compilerInvocation_;
+  }
+
+  /// Analyzes the given revision of the source file and displays its
+  /// diagnostics through the given streams.
+  /// Returns true when the revision contains no errors.
+  bool update(llvm::StringRef source, llvm::raw_ostream& output,
+              llvm::raw_ostream& errors);
+
+private:
+  /// Drops all state and starts over in a fresh CompilerInstance
+  bool reset();
+  /// Creates the unit node with the scope of the given imports
+  void readImports(llvm::StringRef source, llvm::ArrayRef<LexedToken> tokens,
+                   std::size_t end);
+  /// Parses the given declaration out of the tokens of the current revision,
+  /// where its previous and its current names are added to the given set.
+  void parseDecl(Decl& decl, llvm::ArrayRef<LexedToken> tokens,
+                 llvm::DenseSet<Symbol>& names);
+  /// Reads the layout of the given declaration and checks it afterwards
+  void readDecl(Decl& decl);
+  /// Checks the given declaration for semantical correctness
+  void checkDecl(Decl& decl);
+  /// Introduces all declarations with one of the given names again
+  void introduceNames(llvm::DenseSet<Symbol>& names);
+  /// Resolves the references of the given declaration again
+  Resolution resolveReferences(Decl& decl);
+  /// Maps the given location into the current revision
+  llvm::SMLoc relocate(llvm::SMLoc location) const;
+};
+
+#endif // #ifndef ANALYSIS_SESSION_HPP_INCLUDED__
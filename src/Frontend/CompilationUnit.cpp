@@ -20,92 +20,189 @@
 #include "antlr4-runtime.h"
 
 #include "llvm/ExecutionEngine/ExecutionEngine.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/Timer.h"
 
-#include "GeneratedLexer.h"
 #include "GeneratedParser.h"
 
 #include "AST.hpp"
 #include "ASTDumper.hpp"
 #include "ASTParser.hpp"
+#include "ASTTraversal.hpp"
 #include "CodegenInstance.hpp"
 #include "CompilerInstance.hpp"
 #include "CompilerInvocation.hpp"
-#include "DiagnosticListener.hpp"
+#include "LexedTokenSource.hpp"
+#include "ModuleFile.hpp"
+#include "ModuleManager.hpp"
+#include "ModuleWriter.hpp"
 #include "SemaAnalysis.hpp"
+#include "SourceLexer.hpp"
 #include "TokenDumper.hpp"
 
 CompilationUnit::CompilationUnit(CompilerInstance* compilerInstance,
-                                 unsigned sourceFileId, std::string filePath)
+                                 unsigned sourceFileId, std::string filePath,
+                                 bool isModuleBuild)
     : compilerInstance_(compilerInstance), sourceFileId_(sourceFileId),
       filePath_(std::move(filePath)),
-      fileName_(llvm::sys::path::filename(filePath_)), diagnosticEngine_(this) {
+      fileName_(llvm::sys::path::filename(filePath_)),
+      source_(compilerInstance->getSourceBuffer(sourceFileId)),
+      lineIndex_(source_), isModuleBuild_(isModuleBuild),
+      diagnosticEngine_(this) {}
+
+void CompilationUnit::setSourceFileId(unsigned sourceFileId) {
+  sourceFileId_ = sourceFileId;
+  source_ = compilerInstance_->getSourceBuffer(sourceFileId);
+  lineIndex_ = SourceLineIndex(source_);
+  typoCorrections_.store(0, std::memory_order_relaxed);
 }
 
-void CompilationUnit::translate() {
-  // Create an antlr input stream from the llvm buffer containing
-  // the source file
-  auto buffer =
-      getCompilerInstance()->getSourceMgr().getMemoryBuffer(sourceFileId_);
-  antlr4::ANTLRInputStream input(buffer->getBuffer());
+bool CompilationUnit::isTimingPhases() const {
+  // Modules are built while the importing unit is timed already
+  return !isModuleBuild_ &&
+         getCompilerInstance()->getInvocation()->hasVerboseFlag(
+             VerboseFlag::PhaseTimes);
+}
+
+bool CompilationUnit::hasEmitAction(EmitAction action) const {
+  return !isModuleBuild_ &&
+         getCompilerInstance()->getInvocation()->hasEmitAction(action);
+}
+
+std::unique_ptr<llvm::MemoryBuffer> CompilationUnit::translate() {
+  auto result = analyze();
+  if (!result)
+    return nullptr;
+
+  if (hasEmitAction(EmitAction::EmitAST)) {
+    auto lock = getCompilerInstance()->lockOutput();
+    dumpAST(getCompilerInstance()->getOutputStream(),
+            result->getCompilationUnit());
+    return nullptr;
+  }
+
+  if (hasEmitAction(EmitAction::EmitModule)) {
+    auto stamp = SourceStamp::of(filePath_);
+    if (!stamp) {
+      getCompilerInstance()->logError("Failed to read the source file {}!",
+                                      filePath_);
+      return nullptr;
+    }
+    auto module = writeModule(*result, *stamp);
+    if (!ModuleManager::writeModule(filePath_, *module)) {
+      getCompilerInstance()->logError("Failed to write the module of {}!",
+                                      filePath_);
+    }
+    return nullptr;
+  }
+
+  auto codegen =
+      CodegenInstance::createFor(this, result->getASTContext().get());
+
+  if (!codegen) {
+    return nullptr;
+  }
+
+  bool isGenerated;
+  {
+    llvm::NamedRegionTimer timer("Code generation", "Frontend",
+                                 isTimingPhases());
+    isGenerated = codegen->codegen(result->getCompilationUnit());
+  }
+  if (!isGenerated) {
+    return nullptr;
+  }
+
+  // emitAST(getCompilerInstance(), tree);
+  return codegen->emitBitcode();
+}
+
+std::unique_ptr<llvm::MemoryBuffer>
+CompilationUnit::buildModule(SourceStamp const& stamp) {
+  auto result = analyze();
+  if (!result)
+    return nullptr;
 
-  // Instantiate the lexer and register the custom error handler
-  GeneratedLexer lexer(&input);
-  auto errorListener = createDiagnosticListener(this);
-  lexer.removeErrorListeners();
-  lexer.addErrorListener(errorListener.get());
+  return writeModule(*result, stamp);
+}
 
-  auto tokens = std::make_shared<antlr4::CommonTokenStream>(&lexer);
+llvm::Optional<ASTParseResult> CompilationUnit::analyze() {
+  // Lex the llvm buffer containing the source file in place
+  SourceLexer lexer(this, source_);
+  std::vector<LexedToken> lexed;
+  {
+    llvm::NamedRegionTimer timer("Lexing", "Frontend", isTimingPhases());
+    lexed = lexer.lex();
+  }
 
-  if (getCompilerInstance()->getInvocation()->hasEmitAction(
-          EmitAction::EmitTokens)) {
-    tokens->fill();
+  LexedTokenSource tokenSource(source_, lexed, fileName_.str());
+  auto tokens = std::make_shared<antlr4::CommonTokenStream>(&tokenSource);
 
+  if (hasEmitAction(EmitAction::EmitTokens)) {
     if (diagnosticEngine_.hasErrors()) {
       getCompilerInstance()->logError(
           "There were {} errors when lexing the source file, aborting!",
           diagnosticEngine_.getOccurrenceCount(Severity::Error));
-      return;
+      return llvm::None;
     }
 
-    dumpTokens(llvm::outs(), tokens.get(), &lexer);
-    return;
+    auto lock = getCompilerInstance()->lockOutput();
+    dumpTokens(getCompilerInstance()->getOutputStream(), tokens.get());
+    return llvm::None;
   }
 
   ASTParser generator(this);
 
-  auto result = generator.parse(tokens);
+  auto const parserKind =
+      getCompilerInstance()->getInvocation()->getParserKind();
+  auto result = (parserKind != ParserKind::Descent)
+                    ? generator.parse(tokens)
+                    : generator.parse(source_, lexed);
 
   if (!result)
-    return;
+    return llvm::None;
 
-  SemaAnalysis semaAnalysis(this, result->getCompilationUnit());
-  semaAnalysis.checkAST();
+  {
+    llvm::NamedRegionTimer timer("Semantic analysis", "Frontend",
+                                 isTimingPhases());
+    SemaAnalysis semaAnalysis(this, result->getCompilationUnit());
+    semaAnalysis.checkAST();
+  }
   if (diagnosticEngine_.hasErrors()) {
     getCompilerInstance()->logError(
         "There were {} errors when checking the source file "
         "for semantical correctness, aborting!",
         diagnosticEngine_.getOccurrenceCount(Severity::Error));
-    return;
+    return llvm::None;
   }
 
-  if (getCompilerInstance()->getInvocation()->hasEmitAction(
-          EmitAction::EmitAST)) {
-    dumpAST(llvm::outs(), result->getCompilationUnit());
-    return;
-  }
-
-  auto codegen =
-      CodegenInstance::createFor(this, result->getASTContext().get());
-
-  if (!codegen) {
-    return;
+  if (!isModuleBuild_ &&
+      getCompilerInstance()->getInvocation()->hasVerboseFlag(
+          VerboseFlag::ASTStatistics)) {
+    auto lock = getCompilerInstance()->lockOutput();
+    auto& out = getCompilerInstance()->getErrorStream();
+    out << "AST statistics of " << fileName_ << ":\n";
+    result->getASTContext()->printStatistics(out);
   }
+  return result;
+}
 
-  if (codegen->codegen(result->getCompilationUnit())) {
-    codegen->dump();
+std::unique_ptr<llvm::MemoryBuffer>
+CompilationUnit::writeModule(ASTParseResult const& result,
+                             SourceStamp const& stamp) const {
+  ModuleWriter writer(source_);
+  for (auto child : result.getCompilationUnit()->children()) {
+    if (auto import = llvm::dyn_cast<ImportDeclASTNode>(child)) {
+      writer.addImport(ModuleManager::resolveImportPath(
+          filePath_, *import->getPath()));
+    } else {
+      traverseNode(child, [&](auto* promoted) {
+        staticIf(promoted, pred::isNamedDeclContext(),
+                 [&](NamedDeclContext* decl) { writer.addDecl(decl); });
+      });
+    }
   }
-
-  // emitAST(getCompilerInstance(), tree);
+  return writer.write(stamp, ModuleManager::getModulePath(filePath_));
 }
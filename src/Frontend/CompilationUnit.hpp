@@ -18,20 +18,31 @@
 #ifndef COMPILATION_UNIT_HPP_INCLUDED__
 #define COMPILATION_UNIT_HPP_INCLUDED__
 
+#include <atomic>
+#include <cstddef>
+#include <memory>
 #include <string>
 #include <utility>
 
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/StringRef.h"
+
+#include "CompilerInvocation.hpp"
 #include "DiagnosticEngine.hpp"
+#include "SourceLineIndex.hpp"
 
 namespace antlr4 {
 class Token;
 }
 
 namespace llvm {
+class MemoryBuffer;
 class SMDiagnostic;
 }
 
+class ASTParseResult;
 class CompilerInstance;
+struct SourceStamp;
 
 /// Represents a compilation unit
 class CompilationUnit {
@@ -39,11 +50,25 @@ class CompilationUnit {
   unsigned sourceFileId_;
   std::string filePath_;
   llvm::StringRef fileName_;
+  llvm::StringRef source_;
+  /// The line index of the source file, which is built eagerly since
+  /// the unit is accessed by multiple threads.
+  SourceLineIndex lineIndex_;
+  /// Is true when the unit is translated into a module for an import
+  bool isModuleBuild_;
   DiagnosticEngine diagnosticEngine_;
+  /// The count of searches for similar declarations in the current run,
+  /// which is shared by all diagnostic engines of the unit since the
+  /// declarations are read through many deferred ones.
+  mutable std::atomic<std::size_t> typoCorrections_{0};
+
+  /// The maximum count of searches for similar declarations,
+  /// since erroneous sources can easily produce thousands of unknown names.
+  enum : std::size_t { MaxTypoCorrections = 50 };
 
 public:
   CompilationUnit(CompilerInstance* compilerInstance, unsigned sourceFileId,
-                  std::string filePath);
+                  std::string filePath, bool isModuleBuild = false);
 
   /// Returns the compiler instance that owns this compilation unit
   CompilerInstance* getCompilerInstance() const { return compilerInstance_; }
@@ -51,13 +76,49 @@ public:
   DiagnosticEngine* getDiagnosticEngine() { return &diagnosticEngine_; }
   /// Returns the source file id that represents a file in the llvm::SourceMgr
   unsigned getSourceFileId() const { return sourceFileId_; }
+  /// Replaces the source file through a newer revision of it,
+  /// which is used when the unit is analyzed incrementally.
+  /// The typo corrections are counted anew for the revision.
+  void setSourceFileId(unsigned sourceFileId);
   /// Returns the path to the source file
   llvm::StringRef getSourceFilePath() const { return filePath_; }
   /// Returns the name of the source file
   llvm::StringRef getSourceFileName() const { return fileName_; }
+  /// Returns the contents of the source file
+  llvm::StringRef getSource() const { return source_; }
+  /// Returns the line index of the source file
+  SourceLineIndex const& getLineIndex() const { return lineIndex_; }
+
+  /// Returns true when a similar declaration may be searched for another
+  /// unknown name, where every call counts towards the limit of the run.
+  /// This is safe to call from the threads that read the unit in parallel.
+  bool consumeTypoCorrection() const {
+    return typoCorrections_.fetch_add(1, std::memory_order_relaxed) <
+           MaxTypoCorrections;
+  }
+
+  /// Returns true when the time spent in the frontend phases is reported
+  bool isTimingPhases() const;
+  /// Returns true when the given emit action was requested for this unit,
+  /// which is never the case for units that are built into modules.
+  bool hasEmitAction(EmitAction action) const;
+
+  /// Translates the given translation unit and returns the generated module
+  /// as bitcode, which is null on errors or when an emit action stopped the
+  /// translation early.
+  std::unique_ptr<llvm::MemoryBuffer> translate();
+
+  /// Analyzes the translation unit and returns the module containing its
+  /// declarations, which is null on errors.
+  std::unique_ptr<llvm::MemoryBuffer> buildModule(SourceStamp const& stamp);
 
-  /// Translates the given translation unit
-  void translate();
+private:
+  /// Lexes, parses and checks the translation unit, the result is empty
+  /// on errors or when an emit action stopped the analysis early.
+  llvm::Optional<ASTParseResult> analyze();
+  /// Returns the module containing the declarations of the given unit
+  std::unique_ptr<llvm::MemoryBuffer>
+  writeModule(ASTParseResult const& result, SourceStamp const& stamp) const;
 };
 
 #endif // #ifndef COMPILATION_UNIT_HPP_INCLUDED__
@@ -0,0 +1,279 @@
+
+/**
+  Copyright(c) 2016 - 2017 Denis Blank <denis.blank at outlook dot com>
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+**/
+
+#include "CompileServer.hpp"
+
+#include <cstdint>
+#include <vector>
+
+#include "llvm/Config/llvm-config.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Signals.h"
+#include "llvm/Support/raw_ostream.h"
+
+#ifdef LLVM_ON_UNIX
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#ifdef LLVM_ON_UNIX
+/// Writes the whole data to the given file descriptor
+static bool writeAll(int fd, char const* data, std::size_t size) {
+  while (size != 0) {
+    auto const written = ::write(fd, data, size);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    data += written;
+    size -= written;
+  }
+  return true;
+}
+
+/// Reads exactly the given count of bytes from the file descriptor,
+/// returns false on errors or when the end of the file was reached.
+static bool readAll(int fd, char* data, std::size_t size) {
+  while (size != 0) {
+    auto const read = ::read(fd, data, size);
+    if (read < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    if (read == 0) {
+      return false;
+    }
+    data += read;
+    size -= read;
+  }
+  return true;
+}
+
+/// Writes the given strings as single message to the file descriptor
+static bool writeMessage(int fd, llvm::ArrayRef<std::string> strings) {
+  std::string message;
+  auto const append = [&](std::uint32_t value) {
+    char buffer[sizeof(value)];
+    llvm::support::endian::write32le(buffer, value);
+    message.append(buffer, sizeof(buffer));
+  };
+
+  append(strings.size());
+  for (auto const& str : strings) {
+    append(str.size());
+    message.append(str);
+  }
+  return writeAll(fd, message.data(), message.size());
+}
+
+/// The limits of messages which are read from peers, so malformed messages
+/// are rejected before they exhaust the memory of the process.
+static constexpr std::uint32_t MaxMessageStrings = 1U << 16U;
+static constexpr std::size_t MaxMessageSize = std::size_t(1U) << 30U;
+
+/// Reads a message of strings from the file descriptor
+static bool readMessage(int fd, std::vector<std::string>& strings) {
+  auto const read = [&](std::uint32_t& value) {
+    char buffer[sizeof(value)];
+    if (!readAll(fd, buffer, sizeof(buffer))) {
+      return false;
+    }
+    value = llvm::support::endian::read32le(buffer);
+    return true;
+  };
+
+  std::uint32_t count;
+  if (!read(count) || (count > MaxMessageStrings)) {
+    return false;
+  }
+  strings.clear();
+  strings.reserve(count);
+  std::size_t remaining = MaxMessageSize;
+  for (std::uint32_t i = 0; i < count; ++i) {
+    std::uint32_t size;
+    if (!read(size) || (size > remaining)) {
+      return false;
+    }
+    remaining -= size;
+    std::string str(size, '\0');
+    if ((size != 0) && !readAll(fd, &str[0], size)) {
+      return false;
+    }
+    strings.push_back(std::move(str));
+  }
+  return true;
+}
+
+/// Handles a single request, returns false when the connection was closed
+static bool handleRequest(int input, int output,
+                          CompileRequestHandler& handler) {
+  std::vector<std::string> request;
+  if (!readMessage(input, request) || request.empty()) {
+    return false;
+  }
+
+  std::string out, err;
+  int exitCode = 1;
+  {
+    llvm::raw_string_ostream outStream(out);
+    llvm::raw_string_ostream errStream(err);
+    // Relative paths are resolved against the directory of the client
+    if (::chdir(request.front().c_str())) {
+      errStream << "Failed to change into the working directory '"
+                << request.front() << "' (" << std::strerror(errno) << ")!\n";
+    } else {
+      exitCode = handler(llvm::makeArrayRef(request).drop_front(), outStream,
+                         errStream);
+    }
+  }
+
+  return writeMessage(output, {std::to_string(exitCode), out, err});
+}
+
+/// Creates a Unix domain socket address for the given path
+static bool createAddress(llvm::StringRef path, sockaddr_un& address) {
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(address.sun_path)) {
+    return false;
+  }
+  std::memcpy(address.sun_path, path.data(), path.size());
+  return true;
+}
+#endif // #ifdef LLVM_ON_UNIX
+
+bool serveCompileRequests(llvm::StringRef path, CompileRequestHandler handler,
+                          llvm::raw_ostream& errors) {
+#ifdef LLVM_ON_UNIX
+  // Clients which disconnect early shouldn't terminate the server
+  ::signal(SIGPIPE, SIG_IGN);
+
+  if (path == "-") {
+    while (handleRequest(STDIN_FILENO, STDOUT_FILENO, handler)) {
+    }
+    return true;
+  }
+
+  sockaddr_un address;
+  if (!createAddress(path, address)) {
+    errors << "The socket path '" << path << "' is too long!\n";
+    return false;
+  }
+
+  int const fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    errors << "Failed to create a socket (" << std::strerror(errno) << ")!\n";
+    return false;
+  }
+
+  // Replace the socket of a previous server which wasn't shut down cleanly
+  llvm::sys::fs::remove(path);
+  if (::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) ||
+      ::listen(fd, SOMAXCONN)) {
+    errors << "Failed to listen at '" << path << "' (" << std::strerror(errno)
+           << ")!\n";
+    ::close(fd);
+    return false;
+  }
+  llvm::sys::RemoveFileOnSignal(path);
+
+  for (;;) {
+    int const connection = ::accept(fd, nullptr, nullptr);
+    if (connection < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      errors << "Failed to accept a connection (" << std::strerror(errno)
+             << ")!\n";
+      break;
+    }
+
+    while (handleRequest(connection, connection, handler)) {
+    }
+    ::close(connection);
+  }
+
+  ::close(fd);
+  llvm::sys::fs::remove(path);
+  llvm::sys::DontRemoveFileOnSignal(path);
+  return false;
+#else
+  (void)path;
+  (void)handler;
+  errors << "The compile server is only supported on Unix systems!\n";
+  return false;
+#endif
+}
+
+llvm::Optional<int> forwardCompileRequest(llvm::StringRef path,
+                                          llvm::ArrayRef<std::string> arguments,
+                                          llvm::raw_ostream& output,
+                                          llvm::raw_ostream& errors) {
+#ifdef LLVM_ON_UNIX
+  llvm::SmallString<128> workingDirectory;
+  if (llvm::sys::fs::current_path(workingDirectory)) {
+    return llvm::None;
+  }
+
+  sockaddr_un address;
+  if (!createAddress(path, address)) {
+    return llvm::None;
+  }
+
+  int const fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    return llvm::None;
+  }
+
+  std::vector<std::string> message;
+  message.reserve(arguments.size() + 1);
+  message.push_back(workingDirectory.str());
+  message.insert(message.end(), arguments.begin(), arguments.end());
+
+  std::vector<std::string> response;
+  bool const succeeded =
+      !::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) &&
+      writeMessage(fd, message) && readMessage(fd, response) &&
+      (response.size() == 3);
+  ::close(fd);
+
+  int exitCode;
+  if (!succeeded || llvm::StringRef(response[0]).getAsInteger(10, exitCode)) {
+    return llvm::None;
+  }
+
+  output << response[1];
+  errors << response[2];
+  return exitCode;
+#else
+  (void)path;
+  (void)arguments;
+  (void)output;
+  (void)errors;
+  return llvm::None;
+#endif
+}
@@ -0,0 +1,66 @@
+
+/**
+  Copyright(c) 2016 - 2017 Denis Blank <denis.blank at outlook dot com>
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+**/
+
+#ifndef COMPILE_SERVER_HPP_INCLUDED__
+#define COMPILE_SERVER_HPP_INCLUDED__
+
+#include <string>
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/StringRef.h"
+
+#include "function2/function2.hpp"
+
+namespace llvm {
+class raw_ostream;
+}
+
+/// Handles a compile request with the given command line arguments,
+/// where the output and the errors are written to the given streams.
+/// Returns the exit code of the request.
+using CompileRequestHandler =
+    fu2::function<int(llvm::ArrayRef<std::string> arguments,
+                      llvm::raw_ostream& output, llvm::raw_ostream& errors)>;
+
+/// Serves compile requests sequentially from the same process, so the state
+/// which is initialized once per process is reused across requests.
+///
+/// Requests are received through the Unix domain socket at the given path,
+/// or through the standard input and output when the path is "-".
+/// A request contains the working directory and the command line arguments
+/// of the client, the response contains the exit code, the output and the
+/// errors of the request. Messages are encoded as a count of strings, where
+/// every string is prefixed by its length (u32 little endian each).
+///
+/// Returns false when the server couldn't be started,
+/// which is always the case on non Unix systems.
+bool serveCompileRequests(llvm::StringRef path,
+                          CompileRequestHandler handler,
+                          llvm::raw_ostream& errors);
+
+/// Forwards the given command line arguments together with the current
+/// working directory to the server listening at the given path, and writes
+/// the output and the errors of the request to the given streams.
+/// Returns the exit code of the request or none when the server
+/// couldn't be reached.
+llvm::Optional<int> forwardCompileRequest(llvm::StringRef path,
+                                          llvm::ArrayRef<std::string> arguments,
+                                          llvm::raw_ostream& output,
+                                          llvm::raw_ostream& errors);
+
+#endif // #ifndef COMPILE_SERVER_HPP_INCLUDED__
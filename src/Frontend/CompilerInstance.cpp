@@ -17,21 +17,36 @@
 
 #include "CompilerInstance.hpp"
 
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "llvm/Bitcode/ReaderWriter.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
 #include "llvm/InitializePasses.h"
+#include "llvm/Linker/Linker.h"
 #include "llvm/PassRegistry.h"
 #include "llvm/Support/Host.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetMachine.h"
 
 #include "CompilationUnit.hpp"
 #include "CompilerInvocation.hpp"
+#include "ModuleManager.hpp"
 #include "Nullable.hpp"
 
 /// Creates a target machine from the given targte triple
 static Nullable<llvm::TargetMachine*>
-createTargetMachine(llvm::StringRef triple, bool isNative = false) {
+createTargetMachine(llvm::StringRef triple, llvm::StringRef cpu,
+                    llvm::StringRef features) {
   std::string error;
   auto target = llvm::TargetRegistry::lookupTarget(triple, error);
   if (!target) {
@@ -40,25 +55,35 @@ createTargetMachine(llvm::StringRef triple, bool isNative = false) {
     return {};
   }
 
-  auto cpu = [=]() -> llvm::StringRef {
-    if (isNative) {
-      return llvm::sys::getHostCPUName();
-    } else {
-      return "generic";
-    }
-  }();
-
-  auto features = "";
-
   llvm::TargetOptions opt;
   llvm::Optional<llvm::Reloc::Model> rm;
 
   return target->createTargetMachine(triple, cpu, features, opt, rm);
 }
 
-std::unique_ptr<CompilerInstance>
-CompilerInstance::create(CompilerInvocation const& compilerInvocation) {
+/// Returns the target machine of the given target, which is created only
+/// once per process and shared between all compiler instances.
+static Nullable<llvm::TargetMachine const*>
+getTargetMachine(llvm::StringRef triple, llvm::StringRef cpu,
+                 llvm::StringRef features) {
+  using Key = std::tuple<std::string, std::string, std::string>;
+  static std::mutex mutex;
+  static std::map<Key, std::unique_ptr<llvm::TargetMachine>> machines;
 
+  std::lock_guard<std::mutex> lock(mutex);
+  auto& machine = machines[Key(triple, cpu, features)];
+  if (!machine) {
+    auto created = createTargetMachine(triple, cpu, features);
+    if (!created) {
+      return {};
+    }
+    machine.reset(*created);
+  }
+  return machine.get();
+}
+
+/// Initializes the targets and the PassRegistry of the process
+static void initializeProcess() {
   // Initialize all targets
   llvm::InitializeAllTargetInfos();
   llvm::InitializeAllTargets();
@@ -66,18 +91,6 @@ CompilerInstance::create(CompilerInvocation const& compilerInvocation) {
   llvm::InitializeAllAsmParsers();
   llvm::InitializeAllAsmPrinters();
 
-  // Initialize the target machines
-  auto targetMachine =
-      createTargetMachine(compilerInvocation.getTargetTriple());
-  auto hostMachine =
-      createTargetMachine(compilerInvocation.getTargetTriple(), true);
-  if (!targetMachine || !hostMachine) {
-    return {};
-  }
-
-  std::unique_ptr<CompilerInstance> instance(
-      new CompilerInstance(compilerInvocation, *targetMachine, *hostMachine));
-
   // Initialize the PassRegistry which are basically
   // the same passes opt is doing
 
@@ -104,31 +117,151 @@ CompilerInstance::create(CompilerInvocation const& compilerInvocation) {
   initializeGlobalMergePass(registry);
   initializeInterleavedAccessPass(registry);
   initializeUnreachableBlockElimLegacyPassPass(registry);
+}
+
+CompilerInstance::CompilerInstance(CompilerInvocation const& compilerInvocation,
+                                   llvm::TargetMachine const* targetMachine,
+                                   llvm::TargetMachine const* hostMachine,
+                                   std::shared_ptr<ModuleManager> moduleManager)
+    : compilerInvocation_(std::move(compilerInvocation)),
+      targetMachine_(targetMachine), hostMachine_(hostMachine),
+      moduleManager_(std::move(moduleManager)), outputStream_(&llvm::outs()),
+      errorStream_(&llvm::errs()) {}
+
+CompilerInstance::~CompilerInstance() {}
+
+std::unique_ptr<CompilerInstance>
+CompilerInstance::create(CompilerInvocation const& compilerInvocation,
+                         std::shared_ptr<ModuleManager> moduleManager) {
+  static std::once_flag initialized;
+  std::call_once(initialized, initializeProcess);
+
+  // Initialize the target machines
+  auto targetMachine = getTargetMachine(
+      compilerInvocation.getTargetTriple(), compilerInvocation.getTargetCPU(),
+      compilerInvocation.getTargetFeatures());
+  auto hostMachine = getTargetMachine(compilerInvocation.getTargetTriple(),
+                                      llvm::sys::getHostCPUName(), "");
+  if (!targetMachine || !hostMachine) {
+    return {};
+  }
 
-  return instance;
+  if (!moduleManager) {
+    moduleManager = std::make_shared<ModuleManager>();
+  }
+
+  return std::unique_ptr<CompilerInstance>(
+      new CompilerInstance(compilerInvocation, *targetMachine, *hostMachine,
+                           std::move(moduleManager)));
 }
 
-llvm::ErrorOr<bool /*std::unique_ptr<llvm::Module>*/>
-CompilerInstance::compileSourceFile(std::string path) {
-  auto source = llvm::MemoryBuffer::getFile(path);
-  if (!source) {
-    logError("Didn't find file {}!", path);
-    return llvm::ErrorOr<bool>(source);
+bool CompilerInstance::compileSourceFiles(llvm::ArrayRef<std::string> paths) {
+  // All source files are added to the SourceMgr before the compilation
+  // units are translated, only the sources of imported modules are
+  // added concurrently afterwards.
+  std::vector<std::unique_ptr<CompilationUnit>> units;
+  for (auto const& path : paths) {
+    auto source = llvm::MemoryBuffer::getFile(path);
+    if (!source) {
+      logError("Didn't find file {}!", path);
+      return false;
+    }
+
+    unsigned id = addSourceBuffer(std::move(*source));
+    units.push_back(std::make_unique<CompilationUnit>(this, id, path));
+  }
+
+  // The frontend phases are timed through named timers,
+  // which can't be shared between multiple threads.
+  unsigned threadCount = std::min(compilerInvocation_.getJobCount(),
+                                  unsigned(units.size()));
+  if (compilerInvocation_.hasVerboseFlag(VerboseFlag::PhaseTimes)) {
+    threadCount = 1;
+  }
+  unitThreadCount_ =
+      std::max(std::thread::hardware_concurrency() / threadCount, 1U);
+
+  std::vector<std::unique_ptr<llvm::MemoryBuffer>> bitcodes(units.size());
+  if (threadCount == 1) {
+    for (std::size_t i = 0; i < units.size(); ++i) {
+      bitcodes[i] = units[i]->translate();
+    }
+  } else {
+    llvm::ThreadPool pool(threadCount);
+    for (std::size_t i = 0; i < units.size(); ++i) {
+      pool.async([&, i] { bitcodes[i] = units[i]->translate(); });
+    }
+    pool.wait();
+  }
+
+  auto const succeeded =
+      std::none_of(units.begin(), units.end(), [](auto const& unit) {
+        return unit->getDiagnosticEngine()->hasErrors();
+      });
+
+  // Every compilation unit generates its module inside its own
+  // LLVMContext, so the modules are transferred as bitcode into
+  // a common context where they are linked in the order of the paths.
+  llvm::LLVMContext context;
+  std::unique_ptr<llvm::Module> linked;
+  for (auto const& bitcode : bitcodes) {
+    if (!bitcode) {
+      continue;
+    }
+
+    auto name = bitcode->getBufferIdentifier().str();
+    auto module = llvm::parseBitcodeFile(bitcode->getMemBufferRef(), context);
+    if (!module) {
+      logError("Failed to read the module of {}: {}", name,
+               module.getError().message());
+      return false;
+    }
+
+    if (!linked) {
+      linked = std::move(*module);
+    } else if (llvm::Linker::linkModules(*linked, std::move(*module))) {
+      logError("Failed to link the module of {}!", name);
+      return false;
+    }
   }
 
-  unsigned id = sourceMgr.AddNewSourceBuffer(std::move(*source), {});
+  if (linked) {
+    linked->print(getOutputStream(), nullptr);
+  }
+  return succeeded;
+}
+
+unsigned
+CompilerInstance::addSourceBuffer(std::unique_ptr<llvm::MemoryBuffer> buffer) {
+  auto lock = lockOutput();
+  return sourceMgr.AddNewSourceBuffer(std::move(buffer), {});
+}
 
-  CompilationUnit compilationUnit(this, id, path);
+llvm::StringRef CompilerInstance::getSourceBuffer(unsigned id) {
+  auto lock = lockOutput();
+  return sourceMgr.getMemoryBuffer(id)->getBuffer();
+}
 
-  compilationUnit.translate();
+unsigned CompilerInstance::addModuleSource(llvm::MemoryBuffer const& source) {
+  auto lock = lockOutput();
+  auto itr = moduleSources_.find(source.getBufferStart());
+  if (itr != moduleSources_.end()) {
+    return itr->second;
+  }
 
-  return {false};
+  auto const id = sourceMgr.AddNewSourceBuffer(
+      llvm::MemoryBuffer::getMemBuffer(source.getMemBufferRef(),
+                                       /*RequiresNullTerminator*/ false),
+      {});
+  moduleSources_.emplace(source.getBufferStart(), id);
+  return id;
 }
 
 static llvm::StringRef const severities[] = {"INFO   ", "WARNING", "ERROR  "};
 
 void CompilerInstance::logSeverity(Severity /*severity*/, llvm::StringRef msg) {
-  llvm::outs() /*<< '[' << severities[unsigned(severity)] << "] "*/ << msg
-                                                                    << "\n";
-  llvm::outs().flush();
+  auto lock = lockOutput();
+  getOutputStream() /*<< '[' << severities[unsigned(severity)] << "] "*/
+      << msg << "\n";
+  getOutputStream().flush();
 }
@@ -19,7 +19,11 @@
 #define COMPILER_INSTANCE_HPP_INCLUDED__
 
 #include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/Support/SourceMgr.h"
 
 #include "CompilerInvocation.hpp"
@@ -27,27 +31,47 @@
 #include "Formatting.hpp"
 
 namespace llvm {
+class MemoryBuffer;
 class TargetMachine;
+class raw_ostream;
 }
 
+class ModuleManager;
+
 /// Represents an instance of the compiler
 class CompilerInstance {
   CompilerInvocation compilerInvocation_;
   llvm::SourceMgr sourceMgr;
+  /// Guards the SourceMgr and the output streams
+  std::mutex outputMutex_;
   llvm::TargetMachine const* targetMachine_;
   llvm::TargetMachine const* hostMachine_;
+  /// The count of threads a single compilation unit can use
+  unsigned unitThreadCount_ = 1;
+  std::shared_ptr<ModuleManager> moduleManager_;
+  /// The sources of imported modules which were added to the SourceMgr
+  std::unordered_map<char const*, unsigned> moduleSources_;
+  llvm::raw_ostream* outputStream_;
+  llvm::raw_ostream* errorStream_;
 
   explicit CompilerInstance(CompilerInvocation const& compilerInvocation,
                             llvm::TargetMachine const* targetMachine,
-                            llvm::TargetMachine const* hostMachine)
-      : compilerInvocation_(std::move(compilerInvocation)),
-        targetMachine_(targetMachine), hostMachine_(hostMachine) {}
+                            llvm::TargetMachine const* hostMachine,
+                            std::shared_ptr<ModuleManager> moduleManager);
 
 public:
+  ~CompilerInstance();
+
   /// Creates and initializes a compiler instance with the given
   /// CompilerInvocation. The result might be empty.
+  ///
+  /// The targets are initialized only once per process and target machines
+  /// are shared between instances with the same target options.
+  /// Imported modules are shared with other instances when a ModuleManager
+  /// is given, otherwise the instance creates its own one.
   static std::unique_ptr<CompilerInstance>
-  create(CompilerInvocation const& compilerInvocation);
+  create(CompilerInvocation const& compilerInvocation,
+         std::shared_ptr<ModuleManager> moduleManager = nullptr);
 
   /// Returns the compiler invocation which contains runtime options
   CompilerInvocation const* getInvocation() const {
@@ -56,7 +80,45 @@ public:
 
   llvm::SourceMgr const& getSourceMgr() const { return sourceMgr; }
 
-  llvm::ErrorOr<bool /*todo*/> compileSourceFile(std::string path);
+  /// Adds the given buffer to the SourceMgr and returns its id,
+  /// which is thread safe since imported modules are added while
+  /// compilation units are translated.
+  unsigned addSourceBuffer(std::unique_ptr<llvm::MemoryBuffer> buffer);
+  /// Returns the contents of the buffer with the given id in the SourceMgr
+  llvm::StringRef getSourceBuffer(unsigned id);
+  /// Adds the source of an imported module to the SourceMgr without taking
+  /// its ownership, so diagnostics can refer to it. The source is added
+  /// only once and its id is returned.
+  unsigned addModuleSource(llvm::MemoryBuffer const& source);
+
+  /// Returns the manager of the modules imported by compilation units
+  ModuleManager* getModuleManager() { return moduleManager_.get(); }
+
+  /// Redirects the output and the errors of the instance to the given
+  /// streams, which default to the standard streams of the process.
+  void setOutputStreams(llvm::raw_ostream& outputStream,
+                        llvm::raw_ostream& errorStream) {
+    outputStream_ = &outputStream;
+    errorStream_ = &errorStream;
+  }
+  /// Returns the stream results like the generated module are printed to
+  llvm::raw_ostream& getOutputStream() { return *outputStream_; }
+  /// Returns the stream diagnostics are printed to
+  llvm::raw_ostream& getErrorStream() { return *errorStream_; }
+
+  /// Locks the SourceMgr and the output streams for the calling thread,
+  /// which is required since compilation units are translated in parallel.
+  std::unique_lock<std::mutex> lockOutput() {
+    return std::unique_lock<std::mutex>(outputMutex_);
+  }
+
+  /// Compiles the given source files in parallel and prints the generated
+  /// modules linked into a single module.
+  /// Returns true when all source files were compiled successfully.
+  bool compileSourceFiles(llvm::ArrayRef<std::string> paths);
+
+  /// Returns the count of threads a single compilation unit can use
+  unsigned getUnitThreadCount() const { return unitThreadCount_; }
 
   /// Returns the target machine we are generating code for
   llvm::TargetMachine const* getTargetMachine() const { return targetMachine_; }
@@ -17,10 +17,26 @@
 
 #include "CompilerInvocation.hpp"
 
+#include <algorithm>
+#include <thread>
+#include <tuple>
 #include <utility>
 
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Host.h"
 
+bool CompilerInvocation::operator==(CompilerInvocation const& right) const {
+  auto const tie = [](CompilerInvocation const& invocation) {
+    return std::tie(invocation.emitAction_, invocation.parserKind_,
+                    invocation.optLevel_, invocation.verboseFlags_,
+                    invocation.jobCount_, invocation.targetTriple_,
+                    invocation.targetCPU_, invocation.targetFeatures_,
+                    invocation.cacheDirectory_);
+  };
+  return tie(*this) == tie(right);
+}
+
 void CompilerInvocation::setVerboseFlags(Bitset verboseFlags) {
   verboseFlags_ = verboseFlags;
   if (verboseFlags_[unsigned(VerboseFlag::All)]) {
@@ -29,6 +45,13 @@ void CompilerInvocation::setVerboseFlags(Bitset verboseFlags) {
   }
 }
 
+void CompilerInvocation::setJobCount(unsigned jobCount) {
+  if (jobCount == 0) {
+    jobCount = std::max(std::thread::hardware_concurrency(), 1U);
+  }
+  jobCount_ = jobCount;
+}
+
 void CompilerInvocation::setTargetTriple(std::string targetTriple) {
   targetTriple_ = std::move(targetTriple);
 }
@@ -37,6 +60,51 @@ std::string CompilerInvocation::getTargetTriple() const {
   return targetTriple_;
 }
 
+void CompilerInvocation::setTargetCPU(std::string targetCPU) {
+  targetCPU_ = std::move(targetCPU);
+}
+
+std::string CompilerInvocation::getTargetCPU() const { return targetCPU_; }
+
+void CompilerInvocation::setTargetFeatures(std::string targetFeatures) {
+  targetFeatures_ = std::move(targetFeatures);
+}
+
+std::string CompilerInvocation::getTargetFeatures() const {
+  return targetFeatures_;
+}
+
+void CompilerInvocation::setTargetToHost() {
+  targetCPU_ = llvm::sys::getHostCPUName();
+
+  // Translate the host features into the target feature syntax,
+  // features which are already set explicitly take precedence.
+  llvm::StringMap<bool> hostFeatures;
+  if (llvm::sys::getHostCPUFeatures(hostFeatures)) {
+    std::string features;
+    for (auto const& feature : hostFeatures) {
+      if (!features.empty()) {
+        features += ',';
+      }
+      features += feature.getValue() ? '+' : '-';
+      features += feature.getKey();
+    }
+    if (!targetFeatures_.empty()) {
+      features += ',';
+      features += targetFeatures_;
+    }
+    targetFeatures_ = std::move(features);
+  }
+}
+
+void CompilerInvocation::setCacheDirectory(std::string cacheDirectory) {
+  cacheDirectory_ = std::move(cacheDirectory);
+}
+
+std::string CompilerInvocation::getCacheDirectory() const {
+  return cacheDirectory_;
+}
+
 std::string CompilerInvocation::getDefaultTargetTriple() {
   return llvm::sys::getDefaultTargetTriple();
 }
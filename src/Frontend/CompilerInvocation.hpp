@@ -30,7 +30,15 @@ enum class EmitAction {
   EmitTokens,     ///< Print the result of the Lexer
   EmitFlatLayout, ///< Print the result of the source Parser
   EmitLayout,     ///< Print the structured result of the source parser
-  EmitAST         ///< Print the parsed AST
+  EmitAST,        ///< Print the parsed AST
+  EmitModule      ///< Write the precompiled module of the source file
+};
+
+/// Represents the parser which is used for creating the AST layout
+enum class ParserKind {
+  Descent,    ///< The hand-written recursive descent parser
+  Generated,  ///< The parser which is generated from the ANTLR grammar
+  GeneratedLL ///< The generated parser using the full LL prediction only
 };
 
 /// Represents the optimizations which are applied to runtime code
@@ -48,7 +56,9 @@ enum class VerboseFlag {
   Instantiations,     ///< Prints all meta decl instantiations
   InstantiatedLayout, ///< Prints the AST layout of performed instantiations
   InstantiatedAST,    ///< Prints the parsed AST of performed instantiations
-  InstantiatedExports ///< Prints the exported value of instantiations
+  InstantiatedExports, ///< Prints the exported value of instantiations
+  PhaseTimes,          ///< Prints the time spent in each frontend phase
+  ASTStatistics        ///< Prints the memory allocated for each AST node kind
 };
 
 /// Represents the a single compiler invocation
@@ -57,19 +67,33 @@ class CompilerInvocation {
   using Bitset = std::bitset<sizeof(unsigned) * 8>;
 
   EmitAction emitAction_ = EmitAction::EmitNone;
+  ParserKind parserKind_ = ParserKind::Descent;
   OptLevel optLevel_ = OptLevel::Debug;
   Bitset verboseFlags_;
+  unsigned jobCount_ = 1;
 
   static std::string getDefaultTargetTriple();
   std::string targetTriple_ = getDefaultTargetTriple();
+  std::string targetCPU_ = "generic";
+  std::string targetFeatures_;
+  std::string cacheDirectory_;
 
 public:
   CompilerInvocation() = default;
 
+  bool operator==(CompilerInvocation const& right) const;
+  bool operator!=(CompilerInvocation const& right) const {
+    return !(*this == right);
+  }
+
   void setEmitAction(EmitAction action) { emitAction_ = action; }
   /// Returns true when the invocation has the given emit action
   bool hasEmitAction(EmitAction action) const { return emitAction_ == action; }
 
+  void setParserKind(ParserKind parserKind) { parserKind_ = parserKind; }
+  /// Returns the parser which is used for parsing source files
+  ParserKind getParserKind() const { return parserKind_; }
+
   void setOptLevel(OptLevel optLevel) { optLevel_ = optLevel; }
   /// Returns the optimization level which is set for the invocation
   OptLevel getOptLevel() const { return optLevel_; }
@@ -80,10 +104,36 @@ public:
     return verboseFlags_[unsigned(verboseFlags)];
   }
 
+  /// Sets the count of source files which are compiled in parallel,
+  /// where zero selects the count of hardware threads.
+  void setJobCount(unsigned jobCount);
+  /// Returns the count of source files which are compiled in parallel
+  unsigned getJobCount() const { return jobCount_; }
+
   /// Sets the target triple we are producing code
   void setTargetTriple(std::string targetTriple);
   /// Returns the target triple we are producing code for
   std::string getTargetTriple() const;
+
+  /// Sets the target cpu we are producing code for
+  void setTargetCPU(std::string targetCPU);
+  /// Returns the target cpu we are producing code for
+  std::string getTargetCPU() const;
+
+  /// Sets the comma separated target features (`+avx2,-sse4a`)
+  void setTargetFeatures(std::string targetFeatures);
+  /// Returns the comma separated target features
+  std::string getTargetFeatures() const;
+
+  /// Sets the target cpu and features to the ones of the host
+  /// the compiler is running on (`-march=native`).
+  void setTargetToHost();
+
+  /// Sets the directory the generated functions are cached in,
+  /// where an empty directory disables the cache.
+  void setCacheDirectory(std::string cacheDirectory);
+  /// Returns the directory the generated functions are cached in
+  std::string getCacheDirectory() const;
 };
 
 #endif // #ifndef COMPILER_INVOCATION_HPP_INCLUDED__
@@ -15,6 +15,11 @@
   limitations under the License.
 **/
 
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "llvm/ADT/Optional.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Config/llvm-config.h"
 #include "llvm/Support/ManagedStatic.h"
@@ -23,16 +28,23 @@
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/raw_ostream.h"
 
+#include "AnalysisService.hpp"
+#include "CompileServer.hpp"
 #include "CompilerInstance.hpp"
 #include "CompilerInvocation.hpp"
 #include "Formatting.hpp"
+#include "ModuleManager.hpp"
+#include "Symbol.hpp"
 
 using namespace llvm;
 
 static cl::OptionCategory toolingOptionCat("Tooling Options");
 
+// Options which are parsed for every request of a compile server are
+// required to have an initial value, which restores them between requests.
 static cl::opt<EmitAction> emitAction(
     cl::desc("Choose the emit action:"), cl::cat(toolingOptionCat),
+    cl::init(EmitAction::EmitNone),
     cl::values(
         clEnumValN(EmitAction::EmitTokens, "emit-tokens",
                    "Emits the tokens after lexing and exits"),
@@ -43,8 +55,27 @@ static cl::opt<EmitAction> emitAction(
                    "Emits the layout after parsing and exits"),
         clEnumValN(EmitAction::EmitAST, "emit-ast",
                    "Emits the AST after layouting and exits"),
+        clEnumValN(EmitAction::EmitModule, "emit-module",
+                   "Writes the module of the source file and exits"),
         clEnumValEnd));
 
+static cl::opt<ParserKind> parserKind(
+    "parser", cl::desc("Choose the parser for source files:"),
+    cl::init(ParserKind::Descent), cl::cat(toolingOptionCat),
+    cl::values(clEnumValN(ParserKind::Descent, "descent",
+                          "Use the recursive descent parser (default)"),
+               clEnumValN(ParserKind::Generated, "generated",
+                          "Use the parser generated from the grammar"),
+               clEnumValN(ParserKind::GeneratedLL, "generated-ll",
+                          "Use the generated parser without trying the "
+                          "faster SLL prediction first"),
+               clEnumValEnd));
+
+static cl::opt<bool> analyzeOnly(
+    "analyze", cl::cat(toolingOptionCat), cl::init(false),
+    cl::desc("Checks the source files for errors without generating code, "
+             "a compile server analyzes only the changed declarations"));
+
 static cl::OptionCategory optimizationOptionCat("Optimization Options");
 
 static cl::opt<OptLevel> optLevel(
@@ -57,10 +88,30 @@ static cl::opt<OptLevel> optLevel(
         clEnumValN(OptLevel::O3, "O3", "Perform expensive optimizations"),
         clEnumValEnd));
 
+static cl::opt<std::string>
+    targetCPU("mcpu", cl::cat(optimizationOptionCat),
+              cl::desc("Target a specific cpu type (-mcpu=help for details)"),
+              cl::value_desc("cpu-name"), cl::init("generic"));
+
+static cl::opt<std::string>
+    targetFeatures("mattr", cl::cat(optimizationOptionCat),
+                   cl::desc("Target specific attributes (+avx2,-sse4a)"),
+                   cl::value_desc("a1,+a2,-a3,..."), cl::init(""));
+
+static cl::opt<std::string>
+    targetArch("march", cl::cat(optimizationOptionCat),
+               cl::desc("Target the given cpu or the host cpu "
+                        "and it's features through -march=native"),
+               cl::value_desc("cpu-name|native"), cl::init(""));
+
 static cl::OptionCategory debuggingOptionCat("Debugging Options");
 
-static cl::bits<VerboseFlag> verboseFlags(
+/// The storage of the verbose flags, which are cleared between requests
+static unsigned verboseFlagBits = 0;
+
+static cl::bits<VerboseFlag, unsigned> verboseFlags(
     cl::desc("Available verbose flags:"), cl::cat(debuggingOptionCat),
+    cl::location(verboseFlagBits),
     cl::values(clEnumValN(VerboseFlag::All, "verbose",
                           "Prints all all verbose messages"),
                clEnumValN(VerboseFlag::Shipments, "vshipments",
@@ -73,14 +124,174 @@ static cl::bits<VerboseFlag> verboseFlags(
                           "Prints the parsed AST of performed instantiations"),
                clEnumValN(VerboseFlag::InstantiatedExports, "vinst-exports",
                           "Prints the exported values of instantiations"),
+               clEnumValN(VerboseFlag::PhaseTimes, "vtime",
+                          "Prints the time spent in each frontend phase"),
+               clEnumValN(VerboseFlag::ASTStatistics, "print-ast-stats",
+                          "Prints the memory allocated for each AST node kind"),
                clEnumValEnd));
 
-static cl::opt<std::string>
-    inputFilename(cl::Positional, cl::init(SOURCE_DIRECTORY "/lang/main.swy"),
-                  cl::desc("<input file>"));
+static cl::OptionCategory schedulingOptionCat("Scheduling Options");
+
+static cl::opt<unsigned>
+    jobCount("j", cl::cat(schedulingOptionCat), cl::init(0),
+             cl::desc("Translate the given count of source files in parallel "
+                      "(defaults to the count of hardware threads)"),
+             cl::value_desc("count"));
+
+static cl::opt<std::string> cacheDirectory(
+    "cache-dir", cl::cat(schedulingOptionCat),
+    cl::desc("Reuse the generated functions which are cached in the given "
+             "directory when their declarations didn't change"),
+    cl::value_desc("directory"), cl::init(""));
+
+static cl::opt<std::string> servePath(
+    "serve", cl::cat(schedulingOptionCat),
+    cl::desc("Keep the compiler alive and serve the compile requests received "
+             "through the given socket, or through stdin when it's '-'"),
+    cl::value_desc("socket"));
+
+static cl::opt<std::string> connectPath(
+    "connect", cl::cat(schedulingOptionCat),
+    cl::desc("Forward the compilation to the compiler serving at the "
+             "given socket"),
+    cl::value_desc("socket"));
+
+static cl::list<std::string> inputFilenames(cl::Positional,
+                                            cl::desc("<input files>"));
 
 void testsmth();
 
+/// Creates the invocation from the parsed command line options,
+/// conflicting options are reported to the given stream.
+static Optional<CompilerInvocation> createInvocation(raw_ostream& errors) {
+  if (!targetArch.getValue().empty() && targetCPU.getNumOccurrences()) {
+    errors << "The cpu can't be selected through both -march and -mcpu!\n";
+    return None;
+  }
+
+  CompilerInvocation invocation;
+  invocation.setEmitAction(emitAction.getValue());
+  invocation.setParserKind(parserKind.getValue());
+  invocation.setOptLevel(optLevel.getValue());
+  invocation.setVerboseFlags(verboseFlags.getBits());
+  invocation.setJobCount(jobCount.getValue());
+  invocation.setCacheDirectory(cacheDirectory.getValue());
+  invocation.setTargetCPU(targetCPU.getValue());
+  invocation.setTargetFeatures(targetFeatures.getValue());
+  if (targetArch.getValue() == "native") {
+    invocation.setTargetToHost();
+  } else if (!targetArch.getValue().empty()) {
+    invocation.setTargetCPU(targetArch.getValue());
+  }
+  return invocation;
+}
+
+/// Returns the input files from the parsed command line options
+static std::vector<std::string> inputPaths() {
+  std::vector<std::string> paths(inputFilenames.begin(),
+                                 inputFilenames.end());
+  if (paths.empty()) {
+    paths.push_back(SOURCE_DIRECTORY "/lang/main.swy");
+  }
+  return paths;
+}
+
+/// Compiles the input files with the parsed command line options
+static bool compile(std::shared_ptr<ModuleManager> moduleManager,
+                    raw_ostream& output, raw_ostream& errors) {
+  auto const paths = inputPaths();
+
+  auto invocation = createInvocation(errors);
+  if (!invocation) {
+    return false;
+  }
+
+  // Start the compiler instance
+  auto compiler =
+      CompilerInstance::create(*invocation, std::move(moduleManager));
+  if (!compiler) {
+    return false;
+  }
+
+  // testJit();
+  compiler->setOutputStreams(output, errors);
+  return compiler->compileSourceFiles(paths);
+}
+
+/// Checks the input files with the parsed command line options
+static bool analyze(AnalysisService& analysisService, raw_ostream& output,
+                    raw_ostream& errors) {
+  auto invocation = createInvocation(errors);
+  if (!invocation) {
+    return false;
+  }
+  return analysisService.analyzeSourceFiles(*invocation, inputPaths(), output,
+                                            errors);
+}
+
+/// Restores all options before the command line of a request is parsed,
+/// since the occurrences of options are reset only.
+static void resetOptions() {
+  cl::ResetAllOptionOccurrences();
+  verboseFlagBits = 0;
+  inputFilenames.clear();
+}
+
+/// The count of interned symbols the server retains across requests
+static std::size_t const MaxRetainedSymbols = std::size_t(1U) << 22U;
+
+/// Serves compile requests until the server is terminated,
+/// the targets and the modules stay initialized between requests.
+static bool serve(llvm::StringRef program) {
+  std::string const path = servePath.getValue();
+  auto moduleManager = std::make_shared<ModuleManager>();
+  AnalysisService analysisService;
+
+  return serveCompileRequests(
+      path,
+      [&](ArrayRef<std::string> arguments, raw_ostream& output,
+          raw_ostream& errors) {
+        // The arguments were validated by the client already
+        std::vector<char const*> argv{program.data()};
+        for (auto const& argument : arguments) {
+          argv.push_back(argument.c_str());
+        }
+        resetOptions();
+        cl::ParseCommandLineOptions(int(argv.size()), argv.data());
+
+        // The modules and the analysis sessions keep the symbols of
+        // previous requests alive, thus all of them start over when the
+        // symbol table grew too large.
+        if (Symbol::getInternedCount() > MaxRetainedSymbols) {
+          moduleManager = std::make_shared<ModuleManager>();
+          analysisService.clear();
+          Symbol::clearInterned();
+        }
+
+        if (analyzeOnly) {
+          return analyze(analysisService, output, errors) ? 0 : 1;
+        }
+        moduleManager->dropOutdated();
+        return compile(moduleManager, output, errors) ? 0 : 1;
+      },
+      errs());
+}
+
+/// Forwards the command line to the compile server
+static int forward(int argc, char const* argv[]) {
+  // The command line was parsed locally before, so invalid arguments
+  // are reported by the client and never terminate the server.
+  std::vector<std::string> arguments(argv + 1, argv + argc);
+  auto exitCode = forwardCompileRequest(connectPath.getValue(), arguments,
+                                        outs(), errs());
+  if (!exitCode) {
+    errs() << "Failed to reach the compile server at '"
+           << connectPath.getValue() << "'!\n";
+    return 1;
+  }
+  return *exitCode;
+}
+
 int main(int argc, char const* argv[]) {
   llvm::sys::PrintStackTraceOnErrorSignal(argv[0]);
   llvm::PrettyStackTraceProgram prettyStackTrace(argc, argv);
@@ -97,18 +308,18 @@ int main(int argc, char const* argv[]) {
 
   llvm::cl::ParseCommandLineOptions(argc, argv);
 
-  // Set up the invocation
-  CompilerInvocation invocation;
-  invocation.setEmitAction(emitAction.getValue());
-  invocation.setOptLevel(optLevel.getValue());
-  invocation.setVerboseFlags(verboseFlags.getBits());
-
-  // Start the compiler instance
-  if (auto compiler = CompilerInstance::create(invocation)) {
-    // testJit();
-    auto module = compiler->compileSourceFile(inputFilename.getValue());
+  int exitCode;
+  if (!connectPath.empty()) {
+    exitCode = forward(argc, argv);
+  } else if (!servePath.empty()) {
+    exitCode = serve(argv[0]) ? 0 : 1;
+  } else if (analyzeOnly) {
+    AnalysisService analysisService;
+    exitCode = analyze(analysisService, outs(), errs()) ? 0 : 1;
+  } else {
+    exitCode = compile(nullptr, outs(), errs()) ? 0 : 1;
   }
 
   llvm::llvm_shutdown();
-  return 0;
+  return exitCode;
 }
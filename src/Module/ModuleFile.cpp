@@ -0,0 +1,135 @@
+
+/**
+  Copyright(c) 2016 - 2017 Denis Blank <denis.blank at outlook dot com>
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+**/
+
+#include "ModuleFile.hpp"
+
+#include <cassert>
+
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+constexpr char ModuleFile::Magic[4];
+constexpr std::uint32_t ModuleFile::Version;
+constexpr std::size_t ModuleFile::HeaderSize;
+constexpr std::size_t ModuleFile::ImportEntrySize;
+constexpr std::size_t ModuleFile::DeclEntrySize;
+constexpr std::uint32_t ModuleFile::InvalidLocation;
+
+using llvm::support::endian::read32le;
+using llvm::support::endian::read64le;
+
+llvm::Optional<SourceStamp> SourceStamp::of(llvm::StringRef path) {
+  llvm::sys::fs::file_status status;
+  if (llvm::sys::fs::status(path, status) ||
+      !llvm::sys::fs::is_regular_file(status)) {
+    return llvm::None;
+  }
+  return SourceStamp{status.getSize(),
+                     status.getLastModificationTime().toEpochTime()};
+}
+
+ModuleFile::ModuleFile(std::unique_ptr<llvm::MemoryBuffer> buffer,
+                       SourceStamp stamp)
+    : buffer_(std::move(buffer)), stamp_(stamp) {}
+
+ModuleFile::~ModuleFile() {}
+
+std::unique_ptr<ModuleFile>
+ModuleFile::open(std::unique_ptr<llvm::MemoryBuffer> buffer) {
+  auto const data = buffer->getBuffer();
+  if ((data.size() < HeaderSize) ||
+      !data.startswith(llvm::StringRef(Magic, sizeof(Magic))) ||
+      (read32le(data.data() + 4) != Version)) {
+    return nullptr;
+  }
+
+  SourceStamp const stamp{read64le(data.data() + 8),
+                          read64le(data.data() + 16)};
+  std::unique_ptr<ModuleFile> module(new ModuleFile(std::move(buffer), stamp));
+  module->importCount_ = read32le(data.data() + 24);
+  module->declCount_ = read32le(data.data() + 28);
+  std::uint64_t const stringsSize = read32le(data.data() + 32);
+  std::uint64_t const recordsSize = read32le(data.data() + 36);
+
+  // Only the sizes of the tables are validated here, so opening a module
+  // doesn't depend on its size. The entries are trusted since module files
+  // are only written by the compiler.
+  std::uint64_t const importsSize = module->importCount_ * ImportEntrySize;
+  std::uint64_t const declsSize = module->declCount_ * DeclEntrySize;
+  if (HeaderSize + importsSize + declsSize + stringsSize + recordsSize !=
+      data.size()) {
+    return nullptr;
+  }
+
+  module->imports_ = data.data() + HeaderSize;
+  module->decls_ = module->imports_ + importsSize;
+  module->strings_ = data.substr(HeaderSize + importsSize + declsSize,
+                                 stringsSize);
+  module->records_ = data.substr(
+      HeaderSize + importsSize + declsSize + stringsSize, recordsSize);
+  return module;
+}
+
+llvm::StringRef ModuleFile::getImportPath(std::size_t index) const {
+  assert((index < importCount_) && "The import index is out of range!");
+  auto const entry = imports_ + index * ImportEntrySize;
+  return getString(read32le(entry), read32le(entry + 4));
+}
+
+llvm::StringRef ModuleFile::getDeclName(std::size_t index) const {
+  assert((index < declCount_) && "The decl index is out of range!");
+  auto const entry = decls_ + index * DeclEntrySize;
+  return getString(read32le(entry), read32le(entry + 4));
+}
+
+llvm::StringRef ModuleFile::getDeclRecords(std::size_t index) const {
+  assert((index < declCount_) && "The decl index is out of range!");
+  auto const entry = decls_ + index * DeclEntrySize;
+  auto const begin = read32le(entry + 8);
+  auto const end = read32le(entry + 12);
+  assert((begin <= end) && (end <= records_.size()) &&
+         "The records of the declaration are out of range!");
+  return records_.slice(begin, end);
+}
+
+llvm::Optional<std::size_t> ModuleFile::findDecl(llvm::StringRef name) const {
+  // The declarations are sorted by their names
+  std::size_t first = 0;
+  std::size_t count = declCount_;
+  while (count > 0) {
+    auto const step = count / 2;
+    if (getDeclName(first + step) < name) {
+      first += step + 1;
+      count -= step + 1;
+    } else {
+      count = step;
+    }
+  }
+
+  if ((first < declCount_) && (getDeclName(first) == name)) {
+    return first;
+  }
+  return llvm::None;
+}
+
+llvm::StringRef ModuleFile::getString(std::uint32_t offset,
+                                      std::uint32_t length) const {
+  assert((std::uint64_t(offset) + length <= strings_.size()) &&
+         "The string is out of the range of the string table!");
+  return strings_.substr(offset, length);
+}
@@ -0,0 +1,144 @@
+
+/**
+  Copyright(c) 2016 - 2017 Denis Blank <denis.blank at outlook dot com>
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+**/
+
+#ifndef MODULE_FILE_HPP_INCLUDED__
+#define MODULE_FILE_HPP_INCLUDED__
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+
+namespace llvm {
+class MemoryBuffer;
+}
+
+/// Identifies the state of a source file a module was built from,
+/// the module is outdated when the stamp of the source file changed.
+struct SourceStamp {
+  std::uint64_t size;
+  std::uint64_t modificationTime;
+
+  /// Returns the stamp of the given file if it exists
+  static llvm::Optional<SourceStamp> of(llvm::StringRef path);
+
+  bool operator==(SourceStamp const& right) const {
+    return (size == right.size) && (modificationTime == right.modificationTime);
+  }
+  bool operator!=(SourceStamp const& right) const { return !(*this == right); }
+};
+
+/// Represents a precompiled module which contains the serialized
+/// top level declarations of a source file.
+///
+/// The module file is laid out as following, where all integers are
+/// stored in little endian:
+/// - header: the magic "SWYM", the version (u32), the SourceStamp
+///           (u64, u64), the count of imports and declarations and the
+///           size of the string table and the records (u32 each).
+/// - imports: the absolute paths of the imported source files, stored as
+///            offset and length into the string table (u32, u32).
+/// - decls: the names of the declarations stored as offset and length into
+///          the string table, followed by the begin and the end of their
+///          records (u32 each), sorted by their names.
+/// - the string table
+/// - records: the ASTLayout of every declaration, where every node is
+///            stored through its kind incremented by one followed by the
+///            data required to construct it. Reduce markers are stored as 0.
+///
+/// The file is mapped into memory, so opening a module doesn't depend on
+/// its size, declarations are only deserialized when they are looked up.
+class ModuleFile {
+  std::unique_ptr<llvm::MemoryBuffer> buffer_;
+  SourceStamp stamp_;
+  std::uint32_t importCount_;
+  std::uint32_t declCount_;
+  char const* imports_;
+  char const* decls_;
+  llvm::StringRef strings_;
+  llvm::StringRef records_;
+
+  /// The source file the module was built from, which is referenced
+  /// by the source locations of the declarations.
+  llvm::StringRef source_;
+  /// The modules which are imported by this module
+  llvm::SmallVector<ModuleFile const*, 4> importedModules_;
+
+  ModuleFile(std::unique_ptr<llvm::MemoryBuffer> buffer, SourceStamp stamp);
+
+public:
+  ~ModuleFile();
+
+  /// The magic which identifies module files
+  static constexpr char Magic[4] = {'S', 'W', 'Y', 'M'};
+  /// The version of the module file format, which is increased on
+  /// every change of the format or of the kinds of ASTNodes.
+  static constexpr std::uint32_t Version = 1;
+  /// The size of the header of module files
+  static constexpr std::size_t HeaderSize = 40;
+  /// The size of an entry in the import table
+  static constexpr std::size_t ImportEntrySize = 8;
+  /// The size of an entry in the decl table
+  static constexpr std::size_t DeclEntrySize = 16;
+  /// Represents an absent source location in the records
+  static constexpr std::uint32_t InvalidLocation = 0xFFFFFFFF;
+
+  /// Opens the module contained in the given buffer,
+  /// returns null when the buffer doesn't contain a valid module.
+  static std::unique_ptr<ModuleFile>
+  open(std::unique_ptr<llvm::MemoryBuffer> buffer);
+
+  /// Returns the stamp of the source file the module was built from
+  SourceStamp const& getSourceStamp() const { return stamp_; }
+
+  /// Returns the count of imports of the module
+  std::size_t getImportCount() const { return importCount_; }
+  /// Returns the absolute path of the imported source file at the index
+  llvm::StringRef getImportPath(std::size_t index) const;
+
+  /// Returns the count of top level declarations of the module
+  std::size_t getDeclCount() const { return declCount_; }
+  /// Returns the name of the declaration at the given index
+  llvm::StringRef getDeclName(std::size_t index) const;
+  /// Returns the records of the declaration at the given index
+  llvm::StringRef getDeclRecords(std::size_t index) const;
+  /// Returns the index of the declaration with the given name
+  llvm::Optional<std::size_t> findDecl(llvm::StringRef name) const;
+
+  /// Returns the string of the string table at the given offset
+  llvm::StringRef getString(std::uint32_t offset, std::uint32_t length) const;
+
+  /// Sets the source file the module was built from
+  void setSource(llvm::StringRef source) { source_ = source; }
+  /// Returns the source file the module was built from
+  llvm::StringRef getSource() const { return source_; }
+
+  /// Adds a module which is imported by this module
+  void addImportedModule(ModuleFile const* module) {
+    importedModules_.push_back(module);
+  }
+  /// Returns the modules which are imported by this module
+  llvm::ArrayRef<ModuleFile const*> getImportedModules() const {
+    return importedModules_;
+  }
+};
+
+#endif // #ifndef MODULE_FILE_HPP_INCLUDED__
@@ -0,0 +1,284 @@
+
+/**
+  Copyright(c) 2016 - 2017 Denis Blank <denis.blank at outlook dot com>
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+**/
+
+#include "ModuleLoader.hpp"
+
+#include <cassert>
+#include <mutex>
+#include <string>
+#include <tuple>
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/ErrorHandling.h"
+
+#include "AST.hpp"
+#include "ASTContext.hpp"
+#include "ASTLayout.hpp"
+#include "ASTTraversal.hpp"
+#include "CompilationUnit.hpp"
+#include "CompilerInstance.hpp"
+#include "ModuleFile.hpp"
+#include "ModuleManager.hpp"
+#include "ModuleReader.hpp"
+#include "SimilarityIndex.hpp"
+
+/// The consistent scope of a single module,
+/// which deserializes its declarations on their first lookup.
+class ModuleASTScope : public ConsistentASTScope {
+  CompilationUnit* compilationUnit_;
+  ASTContext* astContext_;
+  ModuleFile const* module_;
+  llvm::Optional<ConsistentASTScope const*> parent_;
+  /// The mutex of the loader which guards the deserialization
+  std::recursive_mutex* mutex_;
+  /// The unit which contains the deserialized declarations
+  CompilationUnitASTNode* unit_;
+  /// The declarations which were deserialized already
+  mutable llvm::DenseMap<Symbol, NamedDeclContext*> loaded_;
+  /// Indexes the names of all declarations of the module,
+  /// which is built on the first search for a similar declaration.
+  mutable SimilarityIndex similarityIndex_;
+  mutable bool isIndexed_ = false;
+
+  static unsigned const THRESHOLD = 10U;
+
+public:
+  ModuleASTScope(CompilationUnit* compilationUnit, ASTContext* astContext,
+                 ModuleFile const* module,
+                 llvm::Optional<ConsistentASTScope const*> parent,
+                 std::recursive_mutex* mutex)
+      : compilationUnit_(compilationUnit), astContext_(astContext),
+        module_(module), parent_(parent), mutex_(mutex),
+        unit_(astContext->allocate<CompilationUnitASTNode>(
+            /*isImported*/ true)) {
+    unit_->setScope(this);
+  }
+
+  llvm::Optional<ASTScope const*> parent() const override {
+    if (parent_)
+      return llvm::Optional<ASTScope const*>(*parent_);
+    else
+      return llvm::Optional<ASTScope const*>();
+  }
+
+  void insert(Symbol symbol, NamedDeclContext* node) override {
+    std::lock_guard<std::recursive_mutex> lock(*mutex_);
+    assert(!loaded_.count(symbol) &&
+           "The entry should never exists in the same scope");
+    loaded_.insert(std::make_pair(symbol, node));
+  }
+
+  void erase(Symbol /*symbol*/) override {
+    llvm_unreachable("Declarations are never erased from modules!");
+  }
+
+  Nullable<NamedDeclContext*> lookupIdentifier(Symbol symbol) const override {
+    std::lock_guard<std::recursive_mutex> lock(*mutex_);
+    auto itr = loaded_.find(symbol);
+    if (itr != loaded_.end())
+      return itr->second;
+    else if (auto index = module_->findDecl(symbol.getString()))
+      return load(*index);
+    else if (parent_)
+      return (*parent_)->lookupIdentifier(symbol);
+    else
+      return nullptr;
+  }
+
+  bool isConsistent() const override { return true; }
+
+  Nullable<NamedDeclContext*> similarTo(Symbol symbol) const override {
+    return similarTo(symbol, THRESHOLD, nullptr);
+  }
+
+  Nullable<NamedDeclContext*>
+  similarTo(Symbol symbol, unsigned distance,
+            NamedDeclContext* current) const override {
+    std::lock_guard<std::recursive_mutex> lock(*mutex_);
+    if (!isIndexed_) {
+      for (std::size_t i = 0; i < module_->getDeclCount(); ++i) {
+        similarityIndex_.insert(Symbol::intern(module_->getDeclName(i)));
+      }
+      isIndexed_ = true;
+    }
+
+    // Only the most similar declaration is deserialized
+    auto similar = similarityIndex_.findMostSimilar(
+        symbol, distance, [](Symbol) { return true; });
+    if (similar) {
+      current = *lookupIdentifier(*similar);
+    }
+
+    if (parent_)
+      return (*parent_)->similarTo(symbol, distance, current);
+    else
+      return current;
+  }
+
+private:
+  /// Deserializes the declaration at the given index
+  NamedDeclContext* load(std::size_t index) const {
+    ModuleReader moduleReader(astContext_, module_,
+                              module_->getDeclRecords(index));
+    auto layout = moduleReader.read();
+
+    NamedDeclContext* decl = nullptr;
+    traverseNode(*layout.getNode(0), [&](auto* promoted) {
+      staticIf(promoted, pred::isTopLevelNode(),
+               [&](TopLevelASTNode* toplevel) {
+                 toplevel->setContainingUnit(unit_);
+               });
+      staticIf(promoted, pred::isNamedDeclContext(),
+               [&](NamedDeclContext* named) { decl = named; });
+    });
+    assert(decl && "Expected a named declaration!");
+
+    // The declaration is visible before its children are read,
+    // since those could reference it recursively.
+    loaded_.insert(std::make_pair(*decl->getName(), decl));
+
+    ASTLayoutReader reader(compilationUnit_, astContext_, layout);
+    {
+      auto scope = reader.reenterConsistentScope(
+          const_cast<ModuleASTScope*>(this));
+      unit_->addChild(astContext_, reader.consume());
+    }
+    return decl;
+  }
+};
+
+/// The scope which unifies the scopes of multiple imported modules
+class ImportASTScope : public ConsistentASTScope {
+  llvm::SmallVector<ConsistentASTScope const*, 4> modules_;
+
+  static unsigned const THRESHOLD = 10U;
+
+public:
+  explicit ImportASTScope(llvm::ArrayRef<ConsistentASTScope const*> modules)
+      : modules_(modules.begin(), modules.end()) {}
+
+  llvm::Optional<ASTScope const*> parent() const override {
+    return llvm::Optional<ASTScope const*>();
+  }
+
+  void insert(Symbol /*symbol*/, NamedDeclContext* /*node*/) override {
+    llvm_unreachable("Declarations are never inserted into imports!");
+  }
+
+  void erase(Symbol /*symbol*/) override {
+    llvm_unreachable("Declarations are never erased from imports!");
+  }
+
+  Nullable<NamedDeclContext*> lookupIdentifier(Symbol symbol) const override {
+    for (auto module : modules_) {
+      if (auto decl = module->lookupIdentifier(symbol)) {
+        return decl;
+      }
+    }
+    return nullptr;
+  }
+
+  bool isConsistent() const override { return true; }
+
+  Nullable<NamedDeclContext*> similarTo(Symbol symbol) const override {
+    return similarTo(symbol, THRESHOLD, nullptr);
+  }
+
+  Nullable<NamedDeclContext*>
+  similarTo(Symbol symbol, unsigned distance,
+            NamedDeclContext* current) const override {
+    for (auto module : modules_) {
+      auto similar = module->similarTo(symbol, distance, current);
+      if (similar && (*similar != current)) {
+        current = *similar;
+        distance = symbol.getString().edit_distance(
+            current->getName()->getString(), true, THRESHOLD);
+      }
+    }
+    return current;
+  }
+};
+
+llvm::Optional<ConsistentASTScope const*>
+ModuleLoader::importModules(llvm::ArrayRef<ImportDeclASTNode*> imports,
+                            DiagnosticEngine* diagnosticEngine) {
+  if (!diagnosticEngine) {
+    diagnosticEngine = compilationUnit_->getDiagnosticEngine();
+  }
+
+  auto compilerInstance = compilationUnit_->getCompilerInstance();
+  auto manager = compilerInstance->getModuleManager();
+
+  llvm::SmallVector<ModuleFile const*, 4> modules;
+  for (auto import : imports) {
+    auto const path = ModuleManager::resolveImportPath(
+        compilationUnit_->getSourceFilePath(), *import->getPath());
+
+    ModuleStatus status;
+    Nullable<ModuleFile const*> module;
+    std::tie(status, module) = manager->load(compilerInstance, path);
+
+    switch (status) {
+      case ModuleStatus::Loaded:
+        modules.push_back(*module);
+        break;
+      case ModuleStatus::NotFound:
+        diagnosticEngine->diagnose(Diagnostic::ErrorModuleNotFound,
+                                   import->getPath(), *import->getPath());
+        break;
+      case ModuleStatus::ImportedCyclic:
+        diagnosticEngine->diagnose(Diagnostic::ErrorModuleImportedCyclic,
+                                   import->getPath(), *import->getPath());
+        break;
+      case ModuleStatus::BuildFailed:
+        diagnosticEngine->diagnose(Diagnostic::ErrorModuleBuildFailed,
+                                   import->getPath(), *import->getPath());
+        break;
+    }
+  }
+  return createImportScope(modules);
+}
+
+llvm::Optional<ConsistentASTScope const*>
+ModuleLoader::createImportScope(llvm::ArrayRef<ModuleFile const*> modules) {
+  if (modules.empty()) {
+    return llvm::None;
+  }
+
+  llvm::SmallVector<ConsistentASTScope const*, 4> scopes;
+  for (auto module : modules) {
+    scopes.push_back(scopeOf(module));
+  }
+  if (scopes.size() == 1) {
+    return scopes.front();
+  }
+  return astContext_->allocate<ImportASTScope>(scopes);
+}
+
+ConsistentASTScope const* ModuleLoader::scopeOf(ModuleFile const* module) {
+  auto itr = scopes_.find(module);
+  if (itr != scopes_.end()) {
+    return itr->second;
+  }
+
+  auto parent = createImportScope(module->getImportedModules());
+  auto scope = astContext_->allocate<ModuleASTScope>(
+      compilationUnit_, astContext_, module, parent, &mutex_);
+  scopes_.insert(std::make_pair(module, scope));
+  return scope;
+}
@@ -0,0 +1,75 @@
+
+/**
+  Copyright(c) 2016 - 2017 Denis Blank <denis.blank at outlook dot com>
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+**/
+
+#ifndef MODULE_LOADER_HPP_INCLUDED__
+#define MODULE_LOADER_HPP_INCLUDED__
+
+#include <mutex>
+#include <unordered_map>
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/Optional.h"
+
+#include "ASTFragment.hpp"
+#include "ASTScope.hpp"
+
+class ASTContext;
+class CompilationUnit;
+class DiagnosticEngine;
+class ImportDeclASTNode;
+class ModuleFile;
+
+/// Makes the declarations of imported modules visible to a compilation unit.
+///
+/// Every module is represented through a consistent scope which
+/// deserializes a declaration only when it's looked up, so the cost of
+/// an import depends on the declarations used and not on the module size.
+/// The parent of a module scope contains the modules imported by the module,
+/// which makes imports transitive.
+///
+/// Deserializing a declaration is guarded by a mutex shared between all
+/// scopes of the loader, so the scopes can be looked up from multiple threads.
+class ModuleLoader : public ASTFragment {
+  CompilationUnit* compilationUnit_;
+  ASTContext* astContext_;
+  /// The scopes of the modules which were imported already
+  std::unordered_map<ModuleFile const*, ConsistentASTScope const*> scopes_;
+  /// Guards the deserialization into the ASTContext, which is reentered
+  /// when a deserialized declaration references other declarations.
+  std::recursive_mutex mutex_;
+
+public:
+  ModuleLoader(CompilationUnit* compilationUnit, ASTContext* astContext)
+      : compilationUnit_(compilationUnit), astContext_(astContext) {}
+
+  /// Loads the modules of the given imports and returns the scope which
+  /// contains their declarations, the result is empty when nothing
+  /// was imported. Modules which can't be loaded are diagnosed through
+  /// the given DiagnosticEngine, or through the one of the unit.
+  llvm::Optional<ConsistentASTScope const*>
+  importModules(llvm::ArrayRef<ImportDeclASTNode*> imports,
+                DiagnosticEngine* diagnosticEngine = nullptr);
+
+private:
+  /// Returns the scope which contains the declarations of the given modules
+  llvm::Optional<ConsistentASTScope const*>
+  createImportScope(llvm::ArrayRef<ModuleFile const*> modules);
+  /// Returns the scope which contains the declarations of the given module
+  ConsistentASTScope const* scopeOf(ModuleFile const* module);
+};
+
+#endif // #ifndef MODULE_LOADER_HPP_INCLUDED__
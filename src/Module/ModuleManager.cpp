@@ -0,0 +1,228 @@
+
+/**
+  Copyright(c) 2016 - 2017 Denis Blank <denis.blank at outlook dot com>
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+**/
+
+#include "ModuleManager.hpp"
+
+#include <cassert>
+#include <system_error>
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "CompilationUnit.hpp"
+#include "CompilerInstance.hpp"
+
+ModuleManager::ModuleManager() {}
+
+ModuleManager::~ModuleManager() {}
+
+std::pair<ModuleStatus, Nullable<ModuleFile const*>>
+ModuleManager::load(CompilerInstance* compilerInstance, llvm::StringRef path) {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+
+  std::string key = path;
+  auto itr = modules_.find(key);
+  if (itr == modules_.end()) {
+    if (!loading_.insert(key).second) {
+      return {ModuleStatus::ImportedCyclic, nullptr};
+    }
+    auto entry = loadUncached(compilerInstance, key);
+    loading_.erase(key);
+
+    itr = modules_.emplace(std::move(key), std::move(entry)).first;
+  }
+
+  // The module might be loaded through another compiler instance before
+  if (itr->second.status == ModuleStatus::Loaded) {
+    addSources(compilerInstance, itr->second);
+  }
+  return {itr->second.status, itr->second.module.get()};
+}
+
+bool ModuleManager::hasOutdated() {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+  for (auto const& module : modules_) {
+    if (isOutdated(module.first, module.second)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void ModuleManager::dropOutdated() {
+  std::lock_guard<std::recursive_mutex> lock(mutex_);
+
+  // Dropping a module outdates its importers, so we repeat until
+  // no further module is dropped.
+  bool dropped;
+  do {
+    dropped = false;
+    for (auto itr = modules_.begin(); itr != modules_.end();) {
+      auto const& entry = itr->second;
+      bool outdated = isOutdated(itr->first, entry);
+      for (std::size_t i = 0; !outdated && (i < entry.module->getImportCount());
+           ++i) {
+        outdated = !modules_.count(entry.module->getImportPath(i).str());
+      }
+
+      if (outdated) {
+        itr = modules_.erase(itr);
+        dropped = true;
+      } else {
+        ++itr;
+      }
+    }
+  } while (dropped);
+}
+
+bool ModuleManager::isOutdated(std::string const& path, Entry const& entry) {
+  if (entry.status != ModuleStatus::Loaded) {
+    return true;
+  }
+  auto const stamp = SourceStamp::of(path);
+  return !stamp || (*stamp != entry.module->getSourceStamp());
+}
+
+ModuleManager::Entry
+ModuleManager::loadUncached(CompilerInstance* compilerInstance,
+                            std::string const& path) {
+  auto stamp = SourceStamp::of(path);
+  if (!stamp) {
+    return {ModuleStatus::NotFound, nullptr, nullptr};
+  }
+
+  // The source is required for the locations of the declarations
+  auto source = llvm::MemoryBuffer::getFile(path);
+  if (!source) {
+    return {ModuleStatus::NotFound, nullptr, nullptr};
+  }
+
+  // Reuse the module file when it was built from the current source
+  std::unique_ptr<ModuleFile> module;
+  if (auto buffer = llvm::MemoryBuffer::getFile(getModulePath(path), -1,
+                                                /*RequiresNullTerminator*/
+                                                false)) {
+    module = ModuleFile::open(std::move(*buffer));
+    if (module && (module->getSourceStamp() != *stamp)) {
+      module.reset();
+    }
+  }
+
+  if (module) {
+    module->setSource((*source)->getBuffer());
+  } else {
+    module = build(compilerInstance, path, **source, *stamp);
+    if (!module) {
+      return {ModuleStatus::BuildFailed, nullptr, nullptr};
+    }
+  }
+
+  // Imports which were built together with the module are cached already
+  for (std::size_t i = 0; i < module->getImportCount(); ++i) {
+    auto imported = load(compilerInstance, module->getImportPath(i));
+    if (imported.first != ModuleStatus::Loaded) {
+      return {ModuleStatus::BuildFailed, nullptr, nullptr};
+    }
+    module->addImportedModule(*imported.second);
+  }
+
+  return {ModuleStatus::Loaded, std::move(module), std::move(*source)};
+}
+
+std::unique_ptr<ModuleFile>
+ModuleManager::build(CompilerInstance* compilerInstance,
+                     std::string const& path, llvm::MemoryBuffer const& source,
+                     SourceStamp const& stamp) {
+  auto const id = compilerInstance->addModuleSource(source);
+  CompilationUnit unit(compilerInstance, id, path, /*isModuleBuild*/ true);
+  auto buffer = unit.buildModule(stamp);
+  if (!buffer) {
+    return nullptr;
+  }
+
+  // The module is still usable when it can't be written,
+  // it's just rebuilt on the next compilation then.
+  if (!writeModule(path, *buffer)) {
+    compilerInstance->logWarning("Failed to write the module of {}!", path);
+  }
+
+  auto module = ModuleFile::open(std::move(buffer));
+  assert(module && "Built an invalid module!");
+  module->setSource(unit.getSource());
+  return module;
+}
+
+void ModuleManager::addSources(CompilerInstance* compilerInstance,
+                               Entry const& entry) {
+  compilerInstance->addModuleSource(*entry.source);
+
+  for (std::size_t i = 0; i < entry.module->getImportCount(); ++i) {
+    auto itr = modules_.find(entry.module->getImportPath(i).str());
+    assert((itr != modules_.end()) && "Expected the import to be loaded!");
+    addSources(compilerInstance, itr->second);
+  }
+}
+
+std::string ModuleManager::resolveImportPath(llvm::StringRef importingPath,
+                                             llvm::StringRef importPath) {
+  llvm::SmallString<128> path;
+  if (llvm::sys::path::is_relative(importPath)) {
+    path = llvm::sys::path::parent_path(importingPath);
+  }
+  llvm::sys::path::append(path, importPath);
+  llvm::sys::fs::make_absolute(path);
+  llvm::sys::path::remove_dots(path, /*remove_dot_dot*/ true);
+  return path.str();
+}
+
+std::string ModuleManager::getModulePath(llvm::StringRef sourcePath) {
+  llvm::SmallString<128> path(sourcePath);
+  llvm::sys::path::replace_extension(path, "swym");
+  return path.str();
+}
+
+bool ModuleManager::writeModule(llvm::StringRef sourcePath,
+                                llvm::MemoryBuffer const& module) {
+  auto const modulePath = getModulePath(sourcePath);
+
+  int fd;
+  llvm::SmallString<128> temporaryPath;
+  if (llvm::sys::fs::createUniqueFile(modulePath + "-%%%%%%%%", fd,
+                                      temporaryPath)) {
+    return false;
+  }
+
+  {
+    llvm::raw_fd_ostream out(fd, /*shouldClose*/ true);
+    out << module.getBuffer();
+    out.close();
+    if (out.has_error()) {
+      out.clear_error();
+      llvm::sys::fs::remove(temporaryPath);
+      return false;
+    }
+  }
+
+  if (llvm::sys::fs::rename(temporaryPath, modulePath)) {
+    llvm::sys::fs::remove(temporaryPath);
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,116 @@
+
+/**
+  Copyright(c) 2016 - 2017 Denis Blank <denis.blank at outlook dot com>
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+**/
+
+#ifndef MODULE_MANAGER_HPP_INCLUDED__
+#define MODULE_MANAGER_HPP_INCLUDED__
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include "llvm/ADT/StringRef.h"
+
+#include "ModuleFile.hpp"
+#include "Nullable.hpp"
+
+namespace llvm {
+class MemoryBuffer;
+}
+
+class CompilerInstance;
+
+/// Describes the result of loading a module
+enum class ModuleStatus {
+  Loaded,         ///< The module was loaded successfully
+  NotFound,       ///< The source file of the module doesn't exist
+  ImportedCyclic, ///< The module imports itself through other modules
+  BuildFailed     ///< The module or one of its imports contains errors
+};
+
+/// Loads the modules imported by compilation units, where every module is
+/// loaded only once and shared between the units of all compiler instances
+/// using the manager.
+///
+/// The module of a source file is stored next to it with the extension
+/// `.swym`, and it's built implicitly when it's missing or outdated.
+/// Modules only contain their own declarations, the imported modules
+/// are referenced through their path and loaded together with them.
+class ModuleManager {
+  /// Represents a module which was loaded already
+  struct Entry {
+    ModuleStatus status;
+    std::unique_ptr<ModuleFile> module;
+    /// The source of the module which is referenced by its locations
+    std::unique_ptr<llvm::MemoryBuffer> source;
+  };
+
+  /// Guards the modules, it's recursive since modules are loaded
+  /// recursively while building a module.
+  std::recursive_mutex mutex_;
+  std::unordered_map<std::string, Entry> modules_;
+  /// The modules which are loaded currently, used for detecting cycles
+  std::unordered_set<std::string> loading_;
+
+public:
+  ModuleManager();
+  ~ModuleManager();
+
+  /// Returns the module of the source file at the given absolute path,
+  /// the module is null when it couldn't be loaded.
+  /// Modules are built through the given compiler instance, which also
+  /// receives the sources of the module and its imports for diagnostics.
+  std::pair<ModuleStatus, Nullable<ModuleFile const*>>
+  load(CompilerInstance* compilerInstance, llvm::StringRef path);
+
+  /// Returns true when a module failed to load or when its source changed
+  bool hasOutdated();
+  /// Drops the modules which failed to load or which sources changed,
+  /// together with the modules importing them, so they are loaded again
+  /// on their next import. Modules must not be in use while dropping them.
+  void dropOutdated();
+
+  /// Returns the absolute path of the source file imported through
+  /// the given path, which is relative to the importing source file.
+  static std::string resolveImportPath(llvm::StringRef importingPath,
+                                       llvm::StringRef importPath);
+  /// Returns the path of the module file of the given source file
+  static std::string getModulePath(llvm::StringRef sourcePath);
+  /// Writes the given module next to its source file, the module is
+  /// written to a temporary file first, so it's replaced atomically.
+  /// Returns false when the module couldn't be written.
+  static bool writeModule(llvm::StringRef sourcePath,
+                          llvm::MemoryBuffer const& module);
+
+private:
+  /// Loads the module without caching its result
+  Entry loadUncached(CompilerInstance* compilerInstance,
+                     std::string const& path);
+  /// Builds the module out of its source file
+  std::unique_ptr<ModuleFile> build(CompilerInstance* compilerInstance,
+                                    std::string const& path,
+                                    llvm::MemoryBuffer const& source,
+                                    SourceStamp const& stamp);
+  /// Returns true when the module failed to load or its source changed
+  static bool isOutdated(std::string const& path, Entry const& entry);
+  /// Adds the sources of the module and its imports to the compiler instance
+  void addSources(CompilerInstance* compilerInstance, Entry const& entry);
+};
+
+#endif // #ifndef MODULE_MANAGER_HPP_INCLUDED__
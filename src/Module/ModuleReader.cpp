@@ -0,0 +1,204 @@
+
+/**
+  Copyright(c) 2016 - 2017 Denis Blank <denis.blank at outlook dot com>
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+**/
+
+#include "ModuleReader.hpp"
+
+#include <cassert>
+#include <vector>
+
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/SMLoc.h"
+
+#include "ModuleFile.hpp"
+
+ASTLayout ModuleReader::read() {
+  ASTLayoutWriter writer;
+  while (pos_ < records_.size()) {
+    // The kind is stored incremented by one, since 0 is the reduce marker
+    auto const tag = readInteger<std::uint8_t>();
+    if (tag == 0) {
+      writer.markReduce();
+    } else {
+      writer.directWrite(readNode(ASTKind(tag - 1)));
+    }
+  }
+  return std::move(writer).buildLayout();
+}
+
+ASTNode* ModuleReader::readNode(ASTKind kind) {
+  switch (kind) {
+#define FOR_EACH_AST_NODE(NAME)                                                \
+  case ASTKind::Kind##NAME:                                                    \
+    return readNode(identityOf<NAME##ASTNode>());
+#include "AST.inl"
+    default:
+      llvm_unreachable("The module contains an unregistered node kind!");
+  }
+}
+
+CompilationUnitASTNode*
+ModuleReader::readNode(identity<CompilationUnitASTNode>) {
+  llvm_unreachable("Compilation units aren't part of any declaration!");
+}
+
+MetaUnitASTNode* ModuleReader::readNode(identity<MetaUnitASTNode>) {
+  llvm_unreachable("Instantiated meta units aren't serializable!");
+}
+
+ImportDeclASTNode* ModuleReader::readNode(identity<ImportDeclASTNode>) {
+  return astContext_->allocate<ImportDeclASTNode>(readIdentifier());
+}
+
+FunctionDeclASTNode* ModuleReader::readNode(identity<FunctionDeclASTNode>) {
+  auto name = readIdentifier();
+  FunctionAttributes attributes;
+  llvm::SmallVector<Identifier, 2> targetClones;
+  auto const targets = readInteger<std::uint32_t>();
+  for (std::uint32_t i = 0; i < targets; ++i) {
+    targetClones.push_back(readIdentifier());
+  }
+  attributes.targetClones =
+      astContext_->allocateCopy(llvm::makeArrayRef(targetClones));
+  attributes.inlining = FunctionInlining(readInteger<std::uint8_t>());
+  attributes.frequency = FunctionFrequency(readInteger<std::uint8_t>());
+  return astContext_->allocate<FunctionDeclASTNode>(name, attributes);
+}
+
+MetaDeclASTNode* ModuleReader::readNode(identity<MetaDeclASTNode>) {
+  return astContext_->allocate<MetaDeclASTNode>(readIdentifier());
+}
+
+GlobalConstantDeclASTNode*
+ModuleReader::readNode(identity<GlobalConstantDeclASTNode>) {
+  return astContext_->allocate<GlobalConstantDeclASTNode>(readIdentifier());
+}
+
+GlobalConstantArrayDeclASTNode*
+ModuleReader::readNode(identity<GlobalConstantArrayDeclASTNode>) {
+  auto name = readIdentifier();
+  std::vector<std::int32_t> elements(readInteger<std::uint32_t>());
+  for (auto& element : elements) {
+    element = std::int32_t(readInteger<std::uint32_t>());
+  }
+  return astContext_->allocate<GlobalConstantArrayDeclASTNode>(
+      name, astContext_->allocateCopy(llvm::makeArrayRef(elements)));
+}
+
+MetaContributionASTNode*
+ModuleReader::readNode(identity<MetaContributionASTNode>) {
+  return astContext_->allocate<MetaContributionASTNode>(readRange());
+}
+
+NamedArgumentDeclASTNode*
+ModuleReader::readNode(identity<NamedArgumentDeclASTNode>) {
+  return astContext_->allocate<NamedArgumentDeclASTNode>(readIdentifier());
+}
+
+DeclStmtASTNode* ModuleReader::readNode(identity<DeclStmtASTNode>) {
+  return astContext_->allocate<DeclStmtASTNode>(readIdentifier());
+}
+
+ArrayDeclStmtASTNode* ModuleReader::readNode(identity<ArrayDeclStmtASTNode>) {
+  auto name = readIdentifier();
+  auto const size = readInteger<std::uint32_t>();
+  RangeAnnotated<std::uint32_t> annotated(size, readRange());
+  return astContext_->allocate<ArrayDeclStmtASTNode>(name, annotated);
+}
+
+IfStmtASTNode* ModuleReader::readNode(identity<IfStmtASTNode>) {
+  return astContext_->allocate<IfStmtASTNode>(
+      BranchLikelihood(readInteger<std::uint8_t>()));
+}
+
+MatchStmtASTNode* ModuleReader::readNode(identity<MatchStmtASTNode>) {
+  return astContext_->allocate<MatchStmtASTNode>(readRange());
+}
+
+MatchArmASTNode* ModuleReader::readNode(identity<MatchArmASTNode>) {
+  return astContext_->allocate<MatchArmASTNode>(readRange());
+}
+
+DeclRefExprASTNode* ModuleReader::readNode(identity<DeclRefExprASTNode>) {
+  return astContext_->allocate<DeclRefExprASTNode>(readIdentifier());
+}
+
+IntegerLiteralExprASTNode*
+ModuleReader::readNode(identity<IntegerLiteralExprASTNode>) {
+  auto const literal = std::int32_t(readInteger<std::uint32_t>());
+  RangeAnnotated<std::int32_t> annotated(literal, readRange());
+  return astContext_->allocate<IntegerLiteralExprASTNode>(annotated);
+}
+
+BooleanLiteralExprASTNode*
+ModuleReader::readNode(identity<BooleanLiteralExprASTNode>) {
+  auto const literal = readInteger<std::uint8_t>() != 0;
+  RangeAnnotated<bool> annotated(literal, readRange());
+  return astContext_->allocate<BooleanLiteralExprASTNode>(annotated);
+}
+
+BinaryOperatorExprASTNode*
+ModuleReader::readNode(identity<BinaryOperatorExprASTNode>) {
+  auto const binaryOperator = ExprBinaryOperator(readInteger<std::uint8_t>());
+  RangeAnnotated<ExprBinaryOperator> annotated(binaryOperator, readRange());
+  return astContext_->allocate<BinaryOperatorExprASTNode>(annotated);
+}
+
+ArraySubscriptExprASTNode*
+ModuleReader::readNode(identity<ArraySubscriptExprASTNode>) {
+  return astContext_->allocate<ArraySubscriptExprASTNode>(readRange());
+}
+
+MetaInstantiationExprASTNode*
+ModuleReader::readNode(identity<MetaInstantiationExprASTNode>) {
+  return astContext_->allocate<MetaInstantiationExprASTNode>(readRange());
+}
+
+template <typename T> T ModuleReader::readInteger() {
+  assert((pos_ + sizeof(T) <= records_.size()) &&
+         "Tried to read behind the end of the records!");
+  auto const value =
+      llvm::support::endian::read<T, llvm::support::little,
+                                  llvm::support::unaligned>(records_.data() +
+                                                            pos_);
+  pos_ += sizeof(T);
+  return value;
+}
+
+SourceLocation ModuleReader::readLocation() {
+  auto const offset = readInteger<std::uint32_t>();
+  if (offset == ModuleFile::InvalidLocation) {
+    return SourceLocation(llvm::SMLoc());
+  }
+
+  auto const source = module_->getSource();
+  assert((offset <= source.size()) && "The location is out of the source!");
+  return SourceLocation(llvm::SMLoc::getFromPointer(source.begin() + offset));
+}
+
+SourceRange ModuleReader::readRange() {
+  auto start = readLocation();
+  return {start, readLocation()};
+}
+
+Identifier ModuleReader::readIdentifier() {
+  auto const offset = readInteger<std::uint32_t>();
+  auto const length = readInteger<std::uint32_t>();
+  // Intern the string so it doesn't depend on the lifetime of the module
+  auto name = Symbol::intern(module_->getString(offset, length));
+  return {name, readRange()};
+}
@@ -0,0 +1,93 @@
+
+/**
+  Copyright(c) 2016 - 2017 Denis Blank <denis.blank at outlook dot com>
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+**/
+
+#ifndef MODULE_READER_HPP_INCLUDED__
+#define MODULE_READER_HPP_INCLUDED__
+
+#include <cstddef>
+#include <cstdint>
+
+#include "llvm/ADT/StringRef.h"
+
+#include "AST.hpp"
+#include "ASTContext.hpp"
+#include "ASTLayout.hpp"
+#include "Traits.hpp"
+
+class ModuleFile;
+
+/// Deserializes the records of a declaration inside a module into an
+/// ASTLayout, which nodes are allocated inside the given ASTContext.
+///
+/// The layout is consumed by the ASTLayoutReader afterwards,
+/// which resolves the declaration references of the nodes.
+class ModuleReader {
+  ASTContext* astContext_;
+  ModuleFile const* module_;
+  llvm::StringRef records_;
+  std::size_t pos_ = 0;
+
+public:
+  ModuleReader(ASTContext* astContext, ModuleFile const* module,
+               llvm::StringRef records)
+      : astContext_(astContext), module_(module), records_(records) {}
+
+  /// Reads the layout of the declaration
+  ASTLayout read();
+
+private:
+  /// Reads the node of the given kind without its children
+  ASTNode* readNode(ASTKind kind);
+
+  /// Nodes which are fully described through their children
+  template <typename T> T* readNode(identity<T>) {
+    return astContext_->allocate<T>();
+  }
+  CompilationUnitASTNode* readNode(identity<CompilationUnitASTNode>);
+  MetaUnitASTNode* readNode(identity<MetaUnitASTNode>);
+  ImportDeclASTNode* readNode(identity<ImportDeclASTNode>);
+  FunctionDeclASTNode* readNode(identity<FunctionDeclASTNode>);
+  MetaDeclASTNode* readNode(identity<MetaDeclASTNode>);
+  GlobalConstantDeclASTNode* readNode(identity<GlobalConstantDeclASTNode>);
+  GlobalConstantArrayDeclASTNode*
+      readNode(identity<GlobalConstantArrayDeclASTNode>);
+  MetaContributionASTNode* readNode(identity<MetaContributionASTNode>);
+  NamedArgumentDeclASTNode* readNode(identity<NamedArgumentDeclASTNode>);
+  DeclStmtASTNode* readNode(identity<DeclStmtASTNode>);
+  ArrayDeclStmtASTNode* readNode(identity<ArrayDeclStmtASTNode>);
+  IfStmtASTNode* readNode(identity<IfStmtASTNode>);
+  MatchStmtASTNode* readNode(identity<MatchStmtASTNode>);
+  MatchArmASTNode* readNode(identity<MatchArmASTNode>);
+  DeclRefExprASTNode* readNode(identity<DeclRefExprASTNode>);
+  IntegerLiteralExprASTNode* readNode(identity<IntegerLiteralExprASTNode>);
+  BooleanLiteralExprASTNode* readNode(identity<BooleanLiteralExprASTNode>);
+  BinaryOperatorExprASTNode* readNode(identity<BinaryOperatorExprASTNode>);
+  ArraySubscriptExprASTNode* readNode(identity<ArraySubscriptExprASTNode>);
+  MetaInstantiationExprASTNode*
+      readNode(identity<MetaInstantiationExprASTNode>);
+
+  /// Reads an integer of the given type
+  template <typename T> T readInteger();
+  /// Reads a source location which is stored as offset into the source file
+  SourceLocation readLocation();
+  /// Reads a source range
+  SourceRange readRange();
+  /// Reads an identifier which is stored through the string table
+  Identifier readIdentifier();
+};
+
+#endif // #ifndef MODULE_READER_HPP_INCLUDED__
@@ -0,0 +1,236 @@
+
+/**
+  Copyright(c) 2016 - 2017 Denis Blank <denis.blank at outlook dot com>
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+**/
+
+#include "ModuleWriter.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+#include "ASTLayout.hpp"
+#include "ASTPredicate.hpp"
+#include "ASTTraversal.hpp"
+
+/// Appends the given integer in little endian to the given buffer
+template <typename T> static void appendInteger(std::string& buffer, T value) {
+  char bytes[sizeof(T)];
+  llvm::support::endian::write<T, llvm::support::little,
+                               llvm::support::unaligned>(bytes, value);
+  buffer.append(bytes, sizeof(T));
+}
+
+void ModuleWriter::addImport(llvm::StringRef path) {
+  imports_.emplace_back(poolString(path), std::uint32_t(path.size()));
+}
+
+void ModuleWriter::addDecl(NamedDeclContext const* decl) {
+  auto name = decl->getName()->getString();
+  auto const begin = std::uint32_t(records_.size());
+  writeNode(decl->getDeclaringNode());
+  decls_.push_back({name, poolString(name), begin,
+                    std::uint32_t(records_.size())});
+}
+
+std::unique_ptr<llvm::MemoryBuffer>
+ModuleWriter::write(SourceStamp const& stamp, llvm::StringRef identifier) {
+  // Declarations are looked up through a binary search on their names
+  std::sort(decls_.begin(), decls_.end(),
+            [](DeclEntry const& left, DeclEntry const& right) {
+              return left.name < right.name;
+            });
+
+  std::string buffer(ModuleFile::Magic, sizeof(ModuleFile::Magic));
+  appendInteger<std::uint32_t>(buffer, ModuleFile::Version);
+  appendInteger<std::uint64_t>(buffer, stamp.size);
+  appendInteger<std::uint64_t>(buffer, stamp.modificationTime);
+  appendInteger<std::uint32_t>(buffer, imports_.size());
+  appendInteger<std::uint32_t>(buffer, decls_.size());
+  appendInteger<std::uint32_t>(buffer, strings_.size());
+  appendInteger<std::uint32_t>(buffer, records_.size());
+  assert((buffer.size() == ModuleFile::HeaderSize) &&
+         "Mismatching header size!");
+
+  for (auto const& import : imports_) {
+    appendInteger<std::uint32_t>(buffer, import.first);
+    appendInteger<std::uint32_t>(buffer, import.second);
+  }
+  for (auto const& decl : decls_) {
+    appendInteger<std::uint32_t>(buffer, decl.nameOffset);
+    appendInteger<std::uint32_t>(buffer, decl.name.size());
+    appendInteger<std::uint32_t>(buffer, decl.recordsBegin);
+    appendInteger<std::uint32_t>(buffer, decl.recordsEnd);
+  }
+  buffer.append(strings_);
+  buffer.append(records_);
+
+  return llvm::MemoryBuffer::getMemBufferCopy(buffer, identifier);
+}
+
+std::uint32_t ModuleWriter::poolString(llvm::StringRef str) {
+  auto itr = stringOffsets_.find(str);
+  if (itr != stringOffsets_.end()) {
+    return itr->second;
+  }
+
+  auto const offset = std::uint32_t(strings_.size());
+  strings_.append(str.begin(), str.end());
+  stringOffsets_.insert(std::make_pair(str, offset));
+  return offset;
+}
+
+void ModuleWriter::writeNode(ASTNode const* node) {
+  // The kind is stored incremented by one, since 0 is the reduce marker
+  writeInteger<std::uint8_t>(std::uint8_t(node->getKind()) + 1);
+
+  traverseNode(node, [&](auto const* promoted) {
+    this->writeData(promoted);
+
+    traverseNodeIf(promoted, pred::hasChildren(), [&](auto const* parent) {
+      for (auto child : parent->children()) {
+        this->writeNode(child);
+      }
+    });
+  });
+
+  if (ASTLayoutWriter::isNodeRequiringReduceMarker(node)) {
+    writeInteger<std::uint8_t>(0);
+  }
+}
+
+void ModuleWriter::writeData(CompilationUnitASTNode const* /*node*/) {
+  llvm_unreachable("Compilation units aren't part of any declaration!");
+}
+
+void ModuleWriter::writeData(MetaUnitASTNode const* /*node*/) {
+  llvm_unreachable("Instantiated meta units aren't serializable!");
+}
+
+void ModuleWriter::writeData(ImportDeclASTNode const* node) {
+  writeIdentifier(node->getPath());
+}
+
+void ModuleWriter::writeData(FunctionDeclASTNode const* node) {
+  auto const& attributes = node->getAttributes();
+  writeIdentifier(node->getName());
+  writeInteger<std::uint32_t>(attributes.targetClones.size());
+  for (auto const& target : attributes.targetClones) {
+    writeIdentifier(target);
+  }
+  writeInteger<std::uint8_t>(std::uint8_t(attributes.inlining));
+  writeInteger<std::uint8_t>(std::uint8_t(attributes.frequency));
+}
+
+void ModuleWriter::writeData(MetaDeclASTNode const* node) {
+  writeIdentifier(node->getName());
+}
+
+void ModuleWriter::writeData(GlobalConstantDeclASTNode const* node) {
+  writeIdentifier(node->getName());
+}
+
+void ModuleWriter::writeData(GlobalConstantArrayDeclASTNode const* node) {
+  writeIdentifier(node->getName());
+  writeInteger<std::uint32_t>(node->getSize());
+  for (auto element : node->getElements()) {
+    writeInteger<std::uint32_t>(std::uint32_t(element));
+  }
+}
+
+void ModuleWriter::writeData(MetaContributionASTNode const* node) {
+  writeRange(node->getSourceRange());
+}
+
+void ModuleWriter::writeData(NamedArgumentDeclASTNode const* node) {
+  writeIdentifier(node->getName());
+}
+
+void ModuleWriter::writeData(DeclStmtASTNode const* node) {
+  writeIdentifier(node->getName());
+}
+
+void ModuleWriter::writeData(ArrayDeclStmtASTNode const* node) {
+  writeIdentifier(node->getName());
+  writeInteger<std::uint32_t>(*node->getSize());
+  writeRange(node->getSize().getAnnotation());
+}
+
+void ModuleWriter::writeData(IfStmtASTNode const* node) {
+  writeInteger<std::uint8_t>(std::uint8_t(node->getLikelihood()));
+}
+
+void ModuleWriter::writeData(MatchStmtASTNode const* node) {
+  writeRange(node->getSourceRange());
+}
+
+void ModuleWriter::writeData(MatchArmASTNode const* node) {
+  writeRange(node->getSourceRange());
+}
+
+void ModuleWriter::writeData(DeclRefExprASTNode const* node) {
+  writeIdentifier(node->getName());
+}
+
+void ModuleWriter::writeData(IntegerLiteralExprASTNode const* node) {
+  writeInteger<std::uint32_t>(std::uint32_t(*node->getLiteral()));
+  writeRange(node->getLiteral().getAnnotation());
+}
+
+void ModuleWriter::writeData(BooleanLiteralExprASTNode const* node) {
+  writeInteger<std::uint8_t>(std::uint8_t(*node->getLiteral()));
+  writeRange(node->getLiteral().getAnnotation());
+}
+
+void ModuleWriter::writeData(BinaryOperatorExprASTNode const* node) {
+  writeInteger<std::uint8_t>(std::uint8_t(*node->getBinaryOperator()));
+  writeRange(node->getBinaryOperator().getAnnotation());
+}
+
+void ModuleWriter::writeData(ArraySubscriptExprASTNode const* node) {
+  writeRange(node->getSourceRange());
+}
+
+void ModuleWriter::writeData(MetaInstantiationExprASTNode const* node) {
+  writeRange(node->getSourceRange());
+}
+
+template <typename T> void ModuleWriter::writeInteger(T value) {
+  appendInteger<T>(records_, value);
+}
+
+void ModuleWriter::writeLocation(SourceLocation const& location) {
+  auto pointer = location.toLLVMLocation().getPointer();
+  if (!pointer || (pointer < source_.begin()) || (pointer > source_.end())) {
+    writeInteger<std::uint32_t>(ModuleFile::InvalidLocation);
+  } else {
+    writeInteger<std::uint32_t>(pointer - source_.begin());
+  }
+}
+
+void ModuleWriter::writeRange(SourceRange const& range) {
+  writeLocation(range.getStart());
+  writeLocation(range.getEnd());
+}
+
+void ModuleWriter::writeIdentifier(Identifier const& identifier) {
+  auto const str = identifier->getString();
+  writeInteger<std::uint32_t>(poolString(str));
+  writeInteger<std::uint32_t>(str.size());
+  writeRange(identifier.getAnnotation());
+}
@@ -0,0 +1,110 @@
+
+/**
+  Copyright(c) 2016 - 2017 Denis Blank <denis.blank at outlook dot com>
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+**/
+
+#ifndef MODULE_WRITER_HPP_INCLUDED__
+#define MODULE_WRITER_HPP_INCLUDED__
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+
+#include "AST.hpp"
+#include "ModuleFile.hpp"
+
+namespace llvm {
+class MemoryBuffer;
+}
+
+/// Serializes the top level declarations of a compilation unit
+/// into a module, which format is described in the ModuleFile.
+class ModuleWriter {
+  /// Represents an entry of the decl table
+  struct DeclEntry {
+    llvm::StringRef name;
+    std::uint32_t nameOffset;
+    std::uint32_t recordsBegin;
+    std::uint32_t recordsEnd;
+  };
+
+  llvm::StringRef source_;
+  /// The offset and the length of the import paths inside the string table
+  std::vector<std::pair<std::uint32_t, std::uint32_t>> imports_;
+  std::vector<DeclEntry> decls_;
+  std::string strings_;
+  llvm::StringMap<std::uint32_t> stringOffsets_;
+  std::string records_;
+
+public:
+  /// Creates the writer for declarations which are parsed from
+  /// the given source file.
+  explicit ModuleWriter(llvm::StringRef source) : source_(source) {}
+
+  /// Adds the absolute path of a source file imported by the module
+  void addImport(llvm::StringRef path);
+  /// Adds the given top level declaration together with its children
+  void addDecl(NamedDeclContext const* decl);
+
+  /// Returns the module which contains the added imports and declarations
+  std::unique_ptr<llvm::MemoryBuffer> write(SourceStamp const& stamp,
+                                            llvm::StringRef identifier);
+
+private:
+  /// Returns the offset of the given string inside the string table
+  std::uint32_t poolString(llvm::StringRef str);
+
+  /// Writes the node, its children and its reduce marker into the records
+  void writeNode(ASTNode const* node);
+
+  /// Nodes which are fully described through their children
+  template <typename T> void writeData(T const* /*node*/) {}
+  void writeData(CompilationUnitASTNode const* node);
+  void writeData(MetaUnitASTNode const* node);
+  void writeData(ImportDeclASTNode const* node);
+  void writeData(FunctionDeclASTNode const* node);
+  void writeData(MetaDeclASTNode const* node);
+  void writeData(GlobalConstantDeclASTNode const* node);
+  void writeData(GlobalConstantArrayDeclASTNode const* node);
+  void writeData(MetaContributionASTNode const* node);
+  void writeData(NamedArgumentDeclASTNode const* node);
+  void writeData(DeclStmtASTNode const* node);
+  void writeData(ArrayDeclStmtASTNode const* node);
+  void writeData(IfStmtASTNode const* node);
+  void writeData(MatchStmtASTNode const* node);
+  void writeData(MatchArmASTNode const* node);
+  void writeData(DeclRefExprASTNode const* node);
+  void writeData(IntegerLiteralExprASTNode const* node);
+  void writeData(BooleanLiteralExprASTNode const* node);
+  void writeData(BinaryOperatorExprASTNode const* node);
+  void writeData(ArraySubscriptExprASTNode const* node);
+  void writeData(MetaInstantiationExprASTNode const* node);
+
+  /// Writes the given integer into the records
+  template <typename T> void writeInteger(T value);
+  /// Writes the given source location as offset into the source file
+  void writeLocation(SourceLocation const& location);
+  /// Writes the given source range
+  void writeRange(SourceRange const& range);
+  /// Writes the given identifier through the string table
+  void writeIdentifier(Identifier const& identifier);
+};
+
+#endif // #ifndef MODULE_WRITER_HPP_INCLUDED__
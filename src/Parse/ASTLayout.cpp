@@ -17,12 +17,93 @@
 
 #include "ASTLayout.hpp"
 
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <utility>
+#include <vector>
 
 #include "llvm/Support/ErrorHandling.h"
-#include "llvm/Support/SaveAndRestore.h"
+#include "llvm/Support/ThreadPool.h"
 
 #include "ASTTraversal.hpp"
+#include "CompilationUnit.hpp"
+#include "CompilerInstance.hpp"
+#include "DiagnosticEngine.hpp"
+#include "ModuleLoader.hpp"
+
+/// The minimal count of layout entries a fork of the reader consumes,
+/// which keeps the overhead of the worker threads small compared to
+/// the consumption itself.
+static constexpr std::size_t MinEntriesPerFork = 1U << 12U;
+
+namespace {
+/// Describes how the children of a kind of ASTNode are laid out
+struct KindLayout {
+  bool isRequiringReduceMarker;
+  std::uint8_t fixedChildCount;
+};
+} // end anonymous namespace
+
+template <typename T> static KindLayout kindLayoutOf(identity<T>) {
+  using Node = T*;
+  using RequiringReduceMarker =
+      decltype(pred::isRequiringReduceMarker()(std::declval<Node>()));
+  using FixedChildCount = decltype(conditionalEvaluate(
+      pred::hasChildren()(std::declval<Node>()), std::declval<Node>(),
+      pred::getKnownAmountOfChildren(),
+      supplierOf<std::integral_constant<std::size_t, 0U>>()));
+  return {RequiringReduceMarker::value,
+          std::uint8_t(FixedChildCount::value)};
+}
+
+/// The layout of every kind of ASTNode indexed by its kind
+static std::array<KindLayout, ASTKindCount> const kindLayouts = {{
+#define FOR_EACH_AST_NODE(NAME) kindLayoutOf(identityOf<NAME##ASTNode>()),
+#include "AST.inl"
+}};
+
+void ASTLayout::clear() {
+  kinds_.clear();
+  payloads_.clear();
+  ends_.clear();
+  nodes_.clear();
+}
+
+bool ASTLayout::isRequiringReduceMarker(ASTKind kind) {
+  return kindLayouts[std::size_t(kind)].isRequiringReduceMarker;
+}
+
+std::size_t ASTLayout::getFixedChildCount(ASTKind kind) {
+  return kindLayouts[std::size_t(kind)].fixedChildCount;
+}
+
+void ASTLayout::calculateSubtreeEnds() {
+  // The layout is visited backwards, so the subtrees of all children
+  // are known already when the subtree of their parent is calculated.
+  // Subtrees which exceed the layout are cut at its end, which only
+  // happens for layouts of erroneous sources.
+  auto const count = std::uint32_t(size());
+  ends_.resize(count);
+  for (auto position = count; position-- != 0U;) {
+    auto end = position + 1U;
+    if (!isReduceMarker(position)) {
+      auto const kind = getKind(position);
+      if (isRequiringReduceMarker(kind)) {
+        while ((end < count) && !isReduceMarker(end)) {
+          end = ends_[end];
+        }
+        end = std::min(end + 1U, count);
+      } else {
+        for (auto i = getFixedChildCount(kind); (i != 0U) && (end < count);
+             --i) {
+          end = ends_[end];
+        }
+      }
+    }
+    ends_[position] = end;
+  }
+}
 
 void ASTLayoutWriter::write(NonNull<ASTNode*> node) {
   directWrite(node);
@@ -40,23 +121,55 @@ ScopeLeaveAction ASTLayoutWriter::scopedWrite(NonNull<ASTNode*> node) {
   });
 }
 
+ASTLayout ASTLayoutWriter::buildLayout() && {
+  layout_.calculateSubtreeEnds();
+  return std::move(layout_);
+}
+
 bool ASTLayoutWriter::isNodeRequiringReduceMarker(ASTNode const* node) {
-  return traverseNode(
-      node, decorate(identityOf<bool>(), pred::isRequiringReduceMarker()));
+  return ASTLayout::isRequiringReduceMarker(node->getKind());
+}
+
+void ASTLayoutWriter::writeParent(std::size_t position,
+                                  NonNull<ASTNode*> node) {
+  assert((position <= layout_.size()) && "The position is out of range!");
+  layout_.kinds_.insert(layout_.kinds_.begin() + position,
+                        std::uint8_t(node->getKind()));
+  layout_.payloads_.insert(layout_.payloads_.begin() + position,
+                           std::uint32_t(layout_.nodes_.size()));
+  layout_.nodes_.push_back(*node);
+  if (isNodeRequiringReduceMarker(*node)) {
+    markReduce();
+  }
 }
 
 void ASTLayoutWriter::directWrite(NonNull<ASTNode*> node) {
-  layout_.push_back(*node);
+  layout_.kinds_.push_back(std::uint8_t(node->getKind()));
+  layout_.payloads_.push_back(std::uint32_t(layout_.nodes_.size()));
+  layout_.nodes_.push_back(*node);
+}
+
+void ASTLayoutWriter::append(ASTLayout const& layout) {
+  auto const offset = std::uint32_t(layout_.nodes_.size());
+  layout_.kinds_.insert(layout_.kinds_.end(), layout.kinds_.begin(),
+                        layout.kinds_.end());
+  for (auto payload : layout.payloads_) {
+    layout_.payloads_.push_back(payload == ASTLayout::NoPayload
+                                    ? payload
+                                    : offset + payload);
+  }
+  layout_.nodes_.insert(layout_.nodes_.end(), layout.nodes_.begin(),
+                        layout.nodes_.end());
 }
 
 void ASTLayoutWriter::markReduce() {
-  layout_.push_back(nullptr);
-  ;
+  layout_.kinds_.push_back(std::uint8_t(ASTLayout::ReduceMarker));
+  layout_.payloads_.push_back(std::uint32_t(ASTLayout::NoPayload));
 }
 
 Nullable<ASTNode*> ASTLayoutReader::peek() const {
-  assert((pos_ < layout_.size()) && "Didn't expected to be at the end!");
-  return layout_[pos_];
+  assert((pos_ < layout_->size()) && "Didn't expected to be at the end!");
+  return layout_->getNode(pos_);
 }
 
 Nullable<ASTNode*> ASTLayoutReader::shift() {
@@ -66,13 +179,14 @@ Nullable<ASTNode*> ASTLayoutReader::shift() {
 }
 
 ASTLayoutReader::ScopedShift<ASTNode> ASTLayoutReader::scopedShift() {
+  auto const mustReduce =
+      ASTLayout::isRequiringReduceMarker(layout_->getKind(pos_));
   auto node = *shift();
-  return ScopedShift<ASTNode>(
-      node, ScopeLeaveAction([=] {
-        if (ASTLayoutWriter::isNodeRequiringReduceMarker(node)) {
-          reduce();
-        }
-      }));
+  return ScopedShift<ASTNode>(node, ScopeLeaveAction([=] {
+                                if (mustReduce) {
+                                  reduce();
+                                }
+                              }));
 }
 
 void ASTLayoutReader::reduce() {
@@ -80,27 +194,110 @@ void ASTLayoutReader::reduce() {
   shift();
 }
 
-static void crawlExpand(ASTLayoutReader& reader) {
-  while (!reader.shouldReduce()) {
-    auto current = *reader.shift();
-    if (ASTLayoutWriter::isNodeRequiringReduceMarker(current)) {
-      crawlExpand(reader);
-    }
+void ASTLayoutReader::crawlCurrentScope(
+    llvm::function_ref<void(ASTNode* node)> consumer) {
+  // The subtrees of the nodes are skipped without visiting them
+  for (auto position = pos_; !layout_->isReduceMarker(position);
+       position = layout_->getSubtreeEnd(position)) {
+    consumer(*layout_->getNode(position));
   }
-  reader.reduce();
 }
 
-void ASTLayoutReader::crawlCurrentScope(
-    llvm::function_ref<void(ASTNode* node)> consumer) {
-  // Restore the current cursor when leaving this function
-  llvm::SaveAndRestore<decltype(pos_)> restore(pos_);
+std::unique_ptr<ASTLayoutReader>
+ASTLayoutReader::fork(ASTContext* astContext,
+                      DiagnosticEngine* diagnosticEngine) const {
+  assert((pos_ < layout_->size()) && "Didn't expected to be at the end!");
+  auto forked = std::make_unique<ASTLayoutReader>(
+      compilationUnit(), astContext, *layout_, diagnosticEngine);
+  forked->pos_ = pos_;
+  return forked;
+}
+
+/// Splits the siblings starting at the given position into at most the
+/// given count of ranges, where every range consists of at least the
+/// given count of entries. Returns the positions where the ranges begin
+/// followed by the position of the reduce marker behind the siblings.
+static llvm::SmallVector<std::size_t, 8>
+splitIntoForks(ASTLayout const& layout, std::size_t begin, unsigned maxForks,
+               std::size_t minEntriesPerFork) {
+  auto end = begin;
+  while (!layout.isReduceMarker(end)) {
+    end = layout.getSubtreeEnd(end);
+  }
 
-  while (!shouldReduce()) {
-    auto current = *shift();
-    consumer(current);
-    if (ASTLayoutWriter::isNodeRequiringReduceMarker(current)) {
-      crawlExpand(*this);
+  llvm::SmallVector<std::size_t, 8> boundaries{begin};
+  auto const count = end - begin;
+  if ((maxForks >= 2) && (count >= 2 * minEntriesPerFork)) {
+    auto const entriesPerFork = std::max(minEntriesPerFork, count / maxForks);
+    for (auto position = layout.getSubtreeEnd(begin);
+         (position != end) && (boundaries.size() < maxForks);
+         position = layout.getSubtreeEnd(position)) {
+      if ((position - boundaries.back() >= entriesPerFork) &&
+          (end - position >= minEntriesPerFork)) {
+        boundaries.push_back(position);
+      }
+    }
+  }
+  boundaries.push_back(end);
+  return boundaries;
+}
+
+void ASTLayoutReader::consumeTopLevelDecls(
+    ConsistentASTScope* scope, llvm::SmallVectorImpl<ASTNode*>& children) {
+  auto const threadCount =
+      compilationUnit()->getCompilerInstance()->getUnitThreadCount();
+  auto const boundaries =
+      splitIntoForks(*layout_, pos_, threadCount, MinEntriesPerFork);
+  if (boundaries.size() <= 2) {
+    while (!shouldReduce()) {
+      children.push_back(consumeTopLevelDecl());
+    }
+    return;
+  }
+
+  /// Represents a fork which consumes the declarations up to its end
+  struct Fork {
+    std::unique_ptr<ASTContext> astContext;
+    DiagnosticEngine diagnosticEngine;
+    std::unique_ptr<ASTLayoutReader> reader;
+    std::size_t end;
+    std::vector<ASTNode*> children;
+
+    Fork(CompilationUnit const* compilationUnit, std::size_t end)
+        : astContext(std::make_unique<ASTContext>()),
+          diagnosticEngine(DiagnosticEngine::CreateDeferred(compilationUnit)),
+          end(end) {}
+  };
+
+  // The top level declarations were introduced into the unit scope
+  // already, so the forks only look declarations up in it.
+  std::vector<Fork> forks;
+  forks.reserve(boundaries.size() - 1);
+  {
+    llvm::ThreadPool pool(threadCount);
+    for (std::size_t i = 0; i + 1 < boundaries.size(); ++i) {
+      pos_ = boundaries[i];
+      forks.emplace_back(compilationUnit(), boundaries[i + 1]);
+      auto& current = forks.back();
+      current.reader =
+          fork(current.astContext.get(), &current.diagnosticEngine);
+      pool.async([&current, scope] {
+        auto reentered = current.reader->reenterConsistentScope(scope);
+        while (current.reader->pos_ != current.end) {
+          current.children.push_back(current.reader->consumeTopLevelDecl());
+        }
+      });
     }
+    pool.wait();
+  }
+  pos_ = boundaries.back();
+
+  // Join the forks in source order, so the same diagnostics are displayed
+  // as when consuming the declarations sequentially.
+  for (auto& fork : forks) {
+    fork.diagnosticEngine.replayInto(diagnosticEngine());
+    children.append(fork.children.begin(), fork.children.end());
+    astContext()->adopt(std::move(fork.astContext));
   }
 }
 
@@ -123,18 +320,33 @@ ASTNode* ASTLayoutReader::consume() {
 CompilationUnitASTNode* ASTLayoutReader::consumeCompilationUnit() {
   auto node = scopedShiftAs<CompilationUnitASTNode>();
 
-  auto scope = enterConsistentScope();
+  // Imports precede the declarations of the unit
+  llvm::SmallVector<ImportDeclASTNode*, 4> imports;
+  llvm::SmallVector<ASTNode*, 16> children;
+  while (!shouldReduce() && is<ImportDeclASTNode>()) {
+    imports.push_back(consumeImportDecl());
+    children.push_back(imports.back());
+  }
+
+  // The declarations of imported modules are visible through the parent
+  auto loader = astContext()->allocate<ModuleLoader>(compilationUnit(),
+                                                     astContext());
+  auto scope =
+      enterConsistentScope(loader->importModules(imports, diagnosticEngine()));
   node->setScope(*scope);
 
   introduceScope(*node);
 
-  while (!shouldReduce()) {
-    node->addChild(consumeTopLevelDecl());
-  }
+  consumeTopLevelDecls(*scope, children);
 
+  node->setChildren(astContext(), children);
   return *node;
 }
 
+ImportDeclASTNode* ASTLayoutReader::consumeImportDecl() {
+  return shiftAs<ImportDeclASTNode>();
+}
+
 MetaUnitASTNode* ASTLayoutReader::consumeMetaUnit() {
   auto node = scopedShiftAs<MetaUnitASTNode>();
 
@@ -153,11 +365,12 @@ MetaUnitASTNode* ASTLayoutReader::consumeMetaUnit() {
 
   introduceScope(*node);
 
+  llvm::SmallVector<ASTNode*, 16> children;
   while (!shouldReduce()) {
-    auto child = consumeTopLevelDecl();
-    node->addChild(child);
+    children.push_back(consumeTopLevelDecl());
   }
 
+  node->setChildren(astContext(), children);
   return *node;
 }
 
@@ -177,9 +390,11 @@ FunctionDeclASTNode* ASTLayoutReader::consumeFunctionDecl() {
 
 ArgumentDeclListASTNode* ASTLayoutReader::consumeArgumentDeclList() {
   auto node = scopedShiftAs<ArgumentDeclListASTNode>();
+  llvm::SmallVector<AnonymousArgumentDeclASTNode*, 4> arguments;
   while (!shouldReduce()) {
-    node->addArgument(consumeAnonymousArgumentDecl());
+    arguments.push_back(consumeAnonymousArgumentDecl());
   }
+  node->setArguments(astContext(), arguments);
   return *node;
 }
 
@@ -214,20 +429,35 @@ GlobalConstantDeclASTNode* ASTLayoutReader::consumeGlobalConstantDecl() {
   return node;
 }
 
+GlobalConstantArrayDeclASTNode*
+ASTLayoutReader::consumeGlobalConstantArrayDecl() {
+  auto node = shiftAs<GlobalConstantArrayDeclASTNode>();
+  // Arrays on the top level were introduced together with their unit,
+  // whereas arrays exported into a function are introduced like statements.
+  if (!currentScope()->isConsistent()) {
+    introduce(node);
+  }
+  return node;
+}
+
 MetaContributionASTNode* ASTLayoutReader::consumeMetaContribution() {
   auto node = scopedShiftAs<MetaContributionASTNode>();
+  llvm::SmallVector<ASTNode*, 8> children;
   while (!shouldReduce()) {
-    node->addChild(consume());
+    children.push_back(consume());
   }
+  node->setChildren(astContext(), children);
   return *node;
 }
 
 MetaInstantiationExprASTNode* ASTLayoutReader::consumeMetaInstantiationExpr() {
   auto node = scopedShiftAs<MetaInstantiationExprASTNode>();
   node->setDecl(consumeDeclRefExpr());
+  llvm::SmallVector<ExprASTNode*, 4> arguments;
   while (!shouldReduce()) {
-    node->addArgument(consumeExpr());
+    arguments.push_back(consumeExpr());
   }
+  node->setArguments(astContext(), arguments);
   return *node;
 }
 
@@ -254,9 +484,11 @@ ExprASTNode* ASTLayoutReader::consumeExpr() {
 UnscopedCompoundStmtASTNode* ASTLayoutReader::consumeUnscopedCompoundStmt() {
   auto node = scopedShiftAs<UnscopedCompoundStmtASTNode>();
 
+  llvm::SmallVector<StmtASTNode*, 16> statements;
   while (!shouldReduce()) {
-    node->addStatement(consumeStmt());
+    statements.push_back(consumeStmt());
   }
+  node->setStatements(astContext(), statements);
   return *node;
 }
 
@@ -264,9 +496,11 @@ CompoundStmtASTNode* ASTLayoutReader::consumeCompoundStmt() {
   auto node = scopedShiftAs<CompoundStmtASTNode>();
   auto scope = enterTemporaryScope();
 
+  llvm::SmallVector<StmtASTNode*, 16> statements;
   while (!shouldReduce()) {
-    node->addStatement(consumeStmt());
+    statements.push_back(consumeStmt());
   }
+  node->setStatements(astContext(), statements);
   return *node;
 }
 
@@ -291,6 +525,12 @@ DeclStmtASTNode* ASTLayoutReader::consumeDeclStmt() {
   return node;
 }
 
+ArrayDeclStmtASTNode* ASTLayoutReader::consumeArrayDeclStmt() {
+  auto node = shiftAs<ArrayDeclStmtASTNode>();
+  introduce(node);
+  return node;
+}
+
 IfStmtASTNode* ASTLayoutReader::consumeIfStmt() {
   auto node = scopedShiftAs<IfStmtASTNode>();
   node->setExpression(consumeExpr());
@@ -301,6 +541,30 @@ IfStmtASTNode* ASTLayoutReader::consumeIfStmt() {
   return *node;
 }
 
+MatchStmtASTNode* ASTLayoutReader::consumeMatchStmt() {
+  auto node = scopedShiftAs<MatchStmtASTNode>();
+  node->setExpression(consumeExpr());
+  llvm::SmallVector<ASTNode*, 8> arms;
+  while (!shouldReduce()) {
+    // Arms could also be meta nodes which contribute arms later
+    arms.push_back(consume());
+  }
+  node->setArms(astContext(), arms);
+  return *node;
+}
+
+MatchArmASTNode* ASTLayoutReader::consumeMatchArm() {
+  auto node = scopedShiftAs<MatchArmASTNode>();
+  auto scope = enterTemporaryScope();
+
+  // The wildcard arm has no pattern
+  if (is<ExprASTNode>()) {
+    node->setPattern(consumeExpr());
+  }
+  node->setBody(consumeStmt());
+  return *node;
+}
+
 MetaIfStmtASTNode* ASTLayoutReader::consumeMetaIfStmt() {
   auto node = scopedShiftAs<MetaIfStmtASTNode>();
 
@@ -320,13 +584,19 @@ MetaIfStmtASTNode* ASTLayoutReader::consumeMetaIfStmt() {
 MetaCalculationStmtASTNode* ASTLayoutReader::consumeMetaCalculationStmt() {
   auto node = shiftAs<MetaCalculationStmtASTNode>();
 
-  auto listener = [&](NamedDeclContext* decl) { node->addExportedDecl(decl); };
+  llvm::SmallVector<NamedDeclContext*, 4> exportedDecls;
+  auto listener = [&](NamedDeclContext* decl) {
+    exportedDecls.push_back(decl);
+  };
 
-  auto scope = enterInplaceScope(listener);
+  {
+    auto scope = enterInplaceScope(listener);
 
-  auto mode = enterMetaComputationMode();
-  node->setStmt(consumeStmt());
+    auto mode = enterMetaComputationMode();
+    node->setStmt(consumeStmt());
+  }
 
+  node->setExportedDecls(astContext(), exportedDecls);
   return node;
 }
 
@@ -361,12 +631,21 @@ BinaryOperatorExprASTNode* ASTLayoutReader::consumeBinaryOperatorExpr() {
   return node;
 }
 
+ArraySubscriptExprASTNode* ASTLayoutReader::consumeArraySubscriptExpr() {
+  auto node = shiftAs<ArraySubscriptExprASTNode>();
+  node->setBaseExpr(consumeExpr());
+  node->setIndexExpr(consumeExpr());
+  return node;
+}
+
 CallOperatorExprASTNode* ASTLayoutReader::consumeCallOperatorExpr() {
   auto node = scopedShiftAs<CallOperatorExprASTNode>();
   node->setCallee(consumeExpr());
+  llvm::SmallVector<ExprASTNode*, 4> expressions;
   while (!shouldReduce()) {
-    node->addExpression(consumeExpr());
+    expressions.push_back(consumeExpr());
   }
+  node->setExpressions(astContext(), expressions);
   return *node;
 }
 
@@ -18,12 +18,18 @@
 #ifndef AST_LAYOUTER_HPP_INCLUDED__
 #define AST_LAYOUTER_HPP_INCLUDED__
 
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
-#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/Casting.h"
+#include "llvm/Support/ErrorHandling.h"
 
 #include "AST.hpp"
 #include "ASTPredicate.hpp"
@@ -32,7 +38,82 @@
 #include "ScopeLeaveAction.hpp"
 #include "Traits.hpp"
 
-using ASTLayout = std::vector<Nullable<ASTNode*>>;
+/// Represents the flat layout of ASTNodes through parallel arrays,
+/// where every entry is either a node or a reduce marker.
+///
+/// Every entry stores the kind of its node in a single byte, the index of
+/// its node inside the payload arena and the position after the end of
+/// its subtree. Thus scans over the structure of the layout only touch
+/// contiguous memory and never the nodes themselves.
+///
+/// Layouts are written through the ASTLayoutWriter and are read
+/// through the ASTLayoutReader.
+class ASTLayout {
+  friend class ASTLayoutWriter;
+
+  /// The kind byte and the payload index of reduce markers
+  enum : std::uint8_t { ReduceMarker = 0xFFU };
+  enum : std::uint32_t { NoPayload = ~0U };
+
+  /// The kind of every entry
+  std::vector<std::uint8_t> kinds_;
+  /// The index of the node of every entry inside the payload arena
+  std::vector<std::uint32_t> payloads_;
+  /// The position after the last entry of the subtree of every entry,
+  /// which is calculated when the layout is built.
+  std::vector<std::uint32_t> ends_;
+  /// The payload arena which contains the nodes of the entries
+  std::vector<ASTNode*> nodes_;
+
+  static_assert(ASTKindCount < std::size_t(ReduceMarker),
+                "The kind byte is exhausted by the count of ASTKind's!");
+
+public:
+  ASTLayout() = default;
+
+  /// Returns the count of entries
+  std::size_t size() const { return kinds_.size(); }
+  /// Returns true when the layout contains no entries
+  bool empty() const { return kinds_.empty(); }
+  /// Removes all entries
+  void clear();
+
+  /// Returns true when the entry at the given position is a reduce marker
+  bool isReduceMarker(std::size_t position) const {
+    assert((position < size()) && "The position is out of range!");
+    return kinds_[position] == ReduceMarker;
+  }
+  /// Returns the kind of the node at the given position
+  ASTKind getKind(std::size_t position) const {
+    assert(!isReduceMarker(position) && "Expected a node here!");
+    return ASTKind(kinds_[position]);
+  }
+  /// Returns the node at the given position,
+  /// which is null for reduce markers.
+  Nullable<ASTNode*> getNode(std::size_t position) const {
+    if (isReduceMarker(position))
+      return nullptr;
+    else
+      return nodes_[payloads_[position]];
+  }
+  /// Returns the position after the last entry of the subtree
+  /// at the given position, which includes its reduce marker.
+  std::size_t getSubtreeEnd(std::size_t position) const {
+    assert((ends_.size() == size()) && "The layout wasn't built!");
+    return ends_[position];
+  }
+
+  /// Returns true when nodes of the given kind require a reduce marker
+  /// after all their children.
+  static bool isRequiringReduceMarker(ASTKind kind);
+  /// Returns the count of children nodes of the given kind are followed
+  /// by in the layout, when they don't require a reduce marker.
+  static std::size_t getFixedChildCount(ASTKind kind);
+
+private:
+  /// Calculates the end of the subtree of every entry
+  void calculateSubtreeEnds();
+};
 
 /// A helper class for writing ASTLayout's
 class ASTLayoutWriter {
@@ -49,9 +130,14 @@ public:
   ScopeLeaveAction scopedWrite(NonNull<ASTNode*> node);
 
   /// Returns the completed layout
-  ASTLayout const& buildLayout() const & { return layout_; }
-  /// Returns the completed layout
-  ASTLayout buildLayout() && { return std::move(layout_); }
+  ASTLayout buildLayout() &&;
+
+  /// Returns the position the next node is written to
+  std::size_t getPosition() const { return layout_.size(); }
+  /// Writes the node in front of all nodes which were written since the
+  /// given position, which makes those nodes to children of the node.
+  /// Closes the scope of the node immediately.
+  void writeParent(std::size_t position, NonNull<ASTNode*> node);
 
   /// Returns true when the given node requires a reduce mark to be
   /// written at the end of the layout after all it's children were written.
@@ -61,6 +147,9 @@ public:
   /// like autoreducing.
   /// Note: this could malform the layout on misusage.
   void directWrite(NonNull<ASTNode*> node);
+  /// Appends the given layout of completed nodes to the layout
+  void append(ASTLayout const& layout);
+
   /// Directly marks the current node as reduced
   /// Note: this could malform the layout on misusage.
   void markReduce();
@@ -69,19 +158,21 @@ public:
 /// Provides methods for layouting ASTNodes taken from continuous space,
 /// this is currently implemented through a LL(0) parser.
 ///
-/// The layouter accepts a vector of ASTNode's which is structured as following:
+/// The layouter accepts an ASTLayout which is structured as following:
 /// - ASTNode (the node itself)
 ///   - child (which is then an ASTNode itself)
 ///   - child
 ///   - child (and more children..., this structure applies recursively)
-/// - nullptr (reduce marker - only present if the node can hold any child,
+/// - reduce marker (only present if the node can hold any child,
 ///            this is required for resolving shift reduce conflicts
 ///            which we encounter in compound statements for instance.)
 ///
-/// TODO This class theoretically can be implemented reentrant which makes
-///      it more efficient for consuming nodes.
+/// The reader is reentrant, since it never modifies the layout. It can be
+/// forked at the boundary between siblings, which makes it possible to
+/// consume the top level declarations of large compilation units on
+/// multiple threads.
 class ASTLayoutReader : public BasicASTBuilder {
-  llvm::ArrayRef<Nullable<ASTNode*>> layout_;
+  ASTLayout const* layout_;
   std::size_t pos_;
 
   /// Represents the result of a scoped shift which reads the
@@ -107,18 +198,29 @@ class ASTLayoutReader : public BasicASTBuilder {
 
 public:
   ASTLayoutReader(CompilationUnit* compilationUnit, ASTContext* astContext,
-                  llvm::ArrayRef<Nullable<ASTNode*>> layout)
+                  ASTLayout const& layout,
+                  DiagnosticEngine* diagnosticEngine = nullptr)
       : BasicASTBuilder(compilationUnit,
-                        astContext /*TODO Remove ast context from here*/),
-        layout_(layout), pos_(0) {}
+                        astContext /*TODO Remove ast context from here*/,
+                        diagnosticEngine),
+        layout_(&layout), pos_(0) {}
 
   /// Returns the current element in the stream
   Nullable<ASTNode*> peek() const;
   /// Returns the current element in the stream as the given type
   template <typename T> T* peekAs() const { return llvm::cast<T>(*peek()); }
   /// Returns true when the current element in the stream
-  /// is of the given type.
-  template <typename T> bool is() const { return llvm::isa<T>(*peek()); }
+  /// is of the given type, which is decided through its kind only.
+  template <typename T> bool is() const {
+    switch (layout_->getKind(pos_)) {
+#define FOR_EACH_AST_NODE(NAME)                                                \
+  case ASTKind::Kind##NAME:                                                    \
+    return std::is_base_of<T, NAME##ASTNode>::value;
+#include "AST.inl"
+      default:
+        llvm_unreachable("Unregistered node kind!");
+    }
+  }
   /// Returns the current element in the stream
   /// and shifts the position to the right.
   Nullable<ASTNode*> shift();
@@ -149,8 +251,8 @@ public:
   }
 
   /// Returns true when the layouter should reduce the current production
-  /// which is marked by a nullptr at the current position
-  bool shouldReduce() const { return !peek(); }
+  /// which is marked by a reduce marker at the current position
+  bool shouldReduce() const { return layout_->isReduceMarker(pos_); }
   /// Reduces the current context
   void reduce();
 
@@ -158,6 +260,15 @@ public:
   /// with the nodes found.
   void crawlCurrentScope(llvm::function_ref<void(ASTNode* node)> consumer);
 
+  /// Returns a reader which starts at the current position and consumes
+  /// the following siblings independently of this reader.
+  /// The fork allocates its nodes inside the given ASTContext and emits
+  /// its diagnostics through the given DiagnosticEngine, so it can be used
+  /// on another thread as long as the consistent scopes it reenters
+  /// aren't modified.
+  std::unique_ptr<ASTLayoutReader>
+  fork(ASTContext* astContext, DiagnosticEngine* diagnosticEngine) const;
+
   /// Consumes any ASTNode
   ASTNode* consume();
   /// Consumes any statements
@@ -176,6 +287,10 @@ private:
 
   /// Consumes a top level decl
   ASTNode* consumeTopLevelDecl();
+  /// Consumes the top level decls up to the end of the given unit scope,
+  /// which are distributed across forks of the reader for large units.
+  void consumeTopLevelDecls(ConsistentASTScope* scope,
+                            llvm::SmallVectorImpl<ASTNode*>& children);
   /// Consumes a constant expression
   ConstantExprASTNode* consumeConstantExpr();
 };
@@ -19,10 +19,12 @@
 
 #include <memory>
 
+#include "antlr4-runtime.h"
+
 #include "llvm/ADT/Optional.h"
+#include "llvm/Support/Timer.h"
 
 #include "GeneratedParser.h"
-#include "GeneratedParserBaseListener.h"
 
 #include "AST.hpp"
 #include "ASTDumper.hpp"
@@ -30,8 +32,10 @@
 #include "CompilationUnit.hpp"
 #include "CompilerInstance.hpp"
 #include "CompilerInvocation.hpp"
+#include "DiagnosticEngine.hpp"
 #include "DiagnosticListener.hpp"
-#include "LocalScopeVisitor.hpp"
+#include "LocalScopeListener.hpp"
+#include "ParallelSourceParser.hpp"
 #include "SourceLocation.hpp"
 
 llvm::Optional<ASTParseResult>
@@ -40,37 +44,122 @@ ASTParser::parse(SharedTokenStream const& tokens) const {
 
   auto errorListener = createDiagnosticListener(compilationUnit_);
 
+  // The layout is written by a parse listener while the rules are
+  // recognized, so there is no need for building a parse tree.
   GeneratedParser parser(tokens.get());
+  parser.setBuildParseTree(false);
+
+  // Parses the source with the full LL prediction,
+  // which reports real syntax errors.
+  ASTLayout layout;
+  auto const parseLL = [&] {
+    llvm::NamedRegionTimer timer("Parsing (LL)", "Frontend",
+                                 compilationUnit_->isTimingPhases());
+    parser.reset();
+    parser.removeParseListeners();
+    parser.removeErrorListeners();
+    parser.addErrorListener(errorListener.get());
+    parser.setErrorHandler(std::make_shared<antlr4::DefaultErrorStrategy>());
+    parser.getInterpreter<antlr4::atn::ParserATNSimulator>()
+        ->setPredictionMode(antlr4::atn::PredictionMode::LL);
+
+    // Drop the nodes of a cancelled parse
+    astContext = std::make_shared<ASTContext>();
+    LocalScopeListener listener(compilationUnit_, astContext.get(), &parser);
+    parser.addParseListener(&listener);
+
+    parser.compilationUnit();
+    layout = std::move(listener).buildLayout();
+  };
+
+  // The SLL prediction is skipped on request, which allows comparing
+  // both prediction modes through -vtime.
+  auto const parserKind =
+      compilationUnit_->getCompilerInstance()->getInvocation()->getParserKind();
+  if (parserKind == ParserKind::GeneratedLL) {
+    parseLL();
+    return parseLayout(std::move(astContext), std::move(layout));
+  }
+
+  // Try to parse the source with the faster SLL prediction first, which
+  // is sufficient for almost all inputs. The parse is cancelled on the first
+  // error without reporting it, since it could be caused by the weaker
+  // prediction mode. The source is reparsed with the full LL prediction
+  // in that case.
+  // Diagnostics of the SLL parse are deferred, because they are
+  // reported again when the source is reparsed.
   parser.removeErrorListeners();
-  parser.addErrorListener(errorListener.get());
-  // parser.getTokenStream()->mark() and seek
-  auto compilationUnit = parser.compilationUnit();
-  if (!canContinue()) {
-    return llvm::None;
+  parser.setErrorHandler(std::make_shared<antlr4::BailErrorStrategy>());
+  parser.getInterpreter<antlr4::atn::ParserATNSimulator>()->setPredictionMode(
+      antlr4::atn::PredictionMode::SLL);
+
+  auto deferred = DiagnosticEngine::CreateDeferred(compilationUnit_);
+  LocalScopeListener listener(compilationUnit_, astContext.get(), &parser,
+                              &deferred);
+  parser.addParseListener(&listener);
+
+  try {
+    llvm::NamedRegionTimer timer("Parsing (SLL)", "Frontend",
+                                 compilationUnit_->isTimingPhases());
+    parser.compilationUnit();
+
+    deferred.replayInto(compilationUnit_->getDiagnosticEngine());
+    layout = std::move(listener).buildLayout();
+  } catch (antlr4::ParseCancellationException const&) {
+    parseLL();
   }
 
-  LocalScopeVisitor localScopeVisitor(compilationUnit_, astContext.get());
-  compilationUnit->accept(&localScopeVisitor);
+  return parseLayout(std::move(astContext), std::move(layout));
+}
 
-  auto layout = std::move(localScopeVisitor).buildLayout();
+llvm::Optional<ASTParseResult>
+ASTParser::parse(llvm::StringRef source,
+                 llvm::ArrayRef<LexedToken> tokens) const {
+  auto astContext = std::make_shared<ASTContext>();
+
+  // Large sources are split into chunks of top level declarations,
+  // which are parsed on the threads available to the compilation unit.
+  auto const threadCount =
+      compilationUnit_->getCompilerInstance()->getUnitThreadCount();
+  ParallelSourceParser parser(compilationUnit_, astContext.get(), source,
+                              tokens, threadCount);
+  {
+    llvm::NamedRegionTimer timer("Parsing", "Frontend",
+                                 compilationUnit_->isTimingPhases());
+    parser.parse();
+  }
+
+  auto layout = std::move(parser).buildLayout();
+  return parseLayout(std::move(astContext), std::move(layout));
+}
+
+llvm::Optional<ASTParseResult>
+ASTParser::parseLayout(ASTContextRef astContext, ASTLayout layout) const {
   if (!canContinue()) {
     return llvm::None;
   }
 
-  if (compilationUnit_->getCompilerInstance()->getInvocation()->hasEmitAction(
-          EmitAction::EmitFlatLayout)) {
-    dumpFlatLayout(llvm::outs(), llvm::makeArrayRef(layout));
+  if (compilationUnit_->hasEmitAction(EmitAction::EmitFlatLayout)) {
+    auto compilerInstance = compilationUnit_->getCompilerInstance();
+    auto lock = compilerInstance->lockOutput();
+    dumpFlatLayout(compilerInstance->getOutputStream(), layout);
     return llvm::None;
   }
 
-  if (compilationUnit_->getCompilerInstance()->getInvocation()->hasEmitAction(
-          EmitAction::EmitLayout)) {
-    dumpLayout(llvm::outs(), llvm::makeArrayRef(layout));
+  if (compilationUnit_->hasEmitAction(EmitAction::EmitLayout)) {
+    auto compilerInstance = compilationUnit_->getCompilerInstance();
+    auto lock = compilerInstance->lockOutput();
+    dumpLayout(compilerInstance->getOutputStream(), layout);
     return llvm::None;
   }
 
-  ASTLayoutReader reader(compilationUnit_, astContext.get(), std::move(layout));
-  auto main = reader.consumeCompilationUnit();
+  ASTLayoutReader reader(compilationUnit_, astContext.get(), layout);
+  CompilationUnitASTNode* main;
+  {
+    llvm::NamedRegionTimer timer("Layout reading", "Frontend",
+                                 compilationUnit_->isTimingPhases());
+    main = reader.consumeCompilationUnit();
+  }
 
   if (!canContinue()) {
     return llvm::None;
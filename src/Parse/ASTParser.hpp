@@ -22,12 +22,16 @@
 #include <tuple>
 #include <utility>
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/Optional.h"
+#include "llvm/ADT/StringRef.h"
 
 #include "ASTContext.hpp"
+#include "ASTLayout.hpp"
 
 class CompilationUnit;
 class CompilationUnitASTNode;
+struct LexedToken;
 
 namespace antlr4 {
 class TokenStream;
@@ -60,10 +64,18 @@ public:
   explicit ASTParser(CompilationUnit* compilationUnit)
       : compilationUnit_(compilationUnit) {}
 
-  /// Parses the given token stream
+  /// Parses the given token stream through the GeneratedParser
   llvm::Optional<ASTParseResult> parse(SharedTokenStream const& tokens) const;
+  /// Parses the given lexed tokens through the SourceParser,
+  /// where large sources are parsed in parallel.
+  llvm::Optional<ASTParseResult>
+  parse(llvm::StringRef source, llvm::ArrayRef<LexedToken> tokens) const;
 
 private:
+  /// Creates the AST out of the given layout or emits it when requested
+  llvm::Optional<ASTParseResult> parseLayout(ASTContextRef astContext,
+                                             ASTLayout layout) const;
+
   /// Returns true when the the parsing can continue
   bool canContinue() const;
 };
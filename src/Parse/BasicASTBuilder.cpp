@@ -49,24 +49,38 @@ BasicScopeReference<T> replaceScope(Nullable<ASTScope*>& current,
 }
 
 ScopeReference BasicASTBuilder::enterTemporaryScope() {
-  // Take the ownership here since we are managing it in leaveScope
-  auto temporary = ASTScope::CreateTemporary(currentScope());
-  assert(!temporary->isConsistent() &&
-         "Wanted a temporary scope but got a consistent one!");
+  if (!temporaryScope_) {
+    temporaryScope_ = TemporaryASTScope::CreateTemporary();
+  }
+
+  // All nested temporary scopes are represented through the same table,
+  // where the current scope is only used as parent of the outermost one.
+  auto temporary = temporaryScope_.get();
+  auto previous = std::exchange(currentScope_, temporary);
+  temporary->enter(*previous);
+
+  auto recover = [this, previous, temporary] {
+    assert(*currentScope_ == temporary && "Wrong scope replacement order!");
+    temporary->leave();
+    currentScope_ = previous;
+  };
 
-  return replaceScope(currentScope_, move(temporary));
+  return {std::move(recover), temporary};
 }
 
 ConsistentScopeReference BasicASTBuilder::enterConsistentScope(
     llvm::Optional<ConsistentASTScope const*> parent) {
+  auto consistent = ConsistentASTScope::CreateConsistent(astContext(), parent);
+  return reenterConsistentScope(consistent);
+}
 
+ConsistentScopeReference
+BasicASTBuilder::reenterConsistentScope(ConsistentASTScope* consistent) {
   assert(!isInAnyScope() ||
          currentScope()->isConsistent() &&
              "Tried to initialize a consistent scope on top of a "
              "temporary one!");
 
-  auto consistent = ConsistentASTScope::CreateConsistent(astContext(), parent);
-
   auto previous = std::exchange(currentScope_, consistent);
 
   auto recover = [this, previous, consistent] {
@@ -168,6 +182,9 @@ BasicASTBuilder::lookup(Identifier const& identifier) const {
                                  identifier, identifier);
 
     // Try to suggest the most similar node
+    if (!diagnosticEngine()->consumeTypoCorrection()) {
+      return decl;
+    }
     if (auto similar = similarDeclarationOf(identifier)) {
       diagnosticEngine()->diagnose(
           Diagnostic::NoteDidYouMeanQuestion, similar->getName(),
@@ -208,8 +225,8 @@ void BasicASTBuilder::introduce(NamedDeclContext* namedDecl) const {
 }
 
 Nullable<NamedDeclContext*>
-BasicASTBuilder::similarDeclarationOf(llvm::StringRef str) const {
-  return currentScope()->similarTo(str);
+BasicASTBuilder::similarDeclarationOf(Symbol symbol) const {
+  return currentScope()->similarTo(symbol);
 }
 
 Nullable<NamedDeclContext*>
@@ -218,8 +235,8 @@ BasicASTBuilder::similarDeclarationOf(Identifier const& identifier) const {
 }
 
 Nullable<NamedDeclContext*>
-BasicASTBuilder::directLookup(llvm::StringRef str) const {
-  return currentScope()->lookupIdentifier(str);
+BasicASTBuilder::directLookup(Symbol symbol) const {
+  return currentScope()->lookupIdentifier(symbol);
 }
 
 Nullable<NamedDeclContext*>
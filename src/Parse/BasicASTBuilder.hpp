@@ -19,6 +19,7 @@
 #define BASIC_AST_BUILDER_HPP_INCLUDED__
 
 #include <cassert>
+#include <memory>
 #include <stack>
 #include <type_traits>
 
@@ -90,22 +91,29 @@ private:
 /// Provides support methods for building an AST from various sources
 class BasicASTBuilder : public BasicTreeSupport {
   Nullable<ASTScope*> currentScope_;
+  /// The flat table of all nested temporary scopes which is shared
+  /// between them, it's created when the first temporary scope is entered.
+  std::unique_ptr<TemporaryASTScope> temporaryScope_;
 
   ScopedMode<MetaDepthLevel, MetaDepthLevel::Outside> metaDeclMode_;
 
 public:
-  BasicASTBuilder(CompilationUnit* compilationUnit, ASTContext* astContext)
-      : BasicTreeSupport(compilationUnit, astContext) {}
+  BasicASTBuilder(CompilationUnit* compilationUnit, ASTContext* astContext,
+                  DiagnosticEngine* diagnosticEngine = nullptr)
+      : BasicTreeSupport(compilationUnit, astContext, diagnosticEngine) {}
 
   virtual ~BasicASTBuilder();
 
   /// Returns the current scope
   ASTScope* currentScope() const;
-  /// Creates and enters a new temporary scope
+  /// Enters a new temporary scope, which is pushed onto the temporary
+  /// scope table of the builder without allocating a new scope.
   ScopeReference enterTemporaryScope();
   /// Enters a permanent scope
   ConsistentScopeReference enterConsistentScope(
       llvm::Optional<ConsistentASTScope const*> parent = llvm::None);
+  /// Enters the given permanent scope which was created already
+  ConsistentScopeReference reenterConsistentScope(ConsistentASTScope* scope);
   /// Creates and enters a new inplace scope
   InplaceScopeReference
   enterInplaceScope(InplaceASTScope::ListenerType listener);
@@ -128,8 +136,8 @@ public:
   /// Introduces the given NamedDeclContext in the current scope
   /// If the identifier is already present it will yield an error message.
   void introduce(NamedDeclContext* namedDecl) const;
-  /// Returns the most similar alternative to the given string
-  Nullable<NamedDeclContext*> similarDeclarationOf(llvm::StringRef str) const;
+  /// Returns the most similar alternative to the given symbol
+  Nullable<NamedDeclContext*> similarDeclarationOf(Symbol symbol) const;
   /// Returns the most similar alternative to the given identifier
   Nullable<NamedDeclContext*>
   similarDeclarationOf(Identifier const& identifier) const;
@@ -146,9 +154,9 @@ private:
   /// Returns true when we are in at least one scope
   bool isInAnyScope() const { return !currentScope_.empty(); }
 
-  /// Searches for the StringRef in the current scope without yielding an
+  /// Searches for the Symbol in the current scope without yielding an
   /// error message.
-  Nullable<NamedDeclContext*> directLookup(llvm::StringRef str) const;
+  Nullable<NamedDeclContext*> directLookup(Symbol symbol) const;
   /// Searches for the identifier in the current scope without yielding an
   /// error message.
   Nullable<NamedDeclContext*> directLookup(Identifier const& identifier) const;
@@ -15,11 +15,23 @@
   limitations under the License.
 **/
 
-#include "BasicTreeVisitor.hpp"
+#include "BasicTreeListener.hpp"
+
+#include "SourceCharStream.hpp"
+
+llvm::StringRef
+BasicTreeListener::textOf(antlr4::tree::TerminalNode* node) {
+  auto token = node->getSymbol();
+  assert(dynamic_cast<SourceCharStream*>(token->getInputStream()) &&
+         "Expected the token to be read from a SourceCharStream!");
+
+  auto stream = static_cast<SourceCharStream*>(token->getInputStream());
+  return stream->getTextRef(token->getStartIndex(), token->getStopIndex());
+}
 
 SourceRange
-BasicTreeVisitor::sourceRangeOf(antlr4::tree::TerminalNode* token) const {
-  return sourceLocationOf(token).extend(token->getText().length());
+BasicTreeListener::sourceRangeOf(antlr4::tree::TerminalNode* token) const {
+  return sourceLocationOf(token).extend(textOf(token).size());
 
   /*
   TODO FIXME interval is returned with { 0, 0 } from antlr.
@@ -31,7 +43,7 @@ BasicTreeVisitor::sourceRangeOf(antlr4::tree::TerminalNode* token) const {
 }
 
 SourceRange
-BasicTreeVisitor::sourceRangeOf(antlr4::tree::TerminalNode* begin,
-                                antlr4::tree::TerminalNode* end) const {
+BasicTreeListener::sourceRangeOf(antlr4::tree::TerminalNode* begin,
+                                 antlr4::tree::TerminalNode* end) const {
   return SourceRange::concat(sourceRangeOf(begin), sourceRangeOf(end));
 }
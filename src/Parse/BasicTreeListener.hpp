@@ -15,22 +15,27 @@
   limitations under the License.
 **/
 
-#ifndef BASIC_TREE_VISITOR_HPP_INCLUDED__
-#define BASIC_TREE_VISITOR_HPP_INCLUDED__
+#ifndef BASIC_TREE_LISTENER_HPP_INCLUDED__
+#define BASIC_TREE_LISTENER_HPP_INCLUDED__
 
-#include "GeneratedParserBaseVisitor.h"
+#include <cassert>
+
+#include "llvm/ADT/StringRef.h"
+
+#include "GeneratedParserBaseListener.h"
 
 #include "BasicTreeSupport.hpp"
 
 class CompilationUnit;
 class DiagnosticEngine;
 
-/// Provides basic support methods for ANTLR parse tree visitors and contexts
-class BasicTreeVisitor : public GeneratedParserBaseVisitor,
-                         public BasicTreeSupport {
+/// Provides basic support methods for ANTLR parse listeners and contexts
+class BasicTreeListener : public GeneratedParserBaseListener,
+                          public BasicTreeSupport {
 public:
-  BasicTreeVisitor(CompilationUnit* compilationUnit, ASTContext* astContext)
-      : BasicTreeSupport(compilationUnit, astContext) {}
+  BasicTreeListener(CompilationUnit* compilationUnit, ASTContext* astContext,
+                    DiagnosticEngine* diagnosticEngine = nullptr)
+      : BasicTreeSupport(compilationUnit, astContext, diagnosticEngine) {}
 
   /// Returns the SourceLocation of the given TerminalNode
   SourceLocation sourceLocationOf(antlr4::tree::TerminalNode* node) const {
@@ -47,18 +52,21 @@ public:
   SourceRange sourceRangeOf(antlr4::tree::TerminalNode* begin,
                             antlr4::tree::TerminalNode* end) const;
 
+  /// Returns the text of the given TerminalNode which refers
+  /// to the source buffer.
+  static llvm::StringRef textOf(antlr4::tree::TerminalNode* node);
+
   /// Returns the given TerminalNode as identifier
   Identifier identifierOf(antlr4::tree::TerminalNode* node) const {
-    return {poolString(node->getText()), sourceRangeOf(node)};
+    return {Symbol::intern(textOf(node)), sourceRangeOf(node)};
   }
-
-protected:
-  /// Returns an nullptr any as default value for performance improvement
-  antlrcpp::Any defaultResult() override { return nullptr; }
-  /// Never aggregate results as performance improvement
-  antlrcpp::Any aggregateResult(antlrcpp::Any, antlrcpp::Any const&) override {
-    return defaultResult();
+  /// Returns the given string literal TerminalNode without it's quotes
+  Identifier stringLiteralOf(antlr4::tree::TerminalNode* node) const {
+    auto text = textOf(node);
+    assert((text.size() >= 2) && "Expected a quoted string literal!");
+    return {Symbol::intern(text.slice(1, text.size() - 1)),
+            sourceRangeOf(node)};
   }
 };
 
-#endif // #ifndef BASIC_TREE_VISITOR_HPP_INCLUDED__
+#endif // #ifndef BASIC_TREE_LISTENER_HPP_INCLUDED__
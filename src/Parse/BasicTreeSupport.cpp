@@ -17,8 +17,135 @@
 
 #include "BasicTreeSupport.hpp"
 
+#include "llvm/ADT/StringSwitch.h"
+
 #include "CompilationUnit.hpp"
+#include "DiagnosticEngine.hpp"
 
 DiagnosticEngine* BasicTreeSupport::diagnosticEngine() const {
+  if (diagnosticEngine_) {
+    return diagnosticEngine_;
+  }
   return compilationUnit_->getDiagnosticEngine();
 }
+
+FunctionAttributes BasicTreeSupport::functionAttributesOf(
+    llvm::ArrayRef<SourceAttribute> attributes) {
+
+  FunctionAttributes result;
+  llvm::SmallVector<Identifier, 2> targetClones;
+  llvm::Optional<Identifier> inlining, frequency;
+  for (auto const& attribute : attributes) {
+    auto const& name = attribute.name;
+
+    if (*name == "target_clones") {
+      targetClones.append(attribute.arguments.begin(),
+                          attribute.arguments.end());
+      if (targetClones.empty()) {
+        diagnosticEngine()->diagnose(Diagnostic::ErrorAttributeArgumentsMissing,
+                                     name, name);
+      }
+    } else if ((*name == "inline") || (*name == "noinline")) {
+      if (checkFlagAttribute(attribute, inlining)) {
+        result.inlining = (*name == "inline") ? FunctionInlining::Always
+                                              : FunctionInlining::Never;
+      }
+    } else if ((*name == "hot") || (*name == "cold")) {
+      if (checkFlagAttribute(attribute, frequency)) {
+        result.frequency = (*name == "hot") ? FunctionFrequency::Hot
+                                            : FunctionFrequency::Cold;
+      }
+    } else {
+      diagnoseAttributeNotApplicable(name, "functions");
+    }
+  }
+  result.targetClones =
+      astContext_->allocateCopy(llvm::makeArrayRef(targetClones));
+  return result;
+}
+
+BranchLikelihood BasicTreeSupport::branchLikelihoodOf(
+    llvm::ArrayRef<SourceAttribute> attributes) {
+
+  auto likelihood = BranchLikelihood::Default;
+  llvm::Optional<Identifier> previous;
+  for (auto const& attribute : attributes) {
+    auto const& name = attribute.name;
+
+    if ((*name == "likely") || (*name == "unlikely")) {
+      if (checkFlagAttribute(attribute, previous)) {
+        likelihood = (*name == "likely") ? BranchLikelihood::Likely
+                                         : BranchLikelihood::Unlikely;
+      }
+    } else {
+      diagnoseAttributeNotApplicable(name, "if statements");
+    }
+  }
+  return likelihood;
+}
+
+void BasicTreeSupport::checkVarDeclType(Identifier const& type) {
+  if (*type != "int") {
+    diagnosticEngine()->diagnose(Diagnostic::ErrorOnlyIntPermitted, type, type);
+  }
+}
+
+llvm::Optional<RangeAnnotated<std::int32_t>>
+BasicTreeSupport::integerLiteralOf(Identifier const& rep) {
+  std::int32_t value;
+  if (rep->getString().getAsInteger(10U, value)) {
+    diagnosticEngine()->diagnose(Diagnostic::ErrorConvertionFailure, rep, rep);
+    return llvm::None;
+  }
+  return annotate(value, rep.getAnnotation());
+}
+
+RangeAnnotated<std::uint32_t>
+BasicTreeSupport::arraySizeOf(Identifier const& rep, Identifier const& name) {
+  std::uint32_t size;
+  if (rep->getString().getAsInteger(10U, size) || (size == 0U)) {
+    diagnosticEngine()->diagnose(Diagnostic::ErrorArraySizeInvalid, rep, rep,
+                                 name);
+    size = 1U;
+  }
+  return annotate(size, rep.getAnnotation());
+}
+
+bool BasicTreeSupport::checkFlagAttribute(
+    SourceAttribute const& attribute, llvm::Optional<Identifier>& previous) {
+
+  auto const& name = attribute.name;
+  if (!attribute.arguments.empty()) {
+    diagnosticEngine()->diagnose(Diagnostic::ErrorAttributeArgumentsUnexpected,
+                                 name, name);
+    return false;
+  }
+
+  if (previous) {
+    diagnosticEngine()->diagnose(Diagnostic::ErrorAttributeConflicting, name,
+                                 name, *previous);
+    diagnosticEngine()->diagnose(Diagnostic::NotePreviousAttributeHint,
+                                 *previous);
+    return false;
+  }
+
+  previous = name;
+  return true;
+}
+
+void BasicTreeSupport::diagnoseAttributeNotApplicable(
+    Identifier const& name, llvm::StringRef construct) {
+
+  auto isKnown = llvm::StringSwitch<bool>(name->getString())
+                     .Cases("target_clones", "inline", "noinline", true)
+                     .Cases("hot", "cold", "likely", "unlikely", true)
+                     .Default(false);
+
+  if (isKnown) {
+    diagnosticEngine()->diagnose(Diagnostic::ErrorAttributeNotApplicable, name,
+                                 name, construct);
+  } else {
+    diagnosticEngine()->diagnose(Diagnostic::ErrorAttributeUnknown, name,
+                                 name);
+  }
+}
@@ -18,23 +18,44 @@
 #ifndef BASIC_TREE_SUPPORT_HPP_INCLUDED__
 #define BASIC_TREE_SUPPORT_HPP_INCLUDED__
 
+#include <cstdint>
 #include <type_traits>
+#include <utility>
 
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/SmallVector.h"
+
+#include "AST.hpp"
 #include "ASTContext.hpp"
 #include "SourceAnnotated.hpp"
 
 class CompilationUnit;
 class DiagnosticEngine;
 
+/// Represents an attribute (`@name("argument", ...)`) as written in the source
+struct SourceAttribute {
+  Identifier name;
+  /// The string literal arguments without their quotes
+  llvm::SmallVector<Identifier, 2> arguments;
+
+  explicit SourceAttribute(Identifier name_) : name(std::move(name_)) {}
+};
+
 /// Provides basic support methods for building an AST
 class BasicTreeSupport {
 private:
   CompilationUnit* compilationUnit_;
   ASTContext* astContext_;
+  /// The DiagnosticEngine which is used instead of the one
+  /// of the CompilationUnit when it was set.
+  DiagnosticEngine* diagnosticEngine_;
 
 public:
-  BasicTreeSupport(CompilationUnit* compilationUnit, ASTContext* astContext)
-      : compilationUnit_(compilationUnit), astContext_(astContext) {}
+  BasicTreeSupport(CompilationUnit* compilationUnit, ASTContext* astContext,
+                   DiagnosticEngine* diagnosticEngine = nullptr)
+      : compilationUnit_(compilationUnit), astContext_(astContext),
+        diagnosticEngine_(diagnosticEngine) {}
 
   /// Returns the CompilationUnit for the current processed AST
   CompilationUnit* const& compilationUnit() const { return compilationUnit_; }
@@ -48,16 +69,37 @@ public:
   /// to emit messages about the source code
   DiagnosticEngine* diagnosticEngine() const;
 
-  /// Pools the given string into the ASTContext
-  llvm::StringRef poolString(llvm::StringRef str) const {
-    return astContext_->poolString(str);
-  }
-
   /// Annotates the given type with a source range
   template <typename T>
   RangeAnnotated<std::decay_t<T>> annotate(T type, SourceRange const& range) {
     return {std::move(type), range};
   }
+
+  /// Returns the function attributes specified through the given attributes
+  FunctionAttributes
+  functionAttributesOf(llvm::ArrayRef<SourceAttribute> attributes);
+  /// Returns the branch likelihood specified through the given attributes
+  BranchLikelihood
+  branchLikelihoodOf(llvm::ArrayRef<SourceAttribute> attributes);
+
+  /// Checks whether the type of a variable declaration is supported
+  void checkVarDeclType(Identifier const& type);
+  /// Returns the value of the given integer literal or none
+  /// when it isn't representable.
+  llvm::Optional<RangeAnnotated<std::int32_t>>
+  integerLiteralOf(Identifier const& rep);
+  /// Returns the size of the array with the given name
+  RangeAnnotated<std::uint32_t> arraySizeOf(Identifier const& rep,
+                                            Identifier const& name);
+
+private:
+  /// Returns true when the given flag attribute is applicable, which means
+  /// it has no arguments and there was no previous attribute of its group.
+  bool checkFlagAttribute(SourceAttribute const& attribute,
+                          llvm::Optional<Identifier>& previous);
+  /// Diagnoses an attribute which can't be applied to the given construct
+  void diagnoseAttributeNotApplicable(Identifier const& name,
+                                      llvm::StringRef construct);
 };
 
 #endif // #ifndef BASIC_TREE_VISITOR_HPP_INCLUDED__
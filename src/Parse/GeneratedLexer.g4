@@ -23,17 +23,23 @@ Return: 'return';
 Meta: 'meta';
 If: 'if';
 Else: 'else';
+Match: 'match';
 For: 'for';
 Break: 'break';
 Continue: 'continue';
+Import: 'import';
 
 OpenPar: '(';
 ClosePar: ')';
 OpenCurly: '{';
 CloseCurly: '}';
+OpenBracket: '[';
+CloseBracket: ']';
 Arrow: '->';
+FatArrow: '=>';
 Comma: ',';
 Semicolon: ';';
+At: '@';
 
 True: 'true';
 False: 'false';
@@ -41,6 +47,10 @@ False: 'false';
 IntegerLiteral: (OperatorPlus | OperatorMinus)? Digit+;
 fragment Digit: [0-9];
 
+StringLiteral: '"' ~["\r\n]* '"';
+
+Wildcard: '_';
+
 Identifier: LETTER (LETTER | Digit )*;
 fragment LETTER : [a-zA-Z_];
 
@@ -19,73 +19,76 @@ parser grammar GeneratedParser;
 
 options {
   tokenVocab = GeneratedLexer;
-  superClass=BasicParser;
   // contextSuperClass=MyRuleNode; // ParserRuleContext
 }
 
 @parser::header {
   #include "AST.hpp"
   #include "ASTScope.hpp"
-  #include "BasicParser.hpp"
 }
 
+// The grammar doesn't contain any semantic predicates, which would disable
+// the DFA caching of the prediction. Meta scopes are separate productions
+// instead, whereas the placement of meta statements inside statements
+// is checked by the LocalScopeListener.
+
 // Actual grammar start.
 compilationUnit
-  : (runtimeGlobalScopeNode | metaDecl)* EOF;
+  : importDecl* (functionDecl | metaDecl)* EOF;
 
-runtimeGlobalScopeNode
-  : functionDecl
-  | { isInMetaDecl() }? metaStmt
+importDecl
+  : Import StringLiteral Semicolon
   ;
 
 functionDecl
-  : Identifier OpenPar argumentDeclList ClosePar
-    returnDecl Arrow
-    { if (isInMetaDecl()) {
-        assert(isInMetaDepth(MetaDepth::DepthGlobalScope)); 
-        enterDepth(MetaDepth::DepthLocalScope);
-      }
-    }
-    statement
-    { if (isInMetaDecl()) {
-        leaveDepth();
-        assert(isInMetaDepth(MetaDepth::DepthGlobalScope)); 
-      }
-    };
+  : attribute* Identifier OpenPar argumentDeclList ClosePar
+    returnDecl Arrow statement
+  ;
+
+attribute
+  : At Identifier (OpenPar attributeArgumentList ClosePar)?
+  ;
+
+attributeArgumentList
+  : (StringLiteral (Comma StringLiteral)*)?
+  ;
 
 metaDecl
   : Identifier OperatorLessThan argumentDeclList OperatorGreaterThan Arrow
-    { assert(!isInMetaDecl()); enterDepth(MetaDepth::DepthGlobalScope); }
-      metaContribution
-    { leaveDepth(); assert(!isInMetaDecl()); }
+    metaGlobalContribution
   ;
 
-metaContribution
-  : /*(metaScopeNode | (*/ OpenCurly metaScopeNode* CloseCurly /*))*/
+// Contributes top level nodes like functions to an instantiation
+metaGlobalContribution
+  : OpenCurly metaGlobalScopeNode* CloseCurly
   ;
 
-metaScopeNode
-  : ({ isInMetaDepth(MetaDepth::DepthGlobalScope) }? runtimeGlobalScopeNode)
-  | ({ isInMetaDepth(MetaDepth::DepthLocalScope)  }? statement)
+metaGlobalScopeNode
+  : functionDecl
+  | metaCalculationStmt
+  | metaGlobalIfStmt
   ;
 
-metaStmt
-  : metaCalculationStmt
-  | metaIfStmt
+metaGlobalIfStmt
+  : Meta If expr metaGlobalContribution (Else metaGlobalContribution)?
   ;
 
-metaCalculationStmt
-  : { enterDepth(MetaDepth::DepthNone); }
-      Meta unscopedCompoundStmt
-    { leaveDepth(); }
+// Contributes statements or match arms to the body of a function
+metaLocalContribution
+  : OpenCurly metaLocalScopeNode* CloseCurly
+  ;
+
+metaLocalScopeNode
+  : statement
+  | matchArm
   ;
 
 metaIfStmt
-  : Meta If metaCalculationExpr metaContribution metaElseStmt?
+  : Meta If expr metaLocalContribution (Else metaLocalContribution)?
   ;
 
-metaElseStmt
-  : Else metaContribution
+metaCalculationStmt
+  : Meta unscopedCompoundStmt
   ;
 
 returnDecl
@@ -110,11 +113,14 @@ argumentName
 
 statement
   : declStmt
+  | arrayDeclStmt
   | exprStmt
   | returnStmt
   | ifStmt
+  | matchStmt
   | compoundStmt
-  | { isInMetaDecl() && !isInMetaDepth(MetaDepth::DepthNone) }? metaStmt
+  | metaCalculationStmt
+  | metaIfStmt
   ;
 
 compoundStmt
@@ -148,6 +154,11 @@ varDeclName
   : Identifier
   ;
 
+// Arrays are zero initialized since there are no initializer lists yet
+arrayDeclStmt
+  : varDeclType OpenBracket IntegerLiteral CloseBracket varDeclName Semicolon
+  ;
+
 exprStmt
   : expr Semicolon
   ;
@@ -157,20 +168,36 @@ returnStmt
   ;
 
 ifStmt
-  : If expr compoundStmt elseStmt?
+  : attribute* If expr compoundStmt elseStmt?
   ;
 
 elseStmt
   : Else compoundStmt
   ;
 
-metaCalculationExpr
-  : { enterDepth(MetaDepth::DepthNone); }
-      expr
-    { leaveDepth(); }
+matchStmt
+  : Match expr OpenCurly matchArmNode* CloseCurly
   ;
 
-// exprs with precedences
+// Arms of a match statement can be contributed through a meta if
+matchArmNode
+  : matchArm
+  | metaIfStmt
+  ;
+
+matchArm
+  : matchPattern FatArrow statement Comma?
+  ;
+
+matchPattern
+  : integerLiteralExpr
+  | declRefExpr
+  | Wildcard
+  ;
+
+// exprs with precedences, alternatives which are listed first bind
+// stronger. The levels of binary operators match the precedences of
+// EXPR_BINARY_OPERATOR in AST.inl.
 expr
   : unaryExpr
   | metaInstantiationExpr
@@ -178,7 +205,13 @@ expr
   | OpenPar expr ClosePar
   | integerLiteralExpr
   | booleanLiteralExpr
-  | expr binaryOperator expr
+  | expr OpenBracket expr CloseBracket
+  | expr (OperatorMul | OperatorDiv) expr
+  | expr (OperatorPlus | OperatorMinus) expr
+  | expr (OperatorLessThan | OperatorGreaterThan | OperatorLessThanOrEq
+         | OperatorGreaterThanOrEq) expr
+  | expr (OperatorEqual | OperatorNotEqual) expr
+  | <assoc = right> expr OperatorAssign expr
   ;
 
 unaryExpr
@@ -213,18 +246,3 @@ metaInstantiationExpr
   : declRefExpr OperatorLessThan exprList OperatorGreaterThan
   ;
 
-// No operator precedence support
-binaryOperator
-  : <assoc = right>OperatorAssign
-  | OperatorMul
-  | OperatorDiv
-  | OperatorPlus
-  | OperatorMinus
-  | OperatorLessThan
-  | OperatorGreaterThan
-  | OperatorLessThanOrEq
-  | OperatorGreaterThanOrEq
-  | OperatorEqual
-  | OperatorNotEqual
-  ;
-
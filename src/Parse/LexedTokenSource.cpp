@@ -0,0 +1,79 @@
+
+/**
+  Copyright(c) 2016 - 2017 Denis Blank <denis.blank at outlook dot com>
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+**/
+
+#include "LexedTokenSource.hpp"
+
+#include <cassert>
+#include <utility>
+
+#include "CommonToken.h"
+#include "CommonTokenFactory.h"
+#include "Token.h"
+
+LexedTokenSource::LexedTokenSource(llvm::StringRef source,
+                                   llvm::ArrayRef<LexedToken> tokens,
+                                   std::string sourceName)
+    : charStream_(source, std::move(sourceName)), tokens_(tokens) {
+  assert(!tokens_.empty() && (tokens_.back().kind == LexedToken::KindEOF) &&
+         "Expected the token array to be terminated by an EOF token!");
+}
+
+std::unique_ptr<antlr4::Token> LexedTokenSource::nextToken() {
+  // The EOF token is returned repeatedly once it was reached
+  auto const& lexed = tokens_[position_];
+  if (position_ + 1 < tokens_.size()) {
+    ++position_;
+  }
+
+  advanceLineTo(lexed.offset);
+
+  auto const isEOF = lexed.kind == LexedToken::KindEOF;
+  std::size_t const type = isEOF ? antlr4::Token::EOF : lexed.kind;
+  std::size_t const start = lexed.offset;
+  // Empty tokens are represented by a stop index in front of the start
+  std::size_t const stop = start + lexed.length - 1;
+
+  // The text isn't set explicitly, so it's read from the char stream
+  // only when it's requested.
+  auto token = std::make_unique<antlr4::CommonToken>(
+      std::make_pair(this, getInputStream()), type,
+      antlr4::Token::DEFAULT_CHANNEL, start, stop);
+  token->setLine(line_);
+  token->setCharPositionInLine(charPositionInLine_);
+  return std::move(token);
+}
+
+std::shared_ptr<antlr4::TokenFactory<antlr4::CommonToken>>
+LexedTokenSource::getTokenFactory() {
+  return antlr4::CommonTokenFactory::DEFAULT;
+}
+
+void LexedTokenSource::advanceLineTo(std::size_t offset) {
+  assert((offset >= lineOffset_) && "Expected the tokens to be ordered!");
+
+  // Tokens are requested in order, so every character of the source
+  // is visited only once for calculating the line information.
+  auto const source = charStream_.getSource();
+  for (auto current = lineOffset_; current != offset; ++current) {
+    if (source[current] == '\n') {
+      ++line_;
+      lineStartOffset_ = current + 1;
+    }
+  }
+  lineOffset_ = offset;
+  charPositionInLine_ = offset - lineStartOffset_;
+}
@@ -0,0 +1,72 @@
+
+/**
+  Copyright(c) 2016 - 2017 Denis Blank <denis.blank at outlook dot com>
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+**/
+
+#ifndef LEXED_TOKEN_SOURCE_HPP_INCLUDED__
+#define LEXED_TOKEN_SOURCE_HPP_INCLUDED__
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+
+#include "TokenSource.h"
+
+#include "SourceCharStream.hpp"
+#include "SourceLexer.hpp"
+
+/// Adapts the compact token array of the SourceLexer to the ANTLR
+/// TokenSource, so the tokens can be consumed by the GeneratedParser.
+/// Token objects are only materialized when the parser requests them,
+/// their text is read from the source buffer through the SourceCharStream.
+class LexedTokenSource : public antlr4::TokenSource {
+  SourceCharStream charStream_;
+  llvm::ArrayRef<LexedToken> tokens_;
+
+  /// The index of the next token
+  std::size_t position_ = 0;
+  /// The line and the position in line of the next token
+  std::size_t line_ = 1;
+  std::size_t charPositionInLine_ = 0;
+  /// The offset up to which the line information was calculated
+  std::size_t lineOffset_ = 0;
+  /// The offset of the line the line information was calculated for
+  std::size_t lineStartOffset_ = 0;
+
+public:
+  /// Creates the token source, where the token array needs to be
+  /// terminated by an EOF token.
+  LexedTokenSource(llvm::StringRef source, llvm::ArrayRef<LexedToken> tokens,
+                   std::string sourceName);
+
+  std::unique_ptr<antlr4::Token> nextToken() override;
+  std::size_t getLine() const override { return line_; }
+  std::size_t getCharPositionInLine() override { return charPositionInLine_; }
+  antlr4::CharStream* getInputStream() override { return &charStream_; }
+  std::string getSourceName() override {
+    return charStream_.getSourceName();
+  }
+  std::shared_ptr<antlr4::TokenFactory<antlr4::CommonToken>>
+  getTokenFactory() override;
+
+private:
+  /// Advances the line information to the given offset
+  void advanceLineTo(std::size_t offset);
+};
+
+#endif // #ifndef LEXED_TOKEN_SOURCE_HPP_INCLUDED__
@@ -0,0 +1,412 @@
+
+/**
+  Copyright(c) 2016 - 2017 Denis Blank <denis.blank at outlook dot com>
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+**/
+
+#include "LocalScopeListener.hpp"
+
+#include <cassert>
+#include <exception>
+#include <tuple>
+
+#include "llvm/Support/ErrorHandling.h"
+
+#include "AST.hpp"
+#include "DiagnosticEngine.hpp"
+
+void LocalScopeListener::enterEveryRule(antlr4::ParserRuleContext* context) {
+  // Left recursive rules are entered after their first child was parsed,
+  // which is re-parented to the entered context.
+  auto position = writer_.getPosition();
+  if (lastExited_ && (lastExited_->parent == context)) {
+    position = lastExitedPosition_;
+  }
+
+  frames_.push_back({context, position, false, true, nullptr});
+}
+
+void LocalScopeListener::exitEveryRule(antlr4::ParserRuleContext* context) {
+  assert((currentFrame().context == context) &&
+         "Expected the rules to be exited in order!");
+
+  if (currentFrame().isReduceRequired) {
+    writer_.markReduce();
+  }
+
+  lastExited_ = context;
+  lastExitedPosition_ = currentFrame().position;
+  frames_.pop_back();
+}
+
+void LocalScopeListener::visitTerminal(antlr4::tree::TerminalNode* node) {
+  if (isFailed()) {
+    return;
+  }
+
+  if ((node->getSymbol()->getType() == GeneratedParser::Meta) &&
+      !currentFrame().isMetaStmtAllowed) {
+    diagnosticEngine()->diagnose(Diagnostic::ErrorMetaStmtNotAllowed,
+                                 sourceRangeOf(node));
+  }
+}
+
+void LocalScopeListener::enterCompilationUnit(
+    GeneratedParser::CompilationUnitContext* /*context*/) {
+  writeOnEnter<CompilationUnitASTNode>();
+}
+
+void LocalScopeListener::exitImportDecl(
+    GeneratedParser::ImportDeclContext* context) {
+  if (isFailed()) {
+    return;
+  }
+
+  writeOnExit<ImportDeclASTNode>(stringLiteralOf(context->StringLiteral()));
+}
+
+void LocalScopeListener::enterFunctionDecl(
+    GeneratedParser::FunctionDeclContext* /*context*/) {
+  attributes_.emplace_back();
+}
+
+void LocalScopeListener::exitFunctionDecl(
+    GeneratedParser::FunctionDeclContext* context) {
+  auto attributes = attributes_.pop_back_val();
+  if (isFailed()) {
+    return;
+  }
+
+  auto name = identifierOf(context->Identifier());
+
+  writeOnExit<FunctionDeclASTNode>(name, functionAttributesOf(attributes));
+}
+
+void LocalScopeListener::enterAttribute(
+    GeneratedParser::AttributeContext* /*context*/) {
+  attributeArguments_.clear();
+}
+
+void LocalScopeListener::exitAttribute(
+    GeneratedParser::AttributeContext* context) {
+  if (isFailed()) {
+    return;
+  }
+
+  auto& attributes = attributes_.back();
+  attributes.emplace_back(identifierOf(context->Identifier()));
+  attributes.back().arguments = std::move(attributeArguments_);
+}
+
+void LocalScopeListener::exitAttributeArgumentList(
+    GeneratedParser::AttributeArgumentListContext* context) {
+  if (isFailed()) {
+    return;
+  }
+
+  for (auto argument : context->StringLiteral()) {
+    attributeArguments_.push_back(stringLiteralOf(argument));
+  }
+}
+
+void LocalScopeListener::enterArgumentDeclList(
+    GeneratedParser::ArgumentDeclListContext* /*context*/) {
+  writeOnEnter<ArgumentDeclListASTNode>();
+}
+
+void LocalScopeListener::enterArgumentDecl(
+    GeneratedParser::ArgumentDeclContext* /*context*/) {
+  argumentName_ = llvm::None;
+}
+
+void LocalScopeListener::exitArgumentDecl(
+    GeneratedParser::ArgumentDeclContext* /*context*/) {
+  if (isFailed()) {
+    return;
+  }
+
+  if (argumentName_) {
+    writeOnExit<NamedArgumentDeclASTNode>(*argumentName_);
+  } else {
+    writeOnExit<AnonymousArgumentDeclASTNode>();
+  }
+}
+
+void LocalScopeListener::exitArgumentName(
+    GeneratedParser::ArgumentNameContext* context) {
+  if (isFailed()) {
+    return;
+  }
+
+  argumentName_ = identifierOf(context->Identifier());
+}
+
+void LocalScopeListener::enterMetaDecl(
+    GeneratedParser::MetaDeclContext* /*context*/) {
+  isInMetaDecl_ = true;
+}
+
+void LocalScopeListener::exitMetaDecl(
+    GeneratedParser::MetaDeclContext* context) {
+  isInMetaDecl_ = false;
+  if (isFailed()) {
+    return;
+  }
+
+  auto name = identifierOf(context->Identifier());
+  writeOnExit<MetaDeclASTNode>(name);
+}
+
+void LocalScopeListener::exitMetaInstantiationExpr(
+    GeneratedParser::MetaInstantiationExprContext* context) {
+  if (isFailed()) {
+    return;
+  }
+
+  auto range = sourceRangeOf(context->OperatorLessThan(),
+                             context->OperatorGreaterThan());
+
+  writeOnExit<MetaInstantiationExprASTNode>(range);
+}
+
+void LocalScopeListener::exitMetaGlobalContribution(
+    GeneratedParser::MetaGlobalContributionContext* context) {
+  if (isFailed()) {
+    return;
+  }
+
+  auto range = sourceRangeOf(context->OpenCurly(), context->CloseCurly());
+  writeOnExit<MetaContributionASTNode>(range);
+}
+
+void LocalScopeListener::exitMetaLocalContribution(
+    GeneratedParser::MetaLocalContributionContext* context) {
+  if (isFailed()) {
+    return;
+  }
+
+  auto range = sourceRangeOf(context->OpenCurly(), context->CloseCurly());
+  writeOnExit<MetaContributionASTNode>(range);
+}
+
+void LocalScopeListener::exitDeclRefExpr(
+    GeneratedParser::DeclRefExprContext* context) {
+  if (isFailed()) {
+    return;
+  }
+
+  auto name = identifierOf(context->Identifier());
+  writeOnExit<DeclRefExprASTNode>(name);
+}
+
+void LocalScopeListener::exitIntegerLiteralExpr(
+    GeneratedParser::IntegerLiteralExprContext* context) {
+  if (isFailed()) {
+    return;
+  }
+
+  auto rep = identifierOf(context->IntegerLiteral());
+  if (auto value = integerLiteralOf(rep)) {
+    writeOnExit<IntegerLiteralExprASTNode>(*value);
+  } else {
+    writeOnExit<ErroneousExprASTNode>();
+  }
+}
+
+void LocalScopeListener::exitBooleanLiteralExpr(
+    GeneratedParser::BooleanLiteralExprContext* context) {
+  if (isFailed()) {
+    return;
+  }
+
+  auto rep = [&] {
+    if (context->True())
+      return std::make_tuple(true, identifierOf(context->True()));
+    else
+      return std::make_tuple(false, identifierOf(context->False()));
+  }();
+
+  auto annotated =
+      annotate(std::get<bool>(rep), std::get<Identifier>(rep).getAnnotation());
+
+  writeOnExit<BooleanLiteralExprASTNode>(annotated);
+}
+
+void LocalScopeListener::enterReturnStmt(
+    GeneratedParser::ReturnStmtContext* /*context*/) {
+  writeOnEnter<ReturnStmtASTNode>();
+}
+
+void LocalScopeListener::enterCompoundStmt(
+    GeneratedParser::CompoundStmtContext* /*context*/) {
+  writeOnEnter<CompoundStmtASTNode>();
+}
+
+void LocalScopeListener::enterUnscopedCompoundStmt(
+    GeneratedParser::UnscopedCompoundStmtContext* /*context*/) {
+  writeOnEnter<UnscopedCompoundStmtASTNode>();
+}
+
+llvm::Optional<RangeAnnotated<ExprBinaryOperator>>
+LocalScopeListener::getBinaryOperatorOf(GeneratedParser::ExprContext* context) {
+#define EXPR_BINARY_OPERATOR(NAME, REP, ...)                                   \
+  if (context->Operator##NAME())                                               \
+    return annotate(ExprBinaryOperator::Operator##NAME,                        \
+                    sourceRangeOf(context->Operator##NAME()));
+#include "AST.inl"
+  return llvm::None;
+}
+
+void LocalScopeListener::exitExpr(GeneratedParser::ExprContext* context) {
+  if (isFailed()) {
+    return;
+  }
+
+  if (auto binaryOperator = getBinaryOperatorOf(context)) {
+    writeOnExit<BinaryOperatorExprASTNode>(*binaryOperator);
+  } else if (context->OpenBracket()) {
+    auto range = sourceRangeOf(context->OpenBracket(), context->CloseBracket());
+    writeOnExit<ArraySubscriptExprASTNode>(range);
+  }
+}
+
+void LocalScopeListener::enterExprStmt(
+    GeneratedParser::ExprStmtContext* /*context*/) {
+  writeOnEnter<ExpressionStmtASTNode>();
+}
+
+void LocalScopeListener::exitVarDeclType(
+    GeneratedParser::VarDeclTypeContext* context) {
+  if (isFailed()) {
+    return;
+  }
+
+  checkVarDeclType(identifierOf(context->Identifier()));
+}
+
+void LocalScopeListener::exitVarDeclName(
+    GeneratedParser::VarDeclNameContext* context) {
+  if (isFailed()) {
+    return;
+  }
+
+  varDeclName_ = identifierOf(context->Identifier());
+}
+
+void LocalScopeListener::exitDeclStmt(
+    GeneratedParser::DeclStmtContext* /*context*/) {
+  if (isFailed()) {
+    return;
+  }
+
+  writeOnExit<DeclStmtASTNode>(*varDeclName_);
+}
+
+void LocalScopeListener::exitArrayDeclStmt(
+    GeneratedParser::ArrayDeclStmtContext* context) {
+  if (isFailed()) {
+    return;
+  }
+
+  auto name = *varDeclName_;
+  auto size = arraySizeOf(identifierOf(context->IntegerLiteral()), name);
+  writeOnExit<ArrayDeclStmtASTNode>(name, size);
+}
+
+void LocalScopeListener::enterIfStmt(
+    GeneratedParser::IfStmtContext* /*context*/) {
+  attributes_.emplace_back();
+}
+
+void LocalScopeListener::exitIfStmt(
+    GeneratedParser::IfStmtContext* /*context*/) {
+  auto attributes = attributes_.pop_back_val();
+  if (isFailed()) {
+    return;
+  }
+
+  writeOnExit<IfStmtASTNode>(branchLikelihoodOf(attributes));
+}
+
+void LocalScopeListener::exitMatchStmt(
+    GeneratedParser::MatchStmtContext* context) {
+  if (isFailed()) {
+    return;
+  }
+
+  auto range = sourceRangeOf(context->Match());
+  writeOnExit<MatchStmtASTNode>(range);
+}
+
+void LocalScopeListener::exitMatchPattern(
+    GeneratedParser::MatchPatternContext* context) {
+  if (isFailed()) {
+    return;
+  }
+
+  parentFrame().wildcard = context->Wildcard();
+}
+
+void LocalScopeListener::exitMatchArm(
+    GeneratedParser::MatchArmContext* context) {
+  if (isFailed()) {
+    return;
+  }
+
+  auto range = sourceRangeOf(context->FatArrow());
+  if (auto wildcard = currentFrame().wildcard) {
+    range = sourceRangeOf(wildcard, context->FatArrow());
+  }
+  writeOnExit<MatchArmASTNode>(range);
+}
+
+void LocalScopeListener::enterMetaGlobalIfStmt(
+    GeneratedParser::MetaGlobalIfStmtContext* /*context*/) {
+  writeOnEnter<MetaIfStmtASTNode>();
+}
+
+void LocalScopeListener::enterMetaIfStmt(
+    GeneratedParser::MetaIfStmtContext* /*context*/) {
+  currentFrame().isMetaStmtAllowed =
+      isInMetaDecl_ && (metaCalculationDepth_ == 0);
+  writeOnEnter<MetaIfStmtASTNode>();
+}
+
+void LocalScopeListener::enterMetaCalculationStmt(
+    GeneratedParser::MetaCalculationStmtContext* /*context*/) {
+  currentFrame().isMetaStmtAllowed =
+      isInMetaDecl_ && (metaCalculationDepth_ == 0);
+  ++metaCalculationDepth_;
+  writeOnEnter<MetaCalculationStmtASTNode>();
+}
+
+void LocalScopeListener::exitMetaCalculationStmt(
+    GeneratedParser::MetaCalculationStmtContext* /*context*/) {
+  --metaCalculationDepth_;
+}
+
+void LocalScopeListener::enterCallOperatorExpr(
+    GeneratedParser::CallOperatorExprContext* /*context*/) {
+  writeOnEnter<CallOperatorExprASTNode>();
+}
+
+bool LocalScopeListener::isFailed() {
+  // Rules are also exited while the stack is unwound on a cancelled parse,
+  // and syntax errors are recovered through incomplete contexts.
+  if (!failed_ && (std::uncaught_exception() ||
+                   (parser_->getNumberOfSyntaxErrors() != 0))) {
+    failed_ = true;
+  }
+  return failed_;
+}
@@ -0,0 +1,215 @@
+
+/**
+  Copyright(c) 2016 - 2017 Denis Blank <denis.blank at outlook dot com>
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+**/
+
+#ifndef LOCAL_SCOPE_LISTENER_HPP_INCLUDED__
+#define LOCAL_SCOPE_LISTENER_HPP_INCLUDED__
+
+#include <cstddef>
+
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/SmallVector.h"
+
+#include "ASTLayout.hpp"
+#include "BasicTreeListener.hpp"
+
+/// Writes the ASTLayout while the GeneratedParser recognizes the source.
+///
+/// The listener is registered as parse listener of a GeneratedParser
+/// which doesn't build a parse tree. Thus a rule context only contains
+/// its own tokens when the rule is exited, but not the contexts of its
+/// child rules. Nodes which don't depend on any token are written when
+/// their rule is entered, all other nodes are written in front of their
+/// children when their rule is exited. Child rules which don't produce
+/// nodes on their own, like attributes, contribute to their parent rule
+/// when they are exited.
+///
+/// The listener stops writing the layout on the first syntax error,
+/// since the layout of an erroneous source isn't used anyway.
+class LocalScopeListener : public BasicTreeListener {
+  /// Represents a rule which was entered but not exited yet
+  struct RuleFrame {
+    antlr4::ParserRuleContext* context;
+    /// The layout position of the first node written inside the rule
+    std::size_t position;
+    /// Is true when the node written on entering requires a reduce marker
+    bool isReduceRequired;
+    /// Is true when a meta statement is allowed in place of the rule
+    bool isMetaStmtAllowed;
+    /// The wildcard pattern of a match arm
+    antlr4::tree::TerminalNode* wildcard;
+  };
+
+  antlr4::Parser* parser_;
+  ASTLayoutWriter writer_;
+  llvm::SmallVector<RuleFrame, 32> frames_;
+  /// The context and layout position of the rule which was exited last
+  antlr4::ParserRuleContext* lastExited_ = nullptr;
+  std::size_t lastExitedPosition_ = 0;
+
+  /// The attributes of the enclosing function decls and if stmts
+  llvm::SmallVector<llvm::SmallVector<SourceAttribute, 2>, 4> attributes_;
+  /// The arguments of the attribute which is currently parsed
+  llvm::SmallVector<Identifier, 2> attributeArguments_;
+  /// The name of the argument decl which is currently parsed
+  llvm::Optional<Identifier> argumentName_;
+  /// The name of the variable decl which is currently parsed
+  llvm::Optional<Identifier> varDeclName_;
+
+  /// Is true while parsing the children of a meta decl
+  bool isInMetaDecl_ = false;
+  /// The count of meta calculations which are currently parsed
+  std::size_t metaCalculationDepth_ = 0;
+  /// Is set when the contexts of the parser became incomplete
+  bool failed_ = false;
+
+public:
+  /// Creates the listener for the given parser.
+  /// Diagnostics are emitted through the given DiagnosticEngine when
+  /// it's present, otherwise through the one of the CompilationUnit.
+  LocalScopeListener(CompilationUnit* compilationUnit, ASTContext* astContext,
+                     antlr4::Parser* parser,
+                     DiagnosticEngine* diagnosticEngine = nullptr)
+      : BasicTreeListener(compilationUnit, astContext, diagnosticEngine),
+        parser_(parser) {}
+
+  ASTLayout buildLayout() && { return std::move(writer_).buildLayout(); }
+
+  void enterEveryRule(antlr4::ParserRuleContext* context) override;
+  void exitEveryRule(antlr4::ParserRuleContext* context) override;
+  void visitTerminal(antlr4::tree::TerminalNode* node) override;
+
+  void enterCompilationUnit(
+      GeneratedParser::CompilationUnitContext* context) override;
+
+  void exitImportDecl(GeneratedParser::ImportDeclContext* context) override;
+
+  void
+  enterFunctionDecl(GeneratedParser::FunctionDeclContext* context) override;
+  void exitFunctionDecl(GeneratedParser::FunctionDeclContext* context) override;
+
+  void enterAttribute(GeneratedParser::AttributeContext* context) override;
+  void exitAttribute(GeneratedParser::AttributeContext* context) override;
+
+  void exitAttributeArgumentList(
+      GeneratedParser::AttributeArgumentListContext* context) override;
+
+  void enterArgumentDeclList(
+      GeneratedParser::ArgumentDeclListContext* context) override;
+
+  void
+  enterArgumentDecl(GeneratedParser::ArgumentDeclContext* context) override;
+  void exitArgumentDecl(GeneratedParser::ArgumentDeclContext* context) override;
+
+  void
+  exitArgumentName(GeneratedParser::ArgumentNameContext* context) override;
+
+  void enterMetaDecl(GeneratedParser::MetaDeclContext* context) override;
+  void exitMetaDecl(GeneratedParser::MetaDeclContext* context) override;
+
+  void exitMetaInstantiationExpr(
+      GeneratedParser::MetaInstantiationExprContext* context) override;
+
+  void exitMetaGlobalContribution(
+      GeneratedParser::MetaGlobalContributionContext* context) override;
+
+  void exitMetaLocalContribution(
+      GeneratedParser::MetaLocalContributionContext* context) override;
+
+  void exitDeclRefExpr(GeneratedParser::DeclRefExprContext* context) override;
+
+  void exitIntegerLiteralExpr(
+      GeneratedParser::IntegerLiteralExprContext* context) override;
+
+  void exitBooleanLiteralExpr(
+      GeneratedParser::BooleanLiteralExprContext* context) override;
+
+  void enterReturnStmt(GeneratedParser::ReturnStmtContext* context) override;
+
+  void
+  enterCompoundStmt(GeneratedParser::CompoundStmtContext* context) override;
+
+  void enterUnscopedCompoundStmt(
+      GeneratedParser::UnscopedCompoundStmtContext* context) override;
+
+  void exitExpr(GeneratedParser::ExprContext* context) override;
+
+  void enterExprStmt(GeneratedParser::ExprStmtContext* context) override;
+
+  void exitVarDeclType(GeneratedParser::VarDeclTypeContext* context) override;
+
+  void exitVarDeclName(GeneratedParser::VarDeclNameContext* context) override;
+
+  void exitDeclStmt(GeneratedParser::DeclStmtContext* context) override;
+
+  void
+  exitArrayDeclStmt(GeneratedParser::ArrayDeclStmtContext* context) override;
+
+  void enterIfStmt(GeneratedParser::IfStmtContext* context) override;
+  void exitIfStmt(GeneratedParser::IfStmtContext* context) override;
+
+  void exitMatchStmt(GeneratedParser::MatchStmtContext* context) override;
+
+  void
+  exitMatchPattern(GeneratedParser::MatchPatternContext* context) override;
+
+  void exitMatchArm(GeneratedParser::MatchArmContext* context) override;
+
+  void enterMetaGlobalIfStmt(
+      GeneratedParser::MetaGlobalIfStmtContext* context) override;
+
+  void enterMetaIfStmt(GeneratedParser::MetaIfStmtContext* context) override;
+
+  void enterMetaCalculationStmt(
+      GeneratedParser::MetaCalculationStmtContext* context) override;
+  void exitMetaCalculationStmt(
+      GeneratedParser::MetaCalculationStmtContext* context) override;
+
+  void enterCallOperatorExpr(
+      GeneratedParser::CallOperatorExprContext* context) override;
+
+private:
+  /// Returns true when the contexts became incomplete because of a
+  /// syntax error or a cancelled parse, which stops writing the layout.
+  bool isFailed();
+
+  /// Returns the frame of the rule which is currently parsed
+  RuleFrame& currentFrame() { return frames_.back(); }
+  /// Returns the frame of the parent of the rule which is currently parsed
+  RuleFrame& parentFrame() { return frames_[frames_.size() - 2]; }
+
+  /// Writes the node when the current rule is entered,
+  /// it's reduced when the rule is exited.
+  template <typename T, typename... Args> void writeOnEnter(Args&&... args) {
+    auto node = allocate<T>(std::forward<Args>(args)...);
+    writer_.directWrite(node);
+    currentFrame().isReduceRequired =
+        ASTLayoutWriter::isNodeRequiringReduceMarker(node);
+  }
+
+  /// Writes the node in front of all nodes which were written
+  /// since the current rule was entered.
+  template <typename T, typename... Args> void writeOnExit(Args&&... args) {
+    writer_.writeParent(currentFrame().position,
+                        allocate<T>(std::forward<Args>(args)...));
+  }
+
+  /// Returns the operator of the given binary expression
+  llvm::Optional<RangeAnnotated<ExprBinaryOperator>>
+  getBinaryOperatorOf(GeneratedParser::ExprContext* context);
+};
+
+#endif // #ifndef LOCAL_SCOPE_LISTENER_HPP_INCLUDED__
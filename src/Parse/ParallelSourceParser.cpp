@@ -0,0 +1,181 @@
+
+/**
+  Copyright(c) 2016 - 2017 Denis Blank <denis.blank at outlook dot com>
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+**/
+
+#include "ParallelSourceParser.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "llvm/Support/ThreadPool.h"
+
+#include "GeneratedLexer.h"
+
+#include "AST.hpp"
+#include "ASTContext.hpp"
+#include "CompilationUnit.hpp"
+#include "DiagnosticEngine.hpp"
+#include "SourceParser.hpp"
+
+/// The minimal count of tokens a chunk consists of, which keeps the
+/// overhead of the worker threads small compared to the parsing itself.
+static constexpr std::size_t MinTokensPerChunk = 1U << 13U;
+
+/// Represents a parsed chunk of top level declarations
+struct ParallelSourceParser::Chunk {
+  std::unique_ptr<ASTContext> astContext;
+  DiagnosticEngine diagnosticEngine;
+  ASTLayout layout;
+  bool succeeded;
+
+  explicit Chunk(CompilationUnit const* compilationUnit)
+      : astContext(std::make_unique<ASTContext>()),
+        diagnosticEngine(DiagnosticEngine::CreateDeferred(compilationUnit)),
+        succeeded(false) {}
+};
+
+/// Returns true when the token at the given index starts
+/// a function or meta declaration.
+static bool isTopLevelDeclStart(llvm::ArrayRef<LexedToken> tokens,
+                                std::size_t index) {
+  switch (tokens[index].kind) {
+    case GeneratedLexer::At:
+      return true;
+    case GeneratedLexer::Identifier:
+      return (tokens[index + 1].kind == GeneratedLexer::OpenPar) ||
+             (tokens[index + 1].kind == GeneratedLexer::OperatorLessThan);
+    default:
+      return false;
+  }
+}
+
+/// Splits the tokens into at most the given count of chunks, where every
+/// chunk consists of at least the given count of tokens.
+static llvm::SmallVector<std::size_t, 8>
+splitIntoChunks(llvm::ArrayRef<LexedToken> tokens, unsigned maxChunks,
+                std::size_t minTokensPerChunk) {
+  assert(!tokens.empty() && (tokens.back().kind == LexedToken::KindEOF) &&
+         "Expected the token array to be terminated by an EOF token!");
+
+  llvm::SmallVector<std::size_t, 8> boundaries{0};
+  auto const count = tokens.size() - 1;
+  if ((maxChunks < 2) || (count < 2 * minTokensPerChunk)) {
+    return boundaries;
+  }
+  auto const tokensPerChunk = std::max(minTokensPerChunk, count / maxChunks);
+
+  // A top level declaration can only start behind the end of a previous
+  // declaration, which ends with a closing curly brace or a semicolon
+  // outside of any braces.
+  std::size_t depth = 0;
+  for (std::size_t i = 1; i < count; ++i) {
+    switch (tokens[i - 1].kind) {
+      case GeneratedLexer::OpenCurly:
+        ++depth;
+        continue;
+      case GeneratedLexer::CloseCurly:
+        if (depth == 0) {
+          // Let the sequential parser report the unbalanced brace
+          return {0};
+        }
+        --depth;
+        break;
+      case GeneratedLexer::Semicolon:
+        break;
+      default:
+        continue;
+    }
+
+    if ((depth == 0) && (i - boundaries.back() >= tokensPerChunk) &&
+        (count - i >= minTokensPerChunk) && isTopLevelDeclStart(tokens, i)) {
+      boundaries.push_back(i);
+      if (boundaries.size() == maxChunks) {
+        break;
+      }
+    }
+  }
+  return boundaries;
+}
+
+llvm::SmallVector<std::size_t, 8>
+ParallelSourceParser::splitTopLevelDecls(llvm::ArrayRef<LexedToken> tokens,
+                                         unsigned maxChunks) {
+  return splitIntoChunks(tokens, maxChunks, MinTokensPerChunk);
+}
+
+llvm::SmallVector<std::size_t, 8>
+ParallelSourceParser::splitEachTopLevelDecl(llvm::ArrayRef<LexedToken> tokens) {
+  return splitIntoChunks(tokens, std::numeric_limits<unsigned>::max(), 1);
+}
+
+bool ParallelSourceParser::parse() {
+  auto const boundaries = splitTopLevelDecls(tokens_, threadCount_);
+  if (boundaries.size() == 1) {
+    SourceParser parser(compilationUnit_, astContext_, source_, tokens_);
+    auto const succeeded = parser.parse();
+    writer_ = ASTLayoutWriter(std::move(parser).buildLayout());
+    return succeeded;
+  }
+
+  std::vector<Chunk> chunks;
+  chunks.reserve(boundaries.size());
+  {
+    llvm::ThreadPool pool(threadCount_);
+    for (std::size_t i = 0; i < boundaries.size(); ++i) {
+      auto const begin = boundaries[i];
+      auto const end = (i + 1 < boundaries.size()) ? boundaries[i + 1]
+                                                   : tokens_.size() - 1;
+      chunks.emplace_back(compilationUnit_);
+      auto& chunk = chunks.back();
+      pool.async([this, &chunk, begin, end] { parseChunk(chunk, begin, end); });
+    }
+    pool.wait();
+  }
+
+  // Concatenate the fragments in source order and stop at the first chunk
+  // which failed, so the same diagnostics are displayed as when parsing
+  // the source sequentially.
+  auto scope = writer_.scopedWrite(
+      astContext_->allocate<CompilationUnitASTNode>());
+  for (auto& chunk : chunks) {
+    chunk.diagnosticEngine.replayInto(compilationUnit_->getDiagnosticEngine());
+    writer_.append(chunk.layout);
+    astContext_->adopt(std::move(chunk.astContext));
+
+    if (!chunk.succeeded) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void ParallelSourceParser::parseChunk(Chunk& chunk, std::size_t begin,
+                                      std::size_t end) const {
+  // Every chunk is terminated by an EOF token placed at the start
+  // of the following chunk.
+  std::vector<LexedToken> tokens(tokens_.begin() + begin,
+                                 tokens_.begin() + end);
+  tokens.push_back({tokens_[end].offset, 0, LexedToken::KindEOF});
+
+  SourceParser parser(compilationUnit_, chunk.astContext.get(), source_,
+                      tokens, &chunk.diagnosticEngine);
+  chunk.succeeded = parser.parseTopLevelDecls();
+  chunk.layout = std::move(parser).buildLayout();
+}
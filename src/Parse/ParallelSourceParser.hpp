@@ -0,0 +1,86 @@
+
+/**
+  Copyright(c) 2016 - 2017 Denis Blank <denis.blank at outlook dot com>
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+**/
+
+#ifndef PARALLEL_SOURCE_PARSER_HPP_INCLUDED__
+#define PARALLEL_SOURCE_PARSER_HPP_INCLUDED__
+
+#include <cstddef>
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+
+#include "ASTLayout.hpp"
+#include "SourceLexer.hpp"
+
+class ASTContext;
+class CompilationUnit;
+
+/// Parses the top level declarations of a compilation unit in parallel.
+///
+/// Top level declarations are independent from each other for parsing,
+/// only the two phase lookup of the ASTLayoutReader needs all of them.
+/// Thus the token array is split at the boundaries of top level
+/// declarations into chunks, which are parsed into layout fragments on
+/// worker threads, where every chunk has its own ASTContext and a deferred
+/// DiagnosticEngine. The fragments are concatenated in source order
+/// afterwards, which results in the same layout as a sequential parse.
+///
+/// Sources which are too small to benefit from the parallelism
+/// are parsed sequentially.
+class ParallelSourceParser {
+  struct Chunk;
+
+  CompilationUnit* compilationUnit_;
+  ASTContext* astContext_;
+  llvm::StringRef source_;
+  llvm::ArrayRef<LexedToken> tokens_;
+  unsigned threadCount_;
+  ASTLayoutWriter writer_;
+
+public:
+  /// Creates the parser, where the token array needs to be
+  /// terminated by an EOF token.
+  /// The ASTContext adopts the ASTContexts of all chunks.
+  ParallelSourceParser(CompilationUnit* compilationUnit, ASTContext* astContext,
+                       llvm::StringRef source,
+                       llvm::ArrayRef<LexedToken> tokens, unsigned threadCount)
+      : compilationUnit_(compilationUnit), astContext_(astContext),
+        source_(source), tokens_(tokens), threadCount_(threadCount) {}
+
+  /// Parses the compilation unit and returns true on success
+  bool parse();
+
+  ASTLayout buildLayout() && { return std::move(writer_).buildLayout(); }
+
+  /// Splits the given EOF terminated token array at the boundaries of
+  /// top level declarations into at most the given count of chunks,
+  /// and returns the index of the first token of every chunk.
+  static llvm::SmallVector<std::size_t, 8>
+  splitTopLevelDecls(llvm::ArrayRef<LexedToken> tokens, unsigned maxChunks);
+  /// Splits the given EOF terminated token array at the boundaries of all
+  /// top level declarations, and returns the index of the first token of
+  /// every declaration.
+  static llvm::SmallVector<std::size_t, 8>
+  splitEachTopLevelDecl(llvm::ArrayRef<LexedToken> tokens);
+
+private:
+  /// Parses the tokens of the given range into the chunk
+  void parseChunk(Chunk& chunk, std::size_t begin, std::size_t end) const;
+};
+
+#endif // #ifndef PARALLEL_SOURCE_PARSER_HPP_INCLUDED__
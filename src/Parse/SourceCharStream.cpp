@@ -0,0 +1,74 @@
+
+/**
+  Copyright(c) 2016 - 2017 Denis Blank <denis.blank at outlook dot com>
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+**/
+
+#include "SourceCharStream.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+#include "misc/Interval.h"
+
+SourceCharStream::SourceCharStream(llvm::StringRef source,
+                                   std::string sourceName)
+    : source_(source), sourceName_(std::move(sourceName)) {}
+
+llvm::StringRef SourceCharStream::getTextRef(std::size_t start,
+                                             std::size_t stop) const {
+  if ((start >= source_.size()) || (stop < start)) {
+    return {};
+  }
+  stop = std::min(stop, source_.size() - 1);
+  return source_.slice(start, stop + 1);
+}
+
+void SourceCharStream::consume() {
+  assert((position_ < source_.size()) && "Can't consume the EOF!");
+  ++position_;
+}
+
+std::size_t SourceCharStream::LA(ssize_t i) {
+  if (i == 0) {
+    // The behaviour is undefined for a lookahead of zero
+    return 0;
+  }
+  if (i < 0) {
+    // LA(-1) returns the previously consumed character
+    ++i;
+    if (ssize_t(position_) + i - 1 < 0) {
+      return antlr4::IntStream::EOF;
+    }
+  }
+
+  auto const position = position_ + i - 1;
+  if (position >= source_.size()) {
+    return antlr4::IntStream::EOF;
+  }
+  return static_cast<unsigned char>(source_[position]);
+}
+
+void SourceCharStream::seek(std::size_t index) {
+  position_ = std::min(index, source_.size());
+}
+
+std::string
+SourceCharStream::getText(antlr4::misc::Interval const& interval) {
+  if ((interval.a < 0) || (interval.b < 0)) {
+    return {};
+  }
+  return getTextRef(std::size_t(interval.a), std::size_t(interval.b)).str();
+}
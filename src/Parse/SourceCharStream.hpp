@@ -0,0 +1,60 @@
+
+/**
+  Copyright(c) 2016 - 2017 Denis Blank <denis.blank at outlook dot com>
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+**/
+
+#ifndef SOURCE_CHAR_STREAM_HPP_INCLUDED__
+#define SOURCE_CHAR_STREAM_HPP_INCLUDED__
+
+#include <cstddef>
+#include <string>
+
+#include "llvm/ADT/StringRef.h"
+
+#include "CharStream.h"
+
+/// A character stream which reads the bytes of the source buffer in place.
+/// Since the grammar is ASCII only the source doesn't need to be copied
+/// and widened like it's done by the antlr4::ANTLRInputStream.
+///
+/// The text of tokens referring to this stream is created from the source
+/// buffer on request, so the tokens don't need to store their text.
+class SourceCharStream : public antlr4::CharStream {
+  llvm::StringRef source_;
+  std::string sourceName_;
+  std::size_t position_ = 0;
+
+public:
+  SourceCharStream(llvm::StringRef source, std::string sourceName);
+
+  /// Returns the source buffer the stream is reading from
+  llvm::StringRef getSource() const { return source_; }
+  /// Returns the text of the source buffer inside the given bounds
+  llvm::StringRef getTextRef(std::size_t start, std::size_t stop) const;
+
+  void consume() override;
+  std::size_t LA(ssize_t i) override;
+  // Marks aren't required since the whole source is always available
+  ssize_t mark() override { return -1; }
+  void release(ssize_t /*marker*/) override {}
+  std::size_t index() override { return position_; }
+  void seek(std::size_t index) override;
+  std::size_t size() override { return source_.size(); }
+  std::string getSourceName() const override { return sourceName_; }
+  std::string getText(antlr4::misc::Interval const& interval) override;
+  std::string toString() const override { return source_.str(); }
+};
+
+#endif // #ifndef SOURCE_CHAR_STREAM_HPP_INCLUDED__
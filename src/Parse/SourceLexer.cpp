@@ -0,0 +1,390 @@
+
+/**
+  Copyright(c) 2016 - 2017 Denis Blank <denis.blank at outlook dot com>
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+**/
+
+#include "SourceLexer.hpp"
+
+#include <array>
+#include <cassert>
+#include <cstring>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SOURCE_LEXER_USE_SSE2
+#endif
+
+#include "llvm/ADT/StringSwitch.h"
+#include "llvm/Support/MathExtras.h"
+
+#include "GeneratedLexer.h"
+
+#include "CompilationUnit.hpp"
+
+namespace {
+/// Represents the class of a character which selects
+/// the starting state of the lexer DFA.
+enum CharClass : std::uint8_t {
+  ClassInvalid,
+  ClassWhitespace,
+  ClassLetter,
+  ClassDigit,
+  ClassOperator
+};
+} // namespace
+
+/// Returns the table which maps every character to its class
+static std::array<CharClass, 256> const& getCharClassTable() {
+  static auto const table = [] {
+    std::array<CharClass, 256> classes;
+    classes.fill(ClassInvalid);
+    for (unsigned char c : llvm::StringRef(" \t\r\n")) {
+      classes[c] = ClassWhitespace;
+    }
+    for (unsigned char c = 'a'; c <= 'z'; ++c) {
+      classes[c] = ClassLetter;
+      classes[c - 'a' + 'A'] = ClassLetter;
+    }
+    classes['_'] = ClassLetter;
+    for (unsigned char c = '0'; c <= '9'; ++c) {
+      classes[c] = ClassDigit;
+    }
+    for (unsigned char c : llvm::StringRef("(){}[],;@\"*/+-=<>!")) {
+      classes[c] = ClassOperator;
+    }
+    return classes;
+  }();
+  return table;
+}
+
+static CharClass classOf(char c) {
+  return getCharClassTable()[static_cast<unsigned char>(c)];
+}
+
+/// Lists all token kinds together with their display name
+#define FOR_EACH_TOKEN_KIND(TOKEN_KIND)                                        \
+  TOKEN_KIND(Return, "'return'")                                               \
+  TOKEN_KIND(Meta, "'meta'")                                                   \
+  TOKEN_KIND(If, "'if'")                                                       \
+  TOKEN_KIND(Else, "'else'")                                                   \
+  TOKEN_KIND(Match, "'match'")                                                 \
+  TOKEN_KIND(For, "'for'")                                                     \
+  TOKEN_KIND(Break, "'break'")                                                 \
+  TOKEN_KIND(Continue, "'continue'")                                           \
+  TOKEN_KIND(Import, "'import'")                                               \
+  TOKEN_KIND(OpenPar, "'('")                                                   \
+  TOKEN_KIND(ClosePar, "')'")                                                  \
+  TOKEN_KIND(OpenCurly, "'{'")                                                 \
+  TOKEN_KIND(CloseCurly, "'}'")                                                \
+  TOKEN_KIND(OpenBracket, "'['")                                               \
+  TOKEN_KIND(CloseBracket, "']'")                                              \
+  TOKEN_KIND(Arrow, "'->'")                                                    \
+  TOKEN_KIND(FatArrow, "'=>'")                                                 \
+  TOKEN_KIND(Comma, "','")                                                     \
+  TOKEN_KIND(Semicolon, "';'")                                                 \
+  TOKEN_KIND(At, "'@'")                                                        \
+  TOKEN_KIND(True, "'true'")                                                   \
+  TOKEN_KIND(False, "'false'")                                                 \
+  TOKEN_KIND(IntegerLiteral, "IntegerLiteral")                                 \
+  TOKEN_KIND(StringLiteral, "StringLiteral")                                   \
+  TOKEN_KIND(Wildcard, "'_'")                                                  \
+  TOKEN_KIND(Identifier, "Identifier")                                         \
+  TOKEN_KIND(OperatorMul, "'*'")                                               \
+  TOKEN_KIND(OperatorDiv, "'/'")                                               \
+  TOKEN_KIND(OperatorPlus, "'+'")                                              \
+  TOKEN_KIND(OperatorMinus, "'-'")                                             \
+  TOKEN_KIND(OperatorAssign, "'='")                                            \
+  TOKEN_KIND(OperatorLessThan, "'<'")                                          \
+  TOKEN_KIND(OperatorGreaterThan, "'>'")                                       \
+  TOKEN_KIND(OperatorLessThanOrEq, "'<='")                                     \
+  TOKEN_KIND(OperatorGreaterThanOrEq, "'>='")                                  \
+  TOKEN_KIND(OperatorEqual, "'=='")                                            \
+  TOKEN_KIND(OperatorNotEqual, "'!='")
+
+llvm::StringRef getTokenKindName(std::size_t kind) {
+  switch (kind) {
+#define TOKEN_KIND_NAME(NAME, DISPLAY)                                         \
+  case GeneratedLexer::NAME:                                                   \
+    return #NAME;
+    FOR_EACH_TOKEN_KIND(TOKEN_KIND_NAME)
+#undef TOKEN_KIND_NAME
+    default:
+      return "EOF";
+  }
+}
+
+llvm::StringRef getTokenDisplayName(std::size_t kind) {
+  switch (kind) {
+#define TOKEN_KIND_DISPLAY_NAME(NAME, DISPLAY)                                 \
+  case GeneratedLexer::NAME:                                                   \
+    return DISPLAY;
+    FOR_EACH_TOKEN_KIND(TOKEN_KIND_DISPLAY_NAME)
+#undef TOKEN_KIND_DISPLAY_NAME
+    default:
+      return "<EOF>";
+  }
+}
+
+std::vector<LexedToken> SourceLexer::lex() {
+  assert((source_.size() < std::numeric_limits<std::uint32_t>::max()) &&
+         "The source exceeds the addressable token offset!");
+
+  std::vector<LexedToken> tokens;
+  // Most tokens are separated through at least one whitespace character
+  tokens.reserve(source_.size() / 4 + 1);
+
+  for (;;) {
+    skipTrivia();
+
+    auto const start = current_;
+    if (start == source_.end()) {
+      break;
+    }
+
+    if (auto kind = lexToken()) {
+      auto const offset = static_cast<std::uint32_t>(start - source_.begin());
+      auto const length = static_cast<std::uint32_t>(current_ - start);
+      tokens.push_back({offset, length, kind});
+    }
+  }
+
+  auto const end = static_cast<std::uint32_t>(source_.size());
+  tokens.push_back({end, 0U, LexedToken::KindEOF});
+  return tokens;
+}
+
+DiagnosticEngine* SourceLexer::diagnosticEngine() const {
+  return compilationUnit_->getDiagnosticEngine();
+}
+
+void SourceLexer::skipTrivia() {
+  for (;;) {
+    skipWhitespace();
+
+    if (peek() != '/') {
+      return;
+    }
+
+    if (peek(1) == '/') {
+      // Line comments are skipped through memchr, which is vectorized
+      // by the standard library.
+      auto newline = static_cast<char const*>(
+          std::memchr(current_ + 2, '\n', remaining() - 2));
+      current_ = newline ? newline + 1 : source_.end();
+    } else if (peek(1) == '*') {
+      auto const offset = current_ - source_.begin();
+      auto const close = source_.find("*/", offset + 2);
+      if (close == llvm::StringRef::npos) {
+        // An unterminated comment is lexed as operators like the
+        // GeneratedLexer does.
+        return;
+      }
+      current_ = source_.begin() + close + 2;
+    } else {
+      return;
+    }
+  }
+}
+
+void SourceLexer::skipWhitespace() {
+#ifdef SOURCE_LEXER_USE_SSE2
+  // Indentation and empty lines are skipped 16 characters at once
+  auto const space = _mm_set1_epi8(' ');
+  auto const tab = _mm_set1_epi8('\t');
+  auto const carriageReturn = _mm_set1_epi8('\r');
+  auto const newline = _mm_set1_epi8('\n');
+
+  while (remaining() >= 16) {
+    auto chunk = _mm_loadu_si128(reinterpret_cast<__m128i const*>(current_));
+    auto matches = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, space), _mm_cmpeq_epi8(chunk, tab)),
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, carriageReturn),
+                     _mm_cmpeq_epi8(chunk, newline)));
+
+    auto const mask = static_cast<std::uint32_t>(_mm_movemask_epi8(matches));
+    if (mask != 0xFFFFU) {
+      current_ += llvm::countTrailingOnes(mask);
+      return;
+    }
+    current_ += 16;
+  }
+#endif
+
+  while ((current_ != source_.end()) &&
+         (classOf(*current_) == ClassWhitespace)) {
+    ++current_;
+  }
+}
+
+std::uint16_t SourceLexer::lexToken() {
+  switch (classOf(*current_)) {
+    case ClassLetter:
+      return lexIdentifierOrKeyword();
+    case ClassDigit:
+      break;
+    case ClassOperator: {
+      auto const c = *current_;
+      auto const next = peek(1);
+      // Signed integer literals are preferred over operators
+      // since they form the longer token.
+      if (((c == '+') || (c == '-')) && (classOf(next) == ClassDigit)) {
+        ++current_;
+        break;
+      }
+
+      auto single = [&](std::uint16_t kind) {
+        ++current_;
+        return kind;
+      };
+      auto twoOrSingle = [&](char second, std::uint16_t kind,
+                             std::uint16_t fallback) -> std::uint16_t {
+        if (next == second) {
+          current_ += 2;
+          return kind;
+        }
+        return single(fallback);
+      };
+
+      switch (c) {
+        case '(':
+          return single(GeneratedLexer::OpenPar);
+        case ')':
+          return single(GeneratedLexer::ClosePar);
+        case '{':
+          return single(GeneratedLexer::OpenCurly);
+        case '}':
+          return single(GeneratedLexer::CloseCurly);
+        case '[':
+          return single(GeneratedLexer::OpenBracket);
+        case ']':
+          return single(GeneratedLexer::CloseBracket);
+        case ',':
+          return single(GeneratedLexer::Comma);
+        case ';':
+          return single(GeneratedLexer::Semicolon);
+        case '@':
+          return single(GeneratedLexer::At);
+        case '*':
+          return single(GeneratedLexer::OperatorMul);
+        case '/':
+          return single(GeneratedLexer::OperatorDiv);
+        case '+':
+          return single(GeneratedLexer::OperatorPlus);
+        case '-':
+          return twoOrSingle('>', GeneratedLexer::Arrow,
+                             GeneratedLexer::OperatorMinus);
+        case '<':
+          return twoOrSingle('=', GeneratedLexer::OperatorLessThanOrEq,
+                             GeneratedLexer::OperatorLessThan);
+        case '>':
+          return twoOrSingle('=', GeneratedLexer::OperatorGreaterThanOrEq,
+                             GeneratedLexer::OperatorGreaterThan);
+        case '=':
+          if (next == '>') {
+            current_ += 2;
+            return GeneratedLexer::FatArrow;
+          }
+          return twoOrSingle('=', GeneratedLexer::OperatorEqual,
+                             GeneratedLexer::OperatorAssign);
+        case '!':
+          if (next == '=') {
+            current_ += 2;
+            return GeneratedLexer::OperatorNotEqual;
+          }
+          break;
+        case '"': {
+          auto const end = current_ + remaining();
+          auto itr = current_ + 1;
+          while ((itr != end) && (*itr != '"') && (*itr != '\r') &&
+                 (*itr != '\n')) {
+            ++itr;
+          }
+          if ((itr != end) && (*itr == '"')) {
+            current_ = itr + 1;
+            return GeneratedLexer::StringLiteral;
+          }
+
+          auto location = SourceLocation(llvm::SMLoc::getFromPointer(current_));
+          diagnosticEngine()
+              ->diagnose(Diagnostic::ErrorStringLiteralUnterminated,
+                         location.extend(itr - current_))
+              .addFixItInsert(SourceLocation(llvm::SMLoc::getFromPointer(itr)),
+                              "\"");
+          current_ = itr;
+          return LexedToken::KindEOF;
+        }
+        default:
+          break;
+      }
+
+      diagnoseUnrecognized();
+      return LexedToken::KindEOF;
+    }
+    default:
+      diagnoseUnrecognized();
+      return LexedToken::KindEOF;
+  }
+
+  // Lex the digits of an integer literal
+  while ((current_ != source_.end()) && (classOf(*current_) == ClassDigit)) {
+    ++current_;
+  }
+  return GeneratedLexer::IntegerLiteral;
+}
+
+std::uint16_t SourceLexer::lexIdentifierOrKeyword() {
+  auto const start = current_;
+  do {
+    ++current_;
+  } while ((current_ != source_.end()) &&
+           ((classOf(*current_) == ClassLetter) ||
+            (classOf(*current_) == ClassDigit)));
+
+  llvm::StringRef text(start, current_ - start);
+  return llvm::StringSwitch<std::uint16_t>(text)
+      .Case("return", GeneratedLexer::Return)
+      .Case("meta", GeneratedLexer::Meta)
+      .Case("if", GeneratedLexer::If)
+      .Case("else", GeneratedLexer::Else)
+      .Case("match", GeneratedLexer::Match)
+      .Case("for", GeneratedLexer::For)
+      .Case("break", GeneratedLexer::Break)
+      .Case("continue", GeneratedLexer::Continue)
+      .Case("import", GeneratedLexer::Import)
+      .Case("true", GeneratedLexer::True)
+      .Case("false", GeneratedLexer::False)
+      .Case("_", GeneratedLexer::Wildcard)
+      .Default(GeneratedLexer::Identifier);
+}
+
+void SourceLexer::diagnoseUnrecognized() {
+  // Skip the whole UTF-8 sequence of non ASCII characters
+  std::size_t length = 1;
+  auto isContinuation = [](char c) {
+    return (static_cast<unsigned char>(c) & 0xC0U) == 0x80U;
+  };
+  while ((length < remaining()) && isContinuation(current_[length])) {
+    ++length;
+  }
+
+  auto location = SourceLocation(llvm::SMLoc::getFromPointer(current_));
+  auto range = location.extend(length);
+  diagnosticEngine()
+      ->diagnose(Diagnostic::ErrorCharacterUnrecognized, range,
+                 llvm::StringRef(current_, length))
+      .addFixItReplace(range, {});
+  current_ += length;
+}
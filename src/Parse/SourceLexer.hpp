@@ -0,0 +1,93 @@
+
+/**
+  Copyright(c) 2016 - 2017 Denis Blank <denis.blank at outlook dot com>
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+**/
+
+#ifndef SOURCE_LEXER_HPP_INCLUDED__
+#define SOURCE_LEXER_HPP_INCLUDED__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "llvm/ADT/StringRef.h"
+
+class CompilationUnit;
+class DiagnosticEngine;
+
+/// Represents a token which refers to its text inside the source buffer
+struct LexedToken {
+  /// The kind of the end of file token, since the ANTLR EOF type
+  /// doesn't fit into the compact kind field.
+  static constexpr std::uint16_t KindEOF = 0U;
+
+  /// The offset of the token text inside the source buffer
+  std::uint32_t offset;
+  /// The length of the token text
+  std::uint32_t length;
+  /// The token type as specified by the vocabulary of the GeneratedLexer
+  std::uint16_t kind;
+};
+
+/// Returns the symbolic name of the given token type
+llvm::StringRef getTokenKindName(std::size_t kind);
+/// Returns the name of the given token type as it's displayed in diagnostics
+llvm::StringRef getTokenDisplayName(std::size_t kind);
+
+/// A hand-written lexer which scans the source buffer in place and
+/// recognizes the same language as the GeneratedLexer grammar, without
+/// converting the source nor allocating a token object per token.
+class SourceLexer {
+  CompilationUnit* compilationUnit_;
+  llvm::StringRef source_;
+  char const* current_;
+
+public:
+  SourceLexer(CompilationUnit* compilationUnit, llvm::StringRef source)
+      : compilationUnit_(compilationUnit), source_(source),
+        current_(source.begin()) {}
+
+  /// Lexes the whole source into a token array which is always
+  /// terminated through an EOF token.
+  std::vector<LexedToken> lex();
+
+private:
+  /// Returns the diagnostic engine which us used for emitting diagnostics
+  DiagnosticEngine* diagnosticEngine() const;
+
+  /// Returns the amount of characters which are left in the source
+  std::size_t remaining() const { return source_.end() - current_; }
+  /// Returns the character at the given lookahead or zero on the source end
+  char peek(std::size_t lookahead = 0) const {
+    return (lookahead < remaining()) ? current_[lookahead] : '\0';
+  }
+
+  /// Skips all whitespace and comments in front of the next token
+  void skipTrivia();
+  /// Skips whitespace, where long runs are skipped through SIMD
+  void skipWhitespace();
+
+  /// Returns the token type of the token starting at the current position
+  /// and advances the position behind it.
+  /// Returns the KindEOF when no token could be recognized.
+  std::uint16_t lexToken();
+  /// Lexes an identifier or a keyword
+  std::uint16_t lexIdentifierOrKeyword();
+
+  /// Reports an unrecognizable character and skips it
+  void diagnoseUnrecognized();
+};
+
+#endif // #ifndef SOURCE_LEXER_HPP_INCLUDED__
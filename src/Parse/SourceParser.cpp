@@ -0,0 +1,719 @@
+
+/**
+  Copyright(c) 2016 - 2017 Denis Blank <denis.blank at outlook dot com>
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+**/
+
+#include "SourceParser.hpp"
+
+#include <cassert>
+
+#include "llvm/ADT/Optional.h"
+
+#include "GeneratedLexer.h"
+
+#include "AST.hpp"
+#include "DiagnosticEngine.hpp"
+#include "Formatting.hpp"
+
+/// Returns the binary operator which is represented by the given token kind
+static llvm::Optional<ExprBinaryOperator>
+getBinaryOperatorOf(std::uint16_t kind) {
+  switch (kind) {
+#define EXPR_BINARY_OPERATOR(NAME, ...)                                        \
+  case GeneratedLexer::Operator##NAME:                                         \
+    return ExprBinaryOperator::Operator##NAME;
+#include "AST.inl"
+    default:
+      return llvm::None;
+  }
+}
+
+/// Returns true when the token kind can start the operand of an expression
+static bool isOperandStart(std::uint16_t kind) {
+  switch (kind) {
+    case GeneratedLexer::Identifier:
+    case GeneratedLexer::IntegerLiteral:
+    case GeneratedLexer::True:
+    case GeneratedLexer::False:
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool SourceParser::parse() {
+  parseCompilationUnit();
+  return !failed_;
+}
+
+bool SourceParser::parseTopLevelDecls() {
+  parseTopLevelDeclList();
+  return !failed_;
+}
+
+LexedToken const& SourceParser::peek(std::size_t lookahead) const {
+  assert(!tokens_.empty() && "Expected at least the EOF token!");
+  // Lookaheads behind the end of the source are pointing to the EOF token
+  auto const index = pos_ + lookahead;
+  return (index < tokens_.size()) ? tokens_[index] : tokens_.back();
+}
+
+LexedToken const& SourceParser::advance() {
+  auto const& current = peek();
+  if (pos_ + 1 < tokens_.size()) {
+    ++pos_;
+  }
+  return current;
+}
+
+bool SourceParser::consumeIf(std::uint16_t kind) {
+  if (is(kind)) {
+    advance();
+    return true;
+  }
+  return false;
+}
+
+Nullable<LexedToken const*> SourceParser::expect(std::uint16_t kind) {
+  if (failed_) {
+    return nullptr;
+  }
+  if (is(kind)) {
+    return &advance();
+  }
+  diagnoseMismatched(kind);
+  return nullptr;
+}
+
+SourceLocation SourceParser::sourceLocationOf(LexedToken const& token) const {
+  return SourceLocation(
+      llvm::SMLoc::getFromPointer(source_.begin() + token.offset));
+}
+
+bool SourceParser::isInMetaDepth(MetaDepth depth) const {
+  assert(isInMetaDecl() &&
+         "Tried to access the meta depth without being in a meta decl.");
+  return metaDepthStack_.back() == depth;
+}
+
+bool SourceParser::isMetaStmtAllowed() const {
+  return isInMetaDecl() && !isInMetaDepth(MetaDepth::DepthNone);
+}
+
+ScopeLeaveAction SourceParser::enterDepth(MetaDepth depth) {
+  metaDepthStack_.push_back(depth);
+  return ScopeLeaveAction([this] {
+    assert(!metaDepthStack_.empty() &&
+           "Tried to pop an unbalanced amount of depth states from the stack!");
+    metaDepthStack_.pop_back();
+  });
+}
+
+void SourceParser::diagnoseMismatched(std::uint16_t expected) {
+  if (failed_) {
+    return;
+  }
+  failed_ = true;
+
+  auto const& current = peek();
+  auto text = is(LexedToken::KindEOF) ? getTokenDisplayName(current.kind)
+                                      : textOf(current);
+  auto location = sourceLocationOf(current);
+
+  auto diag = diagnosticEngine()->diagnose(
+      Diagnostic::ErrorGenericParserFault, location,
+      fmt::format("mismatched input '{}' expecting {}", text,
+                  getTokenDisplayName(expected)));
+  if (current.length > 1) {
+    diag.addRange(sourceRangeOf(current));
+  }
+  diag.addFixItInsert(location, getTokenDisplayName(expected));
+}
+
+void SourceParser::diagnoseNoViableAlternative() {
+  if (failed_) {
+    return;
+  }
+  failed_ = true;
+
+  auto const& current = peek();
+  auto text = is(LexedToken::KindEOF) ? getTokenDisplayName(current.kind)
+                                      : textOf(current);
+
+  auto diag = diagnosticEngine()->diagnose(
+      Diagnostic::ErrorGenericParserFault, sourceLocationOf(current),
+      fmt::format("no viable alternative at input '{}'", text));
+  if (current.length > 1) {
+    diag.addRange(sourceRangeOf(current));
+  }
+}
+
+void SourceParser::diagnoseMetaStmtNotAllowed() {
+  if (failed_) {
+    return;
+  }
+  failed_ = true;
+
+  diagnosticEngine()->diagnose(Diagnostic::ErrorMetaStmtNotAllowed,
+                               sourceRangeOf(peek()));
+}
+
+void SourceParser::parseCompilationUnit() {
+  auto scope = writer_.scopedWrite(allocate<CompilationUnitASTNode>());
+  parseTopLevelDeclList();
+}
+
+void SourceParser::parseTopLevelDeclList() {
+  // Imports are only allowed in front of any other declaration
+  while (!failed_ && is(GeneratedLexer::Import)) {
+    parseImportDecl();
+  }
+
+  while (!failed_ && !is(LexedToken::KindEOF)) {
+    if (is(GeneratedLexer::Identifier) &&
+        is(GeneratedLexer::OperatorLessThan, 1)) {
+      parseMetaDecl();
+    } else {
+      parseGlobalScopeNode();
+    }
+  }
+}
+
+void SourceParser::parseGlobalScopeNode() {
+  if (is(GeneratedLexer::Meta) && isInMetaDecl()) {
+    parseMetaStmt();
+  } else {
+    parseFunctionDecl();
+  }
+}
+
+void SourceParser::parseImportDecl() {
+  expect(GeneratedLexer::Import);
+  auto path = expect(GeneratedLexer::StringLiteral);
+  if (!path) {
+    return;
+  }
+
+  writer_.write(allocate<ImportDeclASTNode>(stringLiteralOf(**path)));
+  expect(GeneratedLexer::Semicolon);
+}
+
+llvm::SmallVector<SourceAttribute, 2> SourceParser::parseAttributes() {
+  llvm::SmallVector<SourceAttribute, 2> attributes;
+  while (!failed_ && consumeIf(GeneratedLexer::At)) {
+    auto name = expect(GeneratedLexer::Identifier);
+    if (!name) {
+      break;
+    }
+    attributes.emplace_back(identifierOf(**name));
+
+    if (consumeIf(GeneratedLexer::OpenPar)) {
+      while (!failed_ && is(GeneratedLexer::StringLiteral)) {
+        attributes.back().arguments.push_back(stringLiteralOf(advance()));
+
+        if (!consumeIf(GeneratedLexer::Comma)) {
+          break;
+        }
+      }
+      expect(GeneratedLexer::ClosePar);
+    }
+  }
+  return attributes;
+}
+
+void SourceParser::parseFunctionDecl() {
+  auto attributes = parseAttributes();
+  auto nameToken = expect(GeneratedLexer::Identifier);
+  if (!nameToken) {
+    return;
+  }
+
+  auto name = identifierOf(**nameToken);
+  auto scope = writer_.scopedWrite(allocate<FunctionDeclASTNode>(
+      name, functionAttributesOf(attributes)));
+
+  expect(GeneratedLexer::OpenPar);
+  parseArgumentDeclList(GeneratedLexer::ClosePar);
+  expect(GeneratedLexer::ClosePar);
+
+  // The optional return type
+  if (!failed_ && is(GeneratedLexer::Identifier)) {
+    parseArgumentDecl();
+  }
+  expect(GeneratedLexer::Arrow);
+
+  if (isInMetaDecl()) {
+    assert(isInMetaDepth(MetaDepth::DepthGlobalScope));
+    auto depth = enterDepth(MetaDepth::DepthLocalScope);
+    parseStmt();
+  } else {
+    parseStmt();
+  }
+}
+
+void SourceParser::parseArgumentDeclList(std::uint16_t terminator) {
+  auto scope = writer_.scopedWrite(allocate<ArgumentDeclListASTNode>());
+
+  if (failed_ || is(terminator)) {
+    return;
+  }
+
+  do {
+    parseArgumentDecl();
+  } while (!failed_ && consumeIf(GeneratedLexer::Comma));
+}
+
+void SourceParser::parseArgumentDecl() {
+  // The type of the argument isn't stored since we only allow int
+  if (!expect(GeneratedLexer::Identifier)) {
+    return;
+  }
+
+  if (is(GeneratedLexer::Identifier)) {
+    auto name = identifierOf(advance());
+    writer_.write(allocate<NamedArgumentDeclASTNode>(name));
+  } else {
+    writer_.write(allocate<AnonymousArgumentDeclASTNode>());
+  }
+}
+
+void SourceParser::parseMetaDecl() {
+  assert(!isInMetaDecl());
+
+  auto name = identifierOf(advance());
+  auto scope = writer_.scopedWrite(allocate<MetaDeclASTNode>(name));
+
+  expect(GeneratedLexer::OperatorLessThan);
+  parseArgumentDeclList(GeneratedLexer::OperatorGreaterThan);
+  expect(GeneratedLexer::OperatorGreaterThan);
+  expect(GeneratedLexer::Arrow);
+
+  auto depth = enterDepth(MetaDepth::DepthGlobalScope);
+  parseMetaContribution();
+}
+
+void SourceParser::parseMetaContribution() {
+  auto open = expect(GeneratedLexer::OpenCurly);
+  if (!open) {
+    return;
+  }
+
+  // The range of the contribution is known after its children were parsed
+  auto const position = writer_.getPosition();
+  while (!failed_ && !is(GeneratedLexer::CloseCurly)) {
+    parseMetaScopeNode();
+  }
+
+  if (auto close = expect(GeneratedLexer::CloseCurly)) {
+    auto range = sourceRangeOf(**open, **close);
+    writer_.writeParent(position, allocate<MetaContributionASTNode>(range));
+  }
+}
+
+void SourceParser::parseMetaScopeNode() {
+  if (isInMetaDepth(MetaDepth::DepthGlobalScope)) {
+    parseGlobalScopeNode();
+  } else if (isInMetaDepth(MetaDepth::DepthLocalScope)) {
+    if (isMatchArmAhead()) {
+      parseMatchArm();
+    } else {
+      parseStmt();
+    }
+  } else {
+    diagnoseNoViableAlternative();
+  }
+}
+
+void SourceParser::parseMetaStmt() {
+  if (is(GeneratedLexer::If, 1)) {
+    parseMetaIfStmt();
+  } else {
+    parseMetaCalculationStmt();
+  }
+}
+
+void SourceParser::parseMetaCalculationStmt() {
+  auto scope = writer_.scopedWrite(allocate<MetaCalculationStmtASTNode>());
+  auto depth = enterDepth(MetaDepth::DepthNone);
+
+  expect(GeneratedLexer::Meta);
+  parseBasicCompoundStmt<UnscopedCompoundStmtASTNode>();
+}
+
+void SourceParser::parseMetaIfStmt() {
+  auto scope = writer_.scopedWrite(allocate<MetaIfStmtASTNode>());
+
+  expect(GeneratedLexer::Meta);
+  expect(GeneratedLexer::If);
+  {
+    auto depth = enterDepth(MetaDepth::DepthNone);
+    parseExpr();
+  }
+
+  parseMetaContribution();
+  if (!failed_ && consumeIf(GeneratedLexer::Else)) {
+    parseMetaContribution();
+  }
+}
+
+void SourceParser::parseStmt() {
+  if (failed_) {
+    return;
+  }
+
+  switch (peek().kind) {
+    case GeneratedLexer::Identifier:
+      if (is(GeneratedLexer::Identifier, 1)) {
+        parseDeclStmt();
+      } else if (is(GeneratedLexer::OpenBracket, 1) &&
+                 is(GeneratedLexer::IntegerLiteral, 2) &&
+                 is(GeneratedLexer::CloseBracket, 3) &&
+                 is(GeneratedLexer::Identifier, 4)) {
+        parseArrayDeclStmt();
+      } else {
+        parseExpressionStmt();
+      }
+      break;
+    case GeneratedLexer::Return:
+      parseReturnStmt();
+      break;
+    case GeneratedLexer::At:
+    case GeneratedLexer::If:
+      parseIfStmt();
+      break;
+    case GeneratedLexer::Match:
+      parseMatchStmt();
+      break;
+    case GeneratedLexer::OpenCurly:
+      parseBasicCompoundStmt<CompoundStmtASTNode>();
+      break;
+    case GeneratedLexer::Meta:
+      if (isMetaStmtAllowed()) {
+        parseMetaStmt();
+      } else {
+        diagnoseMetaStmtNotAllowed();
+      }
+      break;
+    default:
+      parseExpressionStmt();
+      break;
+  }
+}
+
+template <typename T> void SourceParser::parseBasicCompoundStmt() {
+  auto scope = writer_.scopedWrite(allocate<T>());
+
+  expect(GeneratedLexer::OpenCurly);
+  while (!failed_ && !is(GeneratedLexer::CloseCurly)) {
+    parseStmt();
+  }
+  expect(GeneratedLexer::CloseCurly);
+}
+
+void SourceParser::parseDeclStmt() {
+  auto type = identifierOf(advance());
+  auto name = identifierOf(advance());
+
+  checkVarDeclType(type);
+
+  auto scope = writer_.scopedWrite(allocate<DeclStmtASTNode>(name));
+  expect(GeneratedLexer::OperatorAssign);
+  parseExpr();
+  expect(GeneratedLexer::Semicolon);
+}
+
+void SourceParser::parseArrayDeclStmt() {
+  auto type = identifierOf(advance());
+  advance(); // [
+  auto rep = identifierOf(advance());
+  advance(); // ]
+  auto name = identifierOf(advance());
+
+  checkVarDeclType(type);
+
+  auto size = arraySizeOf(rep, name);
+  writer_.write(allocate<ArrayDeclStmtASTNode>(name, size));
+  expect(GeneratedLexer::Semicolon);
+}
+
+void SourceParser::parseExpressionStmt() {
+  auto scope = writer_.scopedWrite(allocate<ExpressionStmtASTNode>());
+  parseExpr();
+  expect(GeneratedLexer::Semicolon);
+}
+
+void SourceParser::parseReturnStmt() {
+  auto scope = writer_.scopedWrite(allocate<ReturnStmtASTNode>());
+
+  expect(GeneratedLexer::Return);
+  if (!is(GeneratedLexer::Semicolon)) {
+    parseExpr();
+  }
+  expect(GeneratedLexer::Semicolon);
+}
+
+void SourceParser::parseIfStmt() {
+  auto attributes = parseAttributes();
+  if (failed_) {
+    return;
+  }
+
+  auto likelihood = branchLikelihoodOf(attributes);
+  auto scope = writer_.scopedWrite(allocate<IfStmtASTNode>(likelihood));
+
+  expect(GeneratedLexer::If);
+  parseExpr();
+  parseBasicCompoundStmt<CompoundStmtASTNode>();
+
+  if (!failed_ && consumeIf(GeneratedLexer::Else)) {
+    parseBasicCompoundStmt<CompoundStmtASTNode>();
+  }
+}
+
+void SourceParser::parseMatchStmt() {
+  auto range = sourceRangeOf(advance());
+  auto scope = writer_.scopedWrite(allocate<MatchStmtASTNode>(range));
+
+  parseExpr();
+  expect(GeneratedLexer::OpenCurly);
+
+  while (!failed_ && !is(GeneratedLexer::CloseCurly)) {
+    // Arms of a match statement can be contributed through a meta if
+    if (is(GeneratedLexer::Meta)) {
+      if (isMetaStmtAllowed()) {
+        parseMetaIfStmt();
+      } else {
+        diagnoseMetaStmtNotAllowed();
+      }
+    } else {
+      parseMatchArm();
+    }
+  }
+  expect(GeneratedLexer::CloseCurly);
+}
+
+void SourceParser::parseMatchArm() {
+  if (!isMatchArmAhead()) {
+    diagnoseNoViableAlternative();
+    return;
+  }
+
+  auto const& pattern = peek();
+  auto const& fatArrow = peek(1);
+
+  auto const isWildcard = pattern.kind == GeneratedLexer::Wildcard;
+  auto range = isWildcard ? sourceRangeOf(pattern, fatArrow)
+                          : sourceRangeOf(fatArrow);
+  auto scope = writer_.scopedWrite(allocate<MatchArmASTNode>(range));
+
+  // The wildcard arm has no pattern
+  if (pattern.kind == GeneratedLexer::IntegerLiteral) {
+    parseIntegerLiteralExpr();
+  } else if (pattern.kind == GeneratedLexer::Identifier) {
+    writer_.write(allocate<DeclRefExprASTNode>(identifierOf(advance())));
+  } else {
+    advance();
+  }
+
+  expect(GeneratedLexer::FatArrow);
+  parseStmt();
+  consumeIf(GeneratedLexer::Comma);
+}
+
+bool SourceParser::isMatchArmAhead() const {
+  switch (peek().kind) {
+    case GeneratedLexer::IntegerLiteral:
+    case GeneratedLexer::Identifier:
+    case GeneratedLexer::Wildcard:
+      return is(GeneratedLexer::FatArrow, 1);
+    default:
+      return false;
+  }
+}
+
+void SourceParser::parseExpr(bool isInstantiationArgument) {
+  parseBinaryExpr(0U, isInstantiationArgument);
+}
+
+void SourceParser::parseBinaryExpr(unsigned minPrecedence,
+                                   bool isInstantiationArgument) {
+  auto const position = writer_.getPosition();
+  parsePostfixExpr();
+
+  while (!failed_) {
+    auto binaryOperator = getBinaryOperatorOf(peek().kind);
+    if (!binaryOperator ||
+        (isInstantiationArgument &&
+         is(GeneratedLexer::OperatorGreaterThan))) {
+      return;
+    }
+
+    auto const precedence = getPrecedenceOf(*binaryOperator);
+    if (precedence < minPrecedence) {
+      return;
+    }
+
+    auto range = sourceRangeOf(advance());
+    auto nextPrecedence =
+        isRightAssociative(*binaryOperator) ? precedence : precedence + 1;
+    parseBinaryExpr(nextPrecedence, isInstantiationArgument);
+
+    // The operands are written already, so insert the operator in front
+    // which makes the expression parsed so far to its left operand.
+    writer_.writeParent(position, allocate<BinaryOperatorExprASTNode>(
+                                      annotate(*binaryOperator, range)));
+  }
+}
+
+void SourceParser::parsePostfixExpr() {
+  auto const position = writer_.getPosition();
+  parsePrimaryExpr();
+
+  while (!failed_ && is(GeneratedLexer::OpenBracket)) {
+    auto const& open = advance();
+    parseExpr();
+    if (auto close = expect(GeneratedLexer::CloseBracket)) {
+      auto range = sourceRangeOf(open, **close);
+      writer_.writeParent(position,
+                          allocate<ArraySubscriptExprASTNode>(range));
+    }
+  }
+}
+
+void SourceParser::parsePrimaryExpr() {
+  if (failed_) {
+    return;
+  }
+
+  switch (peek().kind) {
+    case GeneratedLexer::OpenPar:
+      advance();
+      parseExpr();
+      expect(GeneratedLexer::ClosePar);
+      break;
+    case GeneratedLexer::IntegerLiteral:
+      parseIntegerLiteralExpr();
+      break;
+    case GeneratedLexer::True:
+    case GeneratedLexer::False: {
+      auto const& token = advance();
+      auto literal = annotate(token.kind == GeneratedLexer::True,
+                              sourceRangeOf(token));
+      writer_.write(allocate<BooleanLiteralExprASTNode>(literal));
+      break;
+    }
+    case GeneratedLexer::Identifier: {
+      auto const position = writer_.getPosition();
+      if (is(GeneratedLexer::OperatorLessThan, 1) &&
+          isMetaInstantiationAhead()) {
+        parseMetaInstantiationExpr();
+      } else {
+        writer_.write(allocate<DeclRefExprASTNode>(identifierOf(advance())));
+      }
+
+      // Only references and instantiations are callable
+      if (!failed_ && consumeIf(GeneratedLexer::OpenPar)) {
+        parseExprList(GeneratedLexer::ClosePar, false);
+        if (expect(GeneratedLexer::ClosePar)) {
+          writer_.writeParent(position, allocate<CallOperatorExprASTNode>());
+        }
+      }
+      break;
+    }
+    default:
+      diagnoseNoViableAlternative();
+      break;
+  }
+}
+
+void SourceParser::parseIntegerLiteralExpr() {
+  auto rep = identifierOf(advance());
+  if (auto value = integerLiteralOf(rep)) {
+    writer_.write(allocate<IntegerLiteralExprASTNode>(*value));
+  } else {
+    writer_.write(allocate<ErroneousExprASTNode>());
+  }
+}
+
+void SourceParser::parseMetaInstantiationExpr() {
+  auto const position = writer_.getPosition();
+  writer_.write(allocate<DeclRefExprASTNode>(identifierOf(advance())));
+
+  auto const& open = advance();
+  parseExprList(GeneratedLexer::OperatorGreaterThan, true);
+  if (auto close = expect(GeneratedLexer::OperatorGreaterThan)) {
+    auto range = sourceRangeOf(open, **close);
+    writer_.writeParent(position,
+                        allocate<MetaInstantiationExprASTNode>(range));
+  }
+}
+
+void SourceParser::parseExprList(std::uint16_t terminator,
+                                 bool isInstantiationArgument) {
+  if (failed_ || is(terminator)) {
+    return;
+  }
+
+  do {
+    parseExpr(isInstantiationArgument);
+  } while (!failed_ && consumeIf(GeneratedLexer::Comma));
+}
+
+bool SourceParser::isMetaInstantiationAhead() const {
+  assert(is(GeneratedLexer::Identifier) &&
+         is(GeneratedLexer::OperatorLessThan, 1));
+
+  // Scan for the closing greater than operator, while nested
+  // instantiations and parentheses are skipped.
+  std::size_t nesting = 0U;
+  std::size_t instantiations = 1U;
+  for (std::size_t lookahead = 2U;; ++lookahead) {
+    switch (peek(lookahead).kind) {
+      case GeneratedLexer::OpenPar:
+      case GeneratedLexer::OpenBracket:
+        ++nesting;
+        break;
+      case GeneratedLexer::ClosePar:
+      case GeneratedLexer::CloseBracket:
+        if (nesting == 0U) {
+          return false;
+        }
+        --nesting;
+        break;
+      case GeneratedLexer::OperatorLessThan:
+        if ((nesting == 0U) &&
+            is(GeneratedLexer::Identifier, lookahead - 1U)) {
+          ++instantiations;
+        }
+        break;
+      case GeneratedLexer::OperatorGreaterThan:
+        if ((nesting == 0U) && (--instantiations == 0U)) {
+          // A less than and greater than comparison is followed by an
+          // operand like in `a < b > c`, whereas instantiations aren't.
+          return !isOperandStart(peek(lookahead + 1U).kind);
+        }
+        break;
+      case GeneratedLexer::Semicolon:
+      case GeneratedLexer::OpenCurly:
+      case GeneratedLexer::CloseCurly:
+      case GeneratedLexer::Arrow:
+      case GeneratedLexer::FatArrow:
+      case LexedToken::KindEOF:
+        return false;
+      default:
+        break;
+    }
+  }
+}
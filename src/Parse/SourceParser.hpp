@@ -0,0 +1,182 @@
+
+/**
+  Copyright(c) 2016 - 2017 Denis Blank <denis.blank at outlook dot com>
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+**/
+
+#ifndef SOURCE_PARSER_HPP_INCLUDED__
+#define SOURCE_PARSER_HPP_INCLUDED__
+
+#include <cstddef>
+#include <cstdint>
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+
+#include "ASTLayout.hpp"
+#include "BasicTreeSupport.hpp"
+#include "Nullable.hpp"
+#include "SourceLexer.hpp"
+
+/// Describes the depth of the current non terminal, which conditional enables
+/// nodes as possible children.
+enum class MetaDepth {
+  DepthGlobalScope, /// Top level nodes like functions or meta decls are allowed
+  DepthLocalScope,  /// Locale nodes like statements are allowed
+  DepthNone         /// No meta non terminals are allowed
+};
+
+/// A hand-written recursive descent parser which recognizes the same
+/// language as the GeneratedParser grammar and writes the ASTNodes
+/// directly into an ASTLayout without creating a parse tree.
+///
+/// Binary expressions are parsed through precedence climbing with the
+/// precedences specified in `AST.inl`, where the operands are written
+/// before the operator node is inserted in front of them.
+///
+/// The parser stops on the first syntax error, since the frontend doesn't
+/// continue with an erroneous layout anyway.
+class SourceParser : public BasicTreeSupport {
+  llvm::StringRef source_;
+  llvm::ArrayRef<LexedToken> tokens_;
+  std::size_t pos_ = 0;
+  ASTLayoutWriter writer_;
+  /// The meta depth stack which is empty outside of meta decls
+  llvm::SmallVector<MetaDepth, 4> metaDepthStack_;
+  /// Is set when a syntax error was encountered
+  bool failed_ = false;
+
+public:
+  /// Creates the parser, where the token array needs to be
+  /// terminated by an EOF token.
+  /// Diagnostics are emitted through the given DiagnosticEngine when
+  /// it's present, otherwise through the one of the CompilationUnit.
+  SourceParser(CompilationUnit* compilationUnit, ASTContext* astContext,
+               llvm::StringRef source, llvm::ArrayRef<LexedToken> tokens,
+               DiagnosticEngine* diagnosticEngine = nullptr)
+      : BasicTreeSupport(compilationUnit, astContext, diagnosticEngine),
+        source_(source), tokens_(tokens) {}
+
+  /// Parses the compilation unit and returns true on success
+  bool parse();
+  /// Parses the top level declarations without the enclosing compilation
+  /// unit and returns true on success.
+  /// The resulting layout is a fragment of a compilation unit layout.
+  bool parseTopLevelDecls();
+
+  ASTLayout buildLayout() && { return std::move(writer_).buildLayout(); }
+
+private:
+  /// Returns the token at the given lookahead
+  LexedToken const& peek(std::size_t lookahead = 0) const;
+  /// Returns true when the token at the given lookahead is of the given kind
+  bool is(std::uint16_t kind, std::size_t lookahead = 0) const {
+    return peek(lookahead).kind == kind;
+  }
+  /// Returns the current token and advances to the next one
+  LexedToken const& advance();
+  /// Advances when the current token is of the given kind
+  bool consumeIf(std::uint16_t kind);
+  /// Advances when the current token is of the given kind,
+  /// otherwise a syntax error is reported.
+  Nullable<LexedToken const*> expect(std::uint16_t kind);
+
+  /// Returns the text of the given token
+  llvm::StringRef textOf(LexedToken const& token) const {
+    return source_.substr(token.offset, token.length);
+  }
+  /// Returns the SourceLocation of the given token
+  SourceLocation sourceLocationOf(LexedToken const& token) const;
+  /// Returns the SourceRange of the given token
+  SourceRange sourceRangeOf(LexedToken const& token) const {
+    return sourceLocationOf(token).extend(token.length);
+  }
+  /// Returns the SourceRange from the begin up to the end token
+  SourceRange sourceRangeOf(LexedToken const& begin,
+                            LexedToken const& end) const {
+    return SourceRange::concat(sourceRangeOf(begin), sourceRangeOf(end));
+  }
+  /// Returns the given token as identifier
+  Identifier identifierOf(LexedToken const& token) const {
+    return {Symbol::intern(textOf(token)), sourceRangeOf(token)};
+  }
+  /// Returns the given string literal token without its quotes
+  Identifier stringLiteralOf(LexedToken const& token) const {
+    auto text = textOf(token);
+    return {Symbol::intern(text.slice(1, text.size() - 1)),
+            sourceRangeOf(token)};
+  }
+
+  /// Returns true when we are in a meta decl
+  bool isInMetaDecl() const { return !metaDepthStack_.empty(); }
+  /// Returns true when the parser is in the given depth of a meta decl.
+  bool isInMetaDepth(MetaDepth depth) const;
+  /// Returns true when meta statements are allowed at the current position
+  bool isMetaStmtAllowed() const;
+  /// Enters the given meta depth until the returned action is released
+  ScopeLeaveAction enterDepth(MetaDepth depth);
+
+  /// Reports that the current token doesn't match the expected one
+  void diagnoseMismatched(std::uint16_t expected);
+  /// Reports that the current token can't start any alternative
+  void diagnoseNoViableAlternative();
+  /// Reports a meta statement which isn't allowed at the current position
+  void diagnoseMetaStmtNotAllowed();
+
+  void parseCompilationUnit();
+  void parseTopLevelDeclList();
+  void parseImportDecl();
+  void parseGlobalScopeNode();
+  llvm::SmallVector<SourceAttribute, 2> parseAttributes();
+  void parseFunctionDecl();
+  void parseArgumentDeclList(std::uint16_t terminator);
+  void parseArgumentDecl();
+  void parseMetaDecl();
+  void parseMetaContribution();
+  void parseMetaScopeNode();
+  void parseMetaStmt();
+  void parseMetaCalculationStmt();
+  void parseMetaIfStmt();
+
+  void parseStmt();
+  template <typename T> void parseBasicCompoundStmt();
+  void parseDeclStmt();
+  void parseArrayDeclStmt();
+  void parseExpressionStmt();
+  void parseReturnStmt();
+  void parseIfStmt();
+  void parseMatchStmt();
+  void parseMatchArm();
+  /// Returns true when the current tokens start a match arm
+  bool isMatchArmAhead() const;
+
+  /// Parses an expression, where the greater than operator is not
+  /// consumed at the top level of meta instantiation arguments.
+  void parseExpr(bool isInstantiationArgument = false);
+  /// Parses binary expressions which operators have
+  /// at least the given precedence.
+  void parseBinaryExpr(unsigned minPrecedence, bool isInstantiationArgument);
+  void parsePostfixExpr();
+  void parsePrimaryExpr();
+  void parseIntegerLiteralExpr();
+  void parseMetaInstantiationExpr();
+  /// Parses a comma separated list of expressions until the terminator
+  void parseExprList(std::uint16_t terminator, bool isInstantiationArgument);
+  /// Returns true when the current declaration reference is followed by
+  /// arguments of a meta instantiation rather than by a less than operator.
+  bool isMetaInstantiationAhead() const;
+};
+
+#endif // #ifndef SOURCE_PARSER_HPP_INCLUDED__
@@ -17,6 +17,9 @@
 
 #include "SemaAnalysis.hpp"
 
+#include <algorithm>
+#include <unordered_map>
+
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/Support/Casting.h"
 
@@ -26,6 +29,9 @@
 #include "DiagnosticEngine.hpp"
 
 DiagnosticEngine* SemaAnalysis::diagnosticEngine() const {
+  if (diagnosticEngine_) {
+    return diagnosticEngine_;
+  }
   return compilationUnit_->getDiagnosticEngine();
 }
 
@@ -77,6 +83,62 @@ void SemaAnalysis::visit(CallOperatorExprASTNode const* node) {
   return visitChildren(node);
 }
 
+void SemaAnalysis::visit(DeclRefExprASTNode const* node) {
+  if (node->isResolved() && node->getDecl()->isArrayDecl()) {
+    // Arrays aren't first class values, they are only accessible by element
+    auto subscript = llvm::dyn_cast<ArraySubscriptExprASTNode>(behind(1));
+    if (!subscript || (subscript->getBaseExpr() != node)) {
+      diagnosticEngine()->diagnose(Diagnostic::ErrorArrayUsedAsValue,
+                                   node->getName(), node->getName());
+      diagnosticEngine()->diagnose(Diagnostic::NoteDeclarationHint,
+                                   node->getDecl()->getName(),
+                                   node->getDecl()->getName());
+    }
+  }
+
+  return visitChildren(node);
+}
+
+void SemaAnalysis::visit(ArraySubscriptExprASTNode const* node) {
+  auto array = node->getArrayDecl();
+  if (!array) {
+    // Unresolved decl refs were reported on lookup already
+    auto declRef = llvm::dyn_cast<DeclRefExprASTNode>(node->getBaseExpr());
+    if (!declRef || declRef->isResolved()) {
+      diagnosticEngine()->diagnose(Diagnostic::ErrorSubscriptedNonArray,
+                                   node->getSourceRange());
+    }
+    return visitChildren(node);
+  }
+
+  // Reject constant indices which are known to be out of bounds,
+  // in bound constant indices don't require a runtime check.
+  if (auto index = node->getIndexExpr()->getConstantValue()) {
+    auto size = *node->getArraySize();
+    if ((*index < 0) || (std::uint32_t(*index) >= size)) {
+      diagnosticEngine()->diagnose(Diagnostic::ErrorArrayIndexOutOfBounds,
+                                   node->getSourceRange(), *index,
+                                   array->getName(), size);
+      diagnosticEngine()->diagnose(Diagnostic::NoteDeclarationHint,
+                                   array->getName(), array->getName());
+    }
+  }
+
+  // Arrays exported by meta calculations are read only
+  if (array->isGlobalConstantArray()) {
+    auto assign = llvm::dyn_cast<BinaryOperatorExprASTNode>(behind(1));
+    if (assign && (assign->getLeftExpr() == node) &&
+        (assign->getBinaryOperator() == ExprBinaryOperator::OperatorAssign)) {
+      diagnosticEngine()->diagnose(Diagnostic::ErrorConstantArrayAssigned,
+                                   node->getSourceRange(), array->getName());
+      diagnosticEngine()->diagnose(Diagnostic::NoteDeclarationHint,
+                                   array->getName(), array->getName());
+    }
+  }
+
+  return visitChildren(node);
+}
+
 void SemaAnalysis::visit(IfStmtASTNode const* node) {
 
   // Warn about 'if i = 0' { instead of 'if i == 0'
@@ -91,9 +153,67 @@ void SemaAnalysis::visit(IfStmtASTNode const* node) {
   return visitChildren(node);
 }
 
+void SemaAnalysis::visit(MatchStmtASTNode const* node) {
+  std::unordered_map<std::int32_t, MatchArmASTNode const*> patterns;
+  Nullable<MatchArmASTNode const*> wildcard;
+  auto const isBooleanMatch = node->getExpression()->isBooleanValued();
+
+  for (auto child : node->getArms()) {
+    // Arms contributed by meta nodes are checked after the instantiation
+    auto arm = llvm::dyn_cast<MatchArmASTNode>(child);
+    if (!arm) {
+      continue;
+    }
+
+    if (arm->isWildcard()) {
+      if (wildcard) {
+        diagnosticEngine()->diagnose(Diagnostic::ErrorMatchWildcardDuplicated,
+                                     arm->getSourceRange());
+        diagnosticEngine()->diagnose(Diagnostic::NotePreviousMatchArmHint,
+                                     wildcard->getSourceRange());
+      } else {
+        wildcard = arm;
+      }
+      continue;
+    }
+
+    auto value = arm->getPatternValue();
+    if (!value) {
+      // Unresolved decl refs were reported on lookup already
+      auto declRef = llvm::dyn_cast<DeclRefExprASTNode>(*arm->getPattern());
+      if (!declRef || declRef->isResolved()) {
+        diagnosticEngine()->diagnose(Diagnostic::ErrorMatchPatternNotConstant,
+                                     arm->getSourceRange());
+      }
+      continue;
+    }
+
+    // Patterns are lowered into constants of the type of the matched
+    // expression, so integers can't be matched against booleans.
+    if ((*arm->getPattern())->isBooleanValued() != isBooleanMatch) {
+      diagnosticEngine()->diagnose(Diagnostic::ErrorMatchPatternTypeMismatch,
+                                   arm->getSourceRange(),
+                                   isBooleanMatch ? "a boolean" : "an integer");
+      continue;
+    }
+
+    auto inserted = patterns.insert(std::make_pair(*value, arm));
+    if (!inserted.second) {
+      diagnosticEngine()->diagnose(Diagnostic::ErrorMatchPatternDuplicated,
+                                   arm->getSourceRange(), *value);
+      diagnosticEngine()->diagnose(Diagnostic::NotePreviousMatchArmHint,
+                                   inserted.first->second->getSourceRange());
+    }
+  }
+
+  return visitChildren(node);
+}
+
 /// Returns true when the identifier name is a reserved one
 static bool isIdentifierReserved(Identifier const& identifier) {
-  return llvm::StringSwitch<bool>(*identifier).Case("int", true).Default(false);
+  return llvm::StringSwitch<bool>(identifier->getString())
+      .Case("int", true)
+      .Default(false);
 }
 
 void SemaAnalysis::visit(FunctionDeclASTNode const* node) {
@@ -102,6 +222,24 @@ void SemaAnalysis::visit(FunctionDeclASTNode const* node) {
                                  node->getName(), node->getName());
   }
 
+  // Check the targets of multiversioned functions
+  if (node->hasTargetClones()) {
+    auto const& targets = node->getAttributes().targetClones;
+    for (auto itr = targets.begin(); itr != targets.end(); ++itr) {
+      if (std::find(targets.begin(), itr, *itr) != itr) {
+        diagnosticEngine()->diagnose(Diagnostic::ErrorTargetClonesDuplicated,
+                                     *itr, *itr);
+      }
+    }
+    auto const isDefault = [](Identifier const& target) {
+      return *target == "default";
+    };
+    if (std::none_of(targets.begin(), targets.end(), isDefault)) {
+      diagnosticEngine()->diagnose(Diagnostic::ErrorTargetClonesWithoutDefault,
+                                   node->getName(), node->getName());
+    }
+  }
+
   return visitChildren(node);
 }
 
@@ -33,10 +33,15 @@ class SemaAnalysis : public ASTVisitor<> {
   CompilationUnit* compilationUnit_;
   ASTNode const* base_;
   std::vector<ASTNode const*> depth_;
+  DiagnosticEngine* diagnosticEngine_;
 
 public:
-  SemaAnalysis(CompilationUnit* compilationUnit, ASTNode const* base)
-      : compilationUnit_(compilationUnit), base_(base) {}
+  /// Diagnostics are emitted through the given DiagnosticEngine when
+  /// it's present, otherwise through the one of the CompilationUnit.
+  SemaAnalysis(CompilationUnit* compilationUnit, ASTNode const* base,
+               DiagnosticEngine* diagnosticEngine = nullptr)
+      : compilationUnit_(compilationUnit), base_(base),
+        diagnosticEngine_(diagnosticEngine) {}
 
   /// Checks the AST for semantical correctness
   void checkAST();
@@ -51,8 +56,14 @@ public:
 
   void visit(CallOperatorExprASTNode const* node) override;
 
+  void visit(DeclRefExprASTNode const* node) override;
+
+  void visit(ArraySubscriptExprASTNode const* node) override;
+
   void visit(IfStmtASTNode const* node) override;
 
+  void visit(MatchStmtASTNode const* node) override;
+
   void visit(MetaInstantiationExprASTNode const* node) override;
 
   void accept(ASTNode const* node) override;
@@ -0,0 +1,88 @@
+
+/**
+  Copyright(c) 2016 - 2017 Denis Blank <denis.blank at outlook dot com>
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+**/
+
+#include "SimilarityIndex.hpp"
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+
+/// Returns the edit distance between the given strings
+static unsigned distanceOf(llvm::StringRef left, llvm::StringRef right) {
+  return left.edit_distance(right, /*AllowReplacements*/ true);
+}
+
+void SimilarityIndex::insert(Symbol symbol) {
+  auto const index = std::uint32_t(nodes_.size());
+  if (nodes_.empty()) {
+    nodes_.push_back({symbol, 0U, NoNode, NoNode});
+    return;
+  }
+
+  auto const str = symbol.getString();
+  auto current = 0U;
+  for (;;) {
+    auto const distance = distanceOf(str, nodes_[current].symbol);
+    if (distance == 0U) {
+      // Equal strings are interned into the same Symbol
+      return;
+    }
+
+    auto child = nodes_[current].firstChild;
+    while ((child != NoNode) && (nodes_[child].distance != distance)) {
+      child = nodes_[child].nextSibling;
+    }
+    if (child == NoNode) {
+      Node node{symbol, distance, NoNode, nodes_[current].firstChild};
+      nodes_[current].firstChild = index;
+      nodes_.push_back(node);
+      return;
+    }
+    current = child;
+  }
+}
+
+llvm::Optional<Symbol> SimilarityIndex::findMostSimilar(
+    Symbol symbol, unsigned& distance,
+    llvm::function_ref<bool(Symbol)> isCandidate) const {
+  if (nodes_.empty()) {
+    return llvm::None;
+  }
+
+  auto const str = symbol.getString();
+  llvm::Optional<Symbol> similar;
+  llvm::SmallVector<std::uint32_t, 32> pending{0U};
+  while (!pending.empty()) {
+    auto const& node = nodes_[pending.pop_back_val()];
+    auto const current = distanceOf(str, node.symbol);
+    if ((current < distance) && isCandidate(node.symbol)) {
+      distance = current;
+      similar = node.symbol;
+    }
+
+    // A child subtree only contains Symbols which are closer than the
+    // distance when the distance of the child to this node differs by
+    // less than the distance from the distance of this node.
+    for (auto child = node.firstChild; child != NoNode;
+         child = nodes_[child].nextSibling) {
+      auto const edge = nodes_[child].distance;
+      if ((edge + distance > current) && (edge < current + distance)) {
+        pending.push_back(child);
+      }
+    }
+  }
+  return similar;
+}
@@ -0,0 +1,68 @@
+
+/**
+  Copyright(c) 2016 - 2017 Denis Blank <denis.blank at outlook dot com>
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+**/
+
+#ifndef SIMILARITY_INDEX_HPP_INCLUDED__
+#define SIMILARITY_INDEX_HPP_INCLUDED__
+
+#include <cstdint>
+#include <vector>
+
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/STLExtras.h"
+
+#include "Symbol.hpp"
+
+/// Indexes Symbols by their edit distance through a BK-tree,
+/// which answers the most similar Symbol to a misspelled one
+/// without comparing it to every indexed Symbol.
+///
+/// Every node stores its edit distance to its parent, so subtrees which
+/// can't contain a closer Symbol are skipped through the triangle
+/// inequality of the edit distance.
+class SimilarityIndex {
+  struct Node {
+    Symbol symbol;
+    /// The edit distance to the parent node
+    std::uint32_t distance;
+    std::uint32_t firstChild;
+    std::uint32_t nextSibling;
+  };
+
+  static std::uint32_t const NoNode = ~0U;
+
+  std::vector<Node> nodes_;
+
+public:
+  SimilarityIndex() = default;
+
+  /// Returns true when no Symbol was indexed yet
+  bool empty() const { return nodes_.empty(); }
+
+  /// Adds the given Symbol to the index, Symbols which are indexed
+  /// already are ignored.
+  void insert(Symbol symbol);
+
+  /// Returns the indexed Symbol which is most similar to the given one
+  /// and which edit distance is less than the given distance.
+  /// The distance is lowered to the distance of the returned Symbol.
+  /// Symbols are only returned when the given predicate accepts them.
+  llvm::Optional<Symbol>
+  findMostSimilar(Symbol symbol, unsigned& distance,
+                  llvm::function_ref<bool(Symbol)> isCandidate) const;
+};
+
+#endif // #ifndef SIMILARITY_INDEX_HPP_INCLUDED__
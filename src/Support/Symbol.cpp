@@ -0,0 +1,191 @@
+
+/**
+  Copyright(c) 2016 - 2017 Denis Blank <denis.blank at outlook dot com>
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+**/
+
+#include "Symbol.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "llvm/ADT/Hashing.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/MathExtras.h"
+
+namespace {
+/// The process wide table which interns the strings of Symbols.
+///
+/// Strings are copied into an arena and are released only when the whole
+/// table is cleared. Their StringRefs are indexed through chunks, where
+/// every chunk is twice as large as the previous one. Thus the string of a
+/// Symbol is resolved without locking while other threads are interning
+/// new strings, and the table grows up to the range of the ids.
+/// Interning is guarded by a mutex and probes an open addressing hash
+/// table, which stores the hash next to the id for skipping most of the
+/// string comparisons.
+class SymbolTable {
+  /// The size of the first chunk, chunk k holds the ids starting
+  /// at FirstChunkSize * (2^k - 1).
+  enum : std::uint32_t { FirstChunkBits = 12U };
+  enum : std::uint64_t { FirstChunkSize = 1U << FirstChunkBits };
+  /// The count of chunks which cover all 32 bit ids
+  enum : std::uint32_t { MaxChunks = 32U - FirstChunkBits + 1U };
+  /// The ids which are reserved as keys by llvm::DenseMapInfo<Symbol>
+  enum : std::uint32_t { FirstReservedId = ~0U - 1U };
+
+  struct Bucket {
+    std::uint32_t hash;
+    /// The id of the Symbol, where 0 marks an empty bucket since the
+    /// empty string is never stored inside the table.
+    std::uint32_t id;
+  };
+
+  std::mutex mutex_;
+  llvm::BumpPtrAllocator allocator_;
+  std::vector<Bucket> buckets_;
+  /// The id of the next interned string
+  std::uint32_t size_ = 1U;
+  std::array<std::atomic<llvm::StringRef*>, MaxChunks> chunks_{};
+
+public:
+  SymbolTable() : buckets_(1024U, Bucket{0U, 0U}) {
+    // The id 0 represents the empty string
+    allocateChunk(0U)[0U] = llvm::StringRef();
+  }
+
+  /// Returns the count of interned strings
+  std::size_t size() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return size_ - 1U;
+  }
+
+  /// Releases all interned strings
+  void clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& chunk : chunks_) {
+      chunk.store(nullptr, std::memory_order_relaxed);
+    }
+    allocator_.Reset();
+    buckets_.assign(1024U, Bucket{0U, 0U});
+    size_ = 1U;
+    allocateChunk(0U)[0U] = llvm::StringRef();
+  }
+
+  std::uint32_t intern(llvm::StringRef str) {
+    if (str.empty()) {
+      return 0U;
+    }
+
+    auto const hash = static_cast<std::uint32_t>(llvm::hash_value(str));
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto const mask = buckets_.size() - 1U;
+    for (auto index = hash & mask;; index = (index + 1U) & mask) {
+      auto& bucket = buckets_[index];
+      if (!bucket.id) {
+        bucket = {hash, insert(str)};
+        auto const id = bucket.id;
+        // Keep the load factor of the table below one half
+        if (2U * size_ > buckets_.size()) {
+          grow();
+        }
+        return id;
+      }
+      if ((bucket.hash == hash) && (lookup(bucket.id) == str)) {
+        return bucket.id;
+      }
+    }
+  }
+
+  llvm::StringRef lookup(std::uint32_t id) const {
+    auto const location = locate(id);
+    auto chunk = chunks_[location.first].load(std::memory_order_acquire);
+    return chunk[location.second];
+  }
+
+private:
+  /// Copies the string into the arena and returns its new id
+  std::uint32_t insert(llvm::StringRef str) {
+    auto const id = size_++;
+    if (id >= FirstReservedId) {
+      llvm::report_fatal_error("Exceeded the maximum count of symbols!");
+    }
+
+    auto data = allocator_.Allocate<char>(str.size());
+    std::memcpy(data, str.data(), str.size());
+
+    auto const location = locate(id);
+    auto chunk =
+        (location.second == 0U)
+            ? allocateChunk(location.first)
+            : chunks_[location.first].load(std::memory_order_relaxed);
+    chunk[location.second] = llvm::StringRef(data, str.size());
+    return id;
+  }
+
+  /// Returns the index of the chunk and the index inside the chunk
+  /// of the given id.
+  static std::pair<std::uint32_t, std::uint64_t> locate(std::uint32_t id) {
+    auto const position = std::uint64_t(id) + FirstChunkSize;
+    auto const chunk = llvm::Log2_64(position) - FirstChunkBits;
+    return {chunk, position - (FirstChunkSize << chunk)};
+  }
+
+  llvm::StringRef* allocateChunk(std::uint32_t index) {
+    auto chunk = allocator_.Allocate<llvm::StringRef>(FirstChunkSize << index);
+    chunks_[index].store(chunk, std::memory_order_release);
+    return chunk;
+  }
+
+  /// Doubles the count of buckets and reinserts all ids
+  void grow() {
+    std::vector<Bucket> buckets(2U * buckets_.size(), Bucket{0U, 0U});
+    auto const mask = buckets.size() - 1U;
+    for (auto const& bucket : buckets_) {
+      if (!bucket.id) {
+        continue;
+      }
+      auto index = bucket.hash & mask;
+      while (buckets[index].id) {
+        index = (index + 1U) & mask;
+      }
+      buckets[index] = bucket;
+    }
+    buckets_ = std::move(buckets);
+  }
+};
+} // end anonymous namespace
+
+static SymbolTable& symbolTable() {
+  static SymbolTable table;
+  return table;
+}
+
+Symbol Symbol::intern(llvm::StringRef str) {
+  return Symbol(symbolTable().intern(str));
+}
+
+llvm::StringRef Symbol::getString() const {
+  return symbolTable().lookup(id_);
+}
+
+std::size_t Symbol::getInternedCount() { return symbolTable().size(); }
+
+void Symbol::clearInterned() { symbolTable().clear(); }
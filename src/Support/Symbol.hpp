@@ -0,0 +1,92 @@
+
+/**
+  Copyright(c) 2016 - 2017 Denis Blank <denis.blank at outlook dot com>
+
+  Licensed under the Apache License, Version 2.0 (the "License");
+  you may not use this file except in compliance with the License.
+  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+**/
+
+#ifndef SYMBOL_HPP_INCLUDED__
+#define SYMBOL_HPP_INCLUDED__
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+#include "llvm/ADT/DenseMapInfo.h"
+#include "llvm/ADT/StringRef.h"
+
+/// Represents an interned string which is identified through a 32 bit id.
+///
+/// Strings are interned into a process wide table, so equal strings are
+/// represented through the same Symbol across all ASTContexts and threads.
+/// Comparing and hashing Symbols doesn't touch their strings.
+///
+/// The table only grows, long running processes like a compile server
+/// clear it when they dropped all state which could contain Symbols.
+class Symbol {
+  friend struct llvm::DenseMapInfo<Symbol>;
+
+  std::uint32_t id_ = 0;
+
+  explicit Symbol(std::uint32_t id) : id_(id) {}
+
+public:
+  /// Creates the Symbol of the empty string
+  Symbol() = default;
+
+  /// Returns the Symbol of the given string,
+  /// where the string is interned on its first occurrence.
+  static Symbol intern(llvm::StringRef str);
+  /// Returns the count of strings which are interned currently
+  static std::size_t getInternedCount();
+  /// Releases all interned strings.
+  /// Note: Symbols which exist already are invalid afterwards, so this is
+  ///       only allowed while no Symbol is in use by any thread.
+  static void clearInterned();
+
+  /// Returns the unique id of the Symbol
+  std::uint32_t getId() const { return id_; }
+  /// Returns the interned string of the Symbol
+  llvm::StringRef getString() const;
+  operator llvm::StringRef() const { return getString(); }
+
+  bool operator==(Symbol right) const { return id_ == right.id_; }
+  bool operator!=(Symbol right) const { return id_ != right.id_; }
+
+  /// Compares the string of the Symbol with the given one
+  friend bool operator==(Symbol left, llvm::StringRef right) {
+    return left.getString() == right;
+  }
+  /// Compares the string of the Symbol with the given one
+  friend bool operator!=(Symbol left, llvm::StringRef right) {
+    return left.getString() != right;
+  }
+
+  friend std::ostream& operator<<(std::ostream& os, Symbol symbol) {
+    auto const str = symbol.getString();
+    return os.write(str.data(), str.size());
+  }
+};
+
+namespace llvm {
+template <> struct DenseMapInfo<Symbol> {
+  static Symbol getEmptyKey() { return Symbol(~0U); }
+  static Symbol getTombstoneKey() { return Symbol(~0U - 1U); }
+  static unsigned getHashValue(Symbol symbol) {
+    return DenseMapInfo<std::uint32_t>::getHashValue(symbol.getId());
+  }
+  static bool isEqual(Symbol left, Symbol right) { return left == right; }
+};
+} // end namespace llvm
+
+#endif // #ifndef SYMBOL_HPP_INCLUDED__
@@ -69,61 +69,49 @@ struct SimpleLayoutASTNode {
   std::string kind;
   llvm::Optional<std::vector<SimpleLayoutASTNode>> children;
 
-  static SimpleLayoutASTNode createUnstructured(Nullable<ASTNode const*> node) {
+  static SimpleLayoutASTNode createUnstructured(ASTLayout const& layout,
+                                                std::size_t position) {
     SimpleLayoutASTNode flat;
-    if (node) {
-      flat.kind = ASTStringer::toTypeString(*node);
-    } else {
+    if (layout.isReduceMarker(position)) {
       flat.kind = "<reduce marker>";
+    } else {
+      flat.kind = ASTStringer::toTypeString(layout.getKind(position));
     }
     return flat;
   }
 
-  static bool hasNodeChildren(ASTNode const* node) {
-    return traverseNode(node,
-                        decorate(identityOf<bool>(), pred::hasChildren()));
-  }
-
-  static std::size_t getFixedChildrenSize(ASTNode const* node) {
-    return traverseNodeExpecting(
-        node, pred::hasChildren(),
-        decorate(identityOf<std::size_t>(), pred::getKnownAmountOfChildren()));
-  }
-
-  static SimpleLayoutASTNode
-  createStructured(llvm::ArrayRef<Nullable<ASTNode*>>::const_iterator& itr,
-                   llvm::ArrayRef<Nullable<ASTNode*>>::const_iterator end) {
-
-    assert((itr != end) && "Malformed layout!");
+  static SimpleLayoutASTNode createStructured(ASTLayout const& layout,
+                                              std::size_t& position) {
+    assert((position < layout.size()) && "Malformed layout!");
     SimpleLayoutASTNode simpleNode;
-    auto main = **itr;
-    simpleNode.kind = ASTStringer::toTypeString(main);
-    ++itr;
+    auto const kind = layout.getKind(position);
+    simpleNode.kind = ASTStringer::toTypeString(kind);
+    ++position;
 
     // Return when the node has no children
-    if (!hasNodeChildren(main)) {
+    auto const isRequiringReduceMarker =
+        ASTLayout::isRequiringReduceMarker(kind);
+    auto const count = ASTLayout::getFixedChildCount(kind);
+    if (!isRequiringReduceMarker && (count == 0U)) {
       return simpleNode;
     }
 
     auto consume = [&] {
-      assert((itr != end) && "Malformed layout!");
-      assert(!itr->empty() && "Expected a valid node here!");
-      simpleNode.children->push_back(createStructured(itr, end));
+      assert((position < layout.size()) && "Malformed layout!");
+      assert(!layout.isReduceMarker(position) && "Expected a node here!");
+      simpleNode.children->push_back(createStructured(layout, position));
     };
 
     SimpleLayoutASTNode reduce;
     simpleNode.children.emplace();
-    if (ASTLayoutWriter::isNodeRequiringReduceMarker(main)) {
-      while (!itr->empty()) {
+    if (isRequiringReduceMarker) {
+      while (!layout.isReduceMarker(position)) {
         consume();
       }
-      assert((itr != end) && "Malformed layout!");
-      assert(itr->empty() && "Expected a reduce marker here!");
       reduce.kind = "<reduce marker>";
-      ++itr;
+      ++position;
     } else {
-      auto count = getFixedChildrenSize(main);
-      for (decltype(count) i = 0U; i < count; ++i) {
+      for (std::size_t i = 0U; i < count; ++i) {
         consume();
       }
       reduce.kind = "<obvious reduce>";
@@ -142,25 +130,22 @@ template <> struct llvm::yaml::MappingTraits<SimpleLayoutASTNode> {
 
 LLVM_YAML_IS_SEQUENCE_VECTOR(SimpleLayoutASTNode)
 
-void dumpFlatLayout(llvm::raw_ostream& out,
-                    llvm::ArrayRef<Nullable<ASTNode*>> layout) {
-
+void dumpFlatLayout(llvm::raw_ostream& out, ASTLayout const& layout) {
   llvm::yaml::Output yout(out);
   std::vector<SimpleLayoutASTNode> nodes;
-  for (auto node : layout) {
-    nodes.push_back(SimpleLayoutASTNode::createUnstructured(node));
+  for (std::size_t position = 0U; position < layout.size(); ++position) {
+    nodes.push_back(SimpleLayoutASTNode::createUnstructured(layout, position));
   }
   yout << nodes;
   out.flush();
 }
 
-void dumpLayout(llvm::raw_ostream& out,
-                llvm::ArrayRef<Nullable<ASTNode*>> layout) {
+void dumpLayout(llvm::raw_ostream& out, ASTLayout const& layout) {
   llvm::yaml::Output yout(out);
-  auto itr = layout.begin();
-  auto end = layout.end();
-  auto simpleNode = SimpleLayoutASTNode::createStructured(itr, end);
-  assert((itr == end) && "Expected to be at the end of the layout!");
+  std::size_t position = 0U;
+  auto simpleNode = SimpleLayoutASTNode::createStructured(layout, position);
+  assert((position == layout.size()) &&
+         "Expected to be at the end of the layout!");
   yout << simpleNode;
   out.flush();
 }
@@ -18,20 +18,16 @@
 #ifndef AST_DUMPER_HPP_INCLUDED__
 #define AST_DUMPER_HPP_INCLUDED__
 
-#include "llvm/ADT/ArrayRef.h"
 #include "llvm/Support/raw_ostream.h"
 
-#include "Nullable.hpp"
-
+class ASTLayout;
 class ASTNode;
 
 /// Prints the flat layout (unstructured) as YAML to the given ostream
-void dumpFlatLayout(llvm::raw_ostream& out,
-                    llvm::ArrayRef<Nullable<ASTNode*>> layout);
+void dumpFlatLayout(llvm::raw_ostream& out, ASTLayout const& layout);
 
 /// Prints the flat layout as YAML to the given ostream
-void dumpLayout(llvm::raw_ostream& out,
-                llvm::ArrayRef<Nullable<ASTNode*>> layout);
+void dumpLayout(llvm::raw_ostream& out, ASTLayout const& layout);
 
 /// Prints the complete AST as YAML to the given ostream
 void dumpAST(llvm::raw_ostream& out, ASTNode const* astNode);
@@ -23,9 +23,9 @@
 #include "llvm/ObjectYAML/YAML.h"
 
 #include "CommonTokenStream.h"
-#include "Recognizer.h"
 #include "Token.h"
-#include "Vocabulary.h"
+
+#include "SourceLexer.hpp"
 
 struct SimpleToken {
   std::size_t line;
@@ -33,13 +33,11 @@ struct SimpleToken {
   std::string kind;
   std::string text;
 
-  static SimpleToken createFrom(antlr4::Recognizer const* recognizer,
-                                antlr4::Token* token) {
+  static SimpleToken createFrom(antlr4::Token* token) {
     SimpleToken simpleToken;
     simpleToken.line = token->getLine();
     simpleToken.offset = token->getCharPositionInLine();
-    simpleToken.kind =
-        recognizer->getVocabulary().getSymbolicName(token->getType());
+    simpleToken.kind = getTokenKindName(token->getType());
     simpleToken.text = token->getText();
     return simpleToken;
   }
@@ -56,15 +54,14 @@ template <> struct llvm::yaml::MappingTraits<SimpleToken> {
 
 LLVM_YAML_IS_SEQUENCE_VECTOR(SimpleToken)
 
-void dumpTokens(llvm::raw_ostream& out, antlr4::CommonTokenStream* tokens,
-                antlr4::Recognizer const* recognizer) {
+void dumpTokens(llvm::raw_ostream& out, antlr4::CommonTokenStream* tokens) {
   tokens->fill();
   auto allTokens = tokens->getTokens();
   allTokens.pop_back(); // Pop the EOF Token
 
   std::vector<SimpleToken> simpleTokens;
   for (auto token : allTokens) {
-    simpleTokens.emplace_back(SimpleToken::createFrom(recognizer, token));
+    simpleTokens.emplace_back(SimpleToken::createFrom(token));
   }
 
   llvm::yaml::Output yout(out);
@@ -22,11 +22,9 @@
 
 namespace antlr4 {
 class CommonTokenStream;
-class Recognizer;
 }
 
 /// Prints the tokens as YAML to the given ostream
-void dumpTokens(llvm::raw_ostream& out, antlr4::CommonTokenStream* tokens,
-                antlr4::Recognizer const* recognizer);
+void dumpTokens(llvm::raw_ostream& out, antlr4::CommonTokenStream* tokens);
 
 #endif // #ifndef TOKEN_DUMPER_HPP_INCLUDED__
@@ -0,0 +1,48 @@
+#!/usr/bin/env bash
+#
+# Checks that the similar declarations are suggested for at most 50 unknown
+# names per unit, whether the declarations are read in forks or one by one
+# through the deferred diagnostic engines of an analysis session.
+# The source is generated with the given count of functions, each of them
+# refers to a misspelled parameter.
+#
+# Usage: test/typo-corrections.sh <compiler> [function count]
+
+set -euo pipefail
+
+if [ $# -lt 1 ]; then
+  echo "Usage: $0 <compiler> [function count]" >&2
+  exit 1
+fi
+
+compiler=$1
+count=${2:-20000}
+limit=50
+
+source=$(mktemp --suffix=.swy)
+trap 'rm -f "$source"' EXIT
+
+for ((i = 0; i < count; ++i)); do
+  echo "check$i(int count) int -> return cuont + $i;"
+done > "$source"
+
+status=0
+check() {
+  local mode=$1
+  shift
+  local suggestions
+  suggestions=$("$compiler" "$@" "$source" 2>&1 >/dev/null |
+                grep -c "Did you mean" || true)
+  if [ "$suggestions" -eq 0 ] || [ "$suggestions" -gt "$limit" ]; then
+    echo "FAIL $mode: $suggestions suggestions, expected 1 to $limit"
+    status=1
+  else
+    echo "ok   $mode: $suggestions suggestions"
+  fi
+}
+
+check "forks" -j=4 -emit-ast
+check "sequential" -j=1 -emit-ast
+check "analysis session" -analyze
+
+exit $status